@@ -5,13 +5,15 @@
 #include <time.h>
 
 #include <tsetlin.h>
+#include <dataset.h>
 #include <log.h>
 
 /*
   Simplified standalone implementation of the Python script in C.
 
   - Loads "iris.csv" (expects 5 columns: 4 numeric features + species string).
-  - Normalizes features, booleanizes into bits per feature.
+  - Normalizes features, booleanizes into bits per feature, and caches the
+    packed result in iris.tsd for later runs.
   - Splits into train/test.
   - Trains a Tsetlin machine using the C API implemented in this project.
   - Evaluates and prints accuracy.
@@ -154,11 +156,13 @@ static int** booleanize_features(double** X, int n_samples, int n_features, cons
 }
 
 /* ---------- Train/Test split ---------- */
-/* Simple deterministic split with random_state seed. Returns train arrays via pointers.
-   Allocates new arrays for train/test sample pointers; does not copy feature rows. */
-static void train_test_split(int** Xb, int* y, int n_samples, double test_size, int random_state,
-    int*** X_train_out, int** y_train_out, int* n_train_out,
-    int*** X_test_out, int** y_test_out, int* n_test_out) {
+/* Simple deterministic split with random_state seed. Copies the packed rows of each side into
+   new contiguous arrays (BITPACK_WORDS(n_features) words per row). */
+static void train_test_split(const dataset_t* data, double test_size, int random_state,
+    uint64_t** X_train_out, int** y_train_out, int* n_train_out,
+    uint64_t** X_test_out, int** y_test_out, int* n_test_out) {
+    int n_samples = data->n_samples;
+    int n_words = data->n_words;
     int* idx = (int*)malloc(sizeof(int) * n_samples);
     for (int i = 0; i < n_samples; ++i) idx[i] = i;
 
@@ -172,21 +176,21 @@ static void train_test_split(int** Xb, int* y, int n_samples, double test_size,
     int n_test = (int)round(test_size * n_samples);
     int n_train = n_samples - n_test;
 
-    int** X_train = (int**)malloc(sizeof(int*) * n_train);
+    uint64_t* X_train = (uint64_t*)malloc(sizeof(uint64_t) * n_words * n_train);
     int* y_train = (int*)malloc(sizeof(int) * n_train);
-    int** X_test = (int**)malloc(sizeof(int*) * n_test);
+    uint64_t* X_test = (uint64_t*)malloc(sizeof(uint64_t) * n_words * n_test);
     int* y_test = (int*)malloc(sizeof(int) * n_test);
 
     int ti = 0, vi = 0;
     for (int i = 0; i < n_samples; ++i) {
         if (i < n_train) {
-            X_train[ti] = Xb[idx[i]];
-            y_train[ti] = y[idx[i]];
+            memcpy(X_train + (size_t)ti * n_words, dataset_row(data, idx[i]), sizeof(uint64_t) * n_words);
+            y_train[ti] = data->y[idx[i]];
             ++ti;
         }
         else {
-            X_test[vi] = Xb[idx[i]];
-            y_test[vi] = y[idx[i]];
+            memcpy(X_test + (size_t)vi * n_words, dataset_row(data, idx[i]), sizeof(uint64_t) * n_words);
+            y_test[vi] = data->y[idx[i]];
             ++vi;
         }
     }
@@ -197,15 +201,56 @@ static void train_test_split(int** Xb, int* y, int n_samples, double test_size,
 }
 
 /* ---------- Accuracy helper ---------- */
-static double compute_accuracy(tsetlin_t* ts, int** X_samples, int* y, int n_samples) {
+static double compute_accuracy(tsetlin_t* ts, const uint64_t* X_samples, int* y, int n_samples) {
+    int* preds = (int*)malloc(sizeof(int) * n_samples);
+    if (!preds || tsetlin_predict_batch_packed(ts, X_samples, n_samples, preds, NULL) != 0) {
+        free(preds);
+        return 0.0;
+    }
     int correct = 0;
     for (int i = 0; i < n_samples; ++i) {
-        int pred = tsetlin_predict(ts, X_samples[i], NULL);
-        if (pred == y[i]) ++correct;
+        if (preds[i] == y[i]) ++correct;
     }
+    free(preds);
     return (double)correct / (double)n_samples;
 }
 
+/* ---------- Booleanized dataset, through the cache ---------- */
+/* Parse and booleanize the CSV into a packed dataset. params receives the booleanization
+   parameters stored with the cache: n_bit, then the per-feature means, then the stds. */
+static dataset_t* booleanize_csv(const char* csv_path, int num_bits, double params[1 + 2 * N_FEATUES]) {
+    double** X_real = NULL;
+    int* y_labels = NULL;
+    int n_samples = 0;
+    int n_features = 0;
+    if (load_iris_csv(csv_path, &X_real, &n_samples, &n_features, &y_labels) != 0) return NULL;
+
+    /* Normalization stats */
+    double* mean = params + 1;
+    double* std = params + 1 + N_FEATUES;
+    params[0] = num_bits;
+    compute_mean_std(X_real, n_samples, n_features, mean, std);
+
+    /* Booleanize features */
+    int** Xb = booleanize_features(X_real, n_samples, n_features, mean, std, num_bits);
+    dataset_t* data = Xb ? dataset_new(n_samples, n_features * num_bits, 1) : NULL;
+    if (data) {
+        for (int i = 0; i < n_samples; ++i) {
+            bitpack_pack(Xb[i], data->n_features, data->X + (size_t)i * data->n_words);
+            data->y[i] = y_labels[i];
+        }
+    }
+
+    for (int i = 0; i < n_samples; ++i) free(X_real[i]);
+    free(X_real);
+    free(y_labels);
+    if (Xb) {
+        for (int i = 0; i < n_samples; ++i) free(Xb[i]);
+        free(Xb);
+    }
+    return data;
+}
+
 /* ---------- Simple log wrapper using log.h library if available ---------- */
 static void my_log(const char* fmt, ...) {
     va_list ap;
@@ -225,6 +270,8 @@ int main(int argc, char** argv) {
     int T = 30;
     double s = 6.0;
     int optuna = 0;
+    const char* cache_path = "iris.tsd";
+    int use_cache = 1;
 
     /* Basic argument parsing (minimal) */
     for (int i = 1; i < argc; ++i) {
@@ -235,6 +282,7 @@ int main(int argc, char** argv) {
         else if (strcmp(argv[i], "--T") == 0 && i + 1 < argc) T = atoi(argv[++i]);
         else if (strcmp(argv[i], "--s") == 0 && i + 1 < argc) s = atof(argv[++i]);
         else if (strcmp(argv[i], "--optuna") == 0) optuna = 1;
+        else if (strcmp(argv[i], "--no_cache") == 0) use_cache = 0;
     }
 
     if (!(N_BIT == 1 || N_BIT == 2 || N_BIT == 4 || N_BIT == 8)) {
@@ -242,35 +290,32 @@ int main(int argc, char** argv) {
         return 1;
     }
 
-    /* Load iris dataset */
-    double** X_real = NULL;
-    int* y_labels = NULL;
-    int n_samples = 0;
-    int n_features = 0;
-    if (load_iris_csv(csv_path, &X_real, &n_samples, &n_features, &y_labels) != 0) {
-        fprintf(stderr, "Failed to load %s\n", csv_path);
-        return 1;
+    /* Booleanized dataset: mapped from the cache when it matches the CSV and n_bit */
+    int32_t n_bit = N_BIT;
+    uint64_t key = dataset_hash(&n_bit, sizeof(n_bit), dataset_hash_file(csv_path, DATASET_HASH_INIT));
+    dataset_t* data = use_cache ? dataset_cache_open(cache_path, key, 3) : NULL;
+    if (data) {
+        my_log("Mapped booleanized cache %s (%d samples)", cache_path, data->n_samples);
     }
-    my_log("Loaded %d samples, %d features", n_samples, n_features);
-
-    /* Normalization stats */
-    double* mean = (double*)malloc(sizeof(double) * n_features);
-    double* std = (double*)malloc(sizeof(double) * n_features);
-    compute_mean_std(X_real, n_samples, n_features, mean, std);
-
-    /* Booleanize features */
-    int** Xb = booleanize_features(X_real, n_samples, n_features, mean, std, N_BIT);
-    int bool_features = n_features * N_BIT;
-    if (!Xb) {
-        fprintf(stderr, "Booleanization failed\n");
-        return 1;
+    else {
+        double params[1 + 2 * N_FEATUES];
+        data = booleanize_csv(csv_path, N_BIT, params);
+        if (!data) {
+            fprintf(stderr, "Failed to load %s\n", csv_path);
+            return 1;
+        }
+        my_log("Loaded %d samples, %d features", data->n_samples, N_FEATUES);
+        if (use_cache && dataset_cache_save(data, cache_path, key, params, sizeof(params)) == 0) {
+            my_log("Wrote booleanized cache %s", cache_path);
+        }
     }
+    int bool_features = data->n_features;
 
     /* Prepare train/test split (test_size=0.2, random_state=0 as in Python) */
-    int** X_train = NULL, ** X_test = NULL;
+    uint64_t* X_train = NULL, * X_test = NULL;
     int* y_train = NULL, * y_test = NULL;
     int n_train = 0, n_test = 0;
-    train_test_split(Xb, y_labels, n_samples, 0.2, 0, &X_train, &y_train, &n_train, &X_test, &y_test, &n_test);
+    train_test_split(data, 0.2, 0, &X_train, &y_train, &n_train, &X_test, &y_test, &n_test);
     my_log("Train samples: %d, Test samples: %d. Boolean features: %d", n_train, n_test, bool_features);
 
     if (optuna) {
@@ -292,7 +337,10 @@ int main(int argc, char** argv) {
     for (int epoch = 0; epoch < epochs; ++epoch) {
         my_log("[Epoch %d/%d] Starting", epoch + 1, epochs);
         for (int i = 0; i < n_train; ++i) {
-            tsetlin_step(ts, X_train[i], y_train[i], T, s, NULL, -1);
+            if (tsetlin_step_packed(ts, X_train + (size_t)i * data->n_words, y_train[i], T, s, NULL, -1) != 0) {
+                fprintf(stderr, "Training step failed\n");
+                return 1;
+            }
         }
         double train_acc = compute_accuracy(ts, X_train, y_train, n_train);
         my_log("[Epoch %d/%d] Train Accuracy: %.2f%%", epoch + 1, epochs, train_acc * 100.0);
@@ -304,13 +352,7 @@ int main(int argc, char** argv) {
 
     /* Clean up */
     tsetlin_free(ts);
-    for (int i = 0; i < n_samples; ++i) free(X_real[i]);
-    free(X_real);
-    free(y_labels);
-    for (int i = 0; i < n_samples; ++i) free(Xb[i]);
-    free(Xb);
-    free(mean);
-    free(std);
+    dataset_free(data);
     free(X_train);
     free(y_train);
     free(X_test);
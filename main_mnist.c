@@ -6,84 +6,84 @@
 #include <time.h>
 
 #include <tsetlin.h>
+#include <compact.h>
+#include <dataset.h>
+#include <inverted.h>
+#include <pipeline.h>
+#include <thread.h>
 #include <log.h>
 
 #include <tqdm.h>
 
-/* Simple IDX file readers for MNIST (train/test files must be present in CWD):
-   - train-images-idx3-ubyte
-   - train-labels-idx1-ubyte
-   - t10k-images-idx3-ubyte
-   - t10k-labels-idx1-ubyte
-*/
-
-/* Read big-endian 32-bit */
-static uint32_t read_be_u32(FILE* f) {
-    uint8_t b[4];
-    if (fread(b, 1, 4, f) != 4) return 0;
-    return (uint32_t)b[0] << 24 | (uint32_t)b[1] << 16 | (uint32_t)b[2] << 8 | (uint32_t)b[3];
-}
+/* Clause evaluation engine used for accuracy. */
+typedef enum {
+    ENGINE_CLAUSE,      /* per-clause, tsetlin_predict_parallel */
+    ENGINE_INVERTED,    /* literal-major index rebuilt from the model, tsetlin_inverted_predict_parallel */
+    ENGINE_PRUNED       /* per sample with early exit on vote bounds, tsetlin_predict_batch_pruned */
+} engine_t;
+
+/* Compute accuracy with one batched prediction over all samples, split across the pool */
+static double compute_accuracy(tsetlin_t* ts, threadpool_t* pool, engine_t engine, const dataset_t* ds) {
+    int* preds = (int*)malloc(sizeof(int) * ds->n_samples);
+    if (!preds) return 0.0;
+
+    int status = -1;
+    if (engine == ENGINE_INVERTED) {
+        tsetlin_inverted_t* ix = tsetlin_inverted_new(ts);
+        if (ix) status = tsetlin_inverted_predict_parallel_packed(ix, pool, ds->X, ds->n_samples, preds, NULL);
+        tsetlin_inverted_free(ix);
+    }
+    else if (engine == ENGINE_PRUNED) {
+        double fraction = 0.0;
+        status = tsetlin_predict_batch_pruned(ts, ds->X, ds->n_samples, preds, &fraction);
+        log_info("Pruned prediction evaluated %.1f%% of clauses on average", fraction * 100.0);
+    }
+    else {
+        status = tsetlin_predict_parallel_packed(ts, pool, ds->X, ds->n_samples, preds, NULL);
+    }
+    if (status != 0) {
+        free(preds);
+        return 0.0;
+    }
 
-static uint8_t* load_idx_images(const char* path, int* out_count, int* out_rows, int* out_cols) {
-    FILE* f = fopen(path, "rb");
-    if (!f) return NULL;
-    uint32_t magic = read_be_u32(f);
-    uint32_t count = read_be_u32(f);
-    uint32_t rows = read_be_u32(f);
-    uint32_t cols = read_be_u32(f);
-    if (magic != 0x00000803) { fclose(f); return NULL; }
-    size_t total = (size_t)count * rows * cols;
-    uint8_t* buf = (uint8_t*)malloc(total);
-    if (!buf) { fclose(f); return NULL; }
-    if (fread(buf, 1, total, f) != total) { free(buf); fclose(f); return NULL; }
-    fclose(f);
-    *out_count = (int)count;
-    *out_rows = (int)rows;
-    *out_cols = (int)cols;
-    return buf;
+    int correct = 0;
+    for (int i = 0; i < ds->n_samples; ++i) {
+        if (preds[i] == ds->y[i]) ++correct;
+    }
+    free(preds);
+    return (double)correct / (double)ds->n_samples;
 }
 
-static uint8_t* load_idx_labels(const char* path, int* out_count) {
-    FILE* f = fopen(path, "rb");
-    if (!f) return NULL;
-    uint32_t magic = read_be_u32(f);
-    uint32_t count = read_be_u32(f);
-    if (magic != 0x00000801) { fclose(f); return NULL; }
-    uint8_t* buf = (uint8_t*)malloc(count);
-    if (!buf) { fclose(f); return NULL; }
-    if (fread(buf, 1, count, f) != count) { free(buf); fclose(f); return NULL; }
-    fclose(f);
-    *out_count = (int)count;
-    return buf;
+static double compute_compact_accuracy(const tsetlin_compact_t* cm, const dataset_t* ds) {
+    int correct = 0;
+    for (int i = 0; i < ds->n_samples; ++i) {
+        if (tsetlin_compact_predict_packed(cm, dataset_row(ds, i), NULL) == ds->y[i]) ++correct;
+    }
+    return (double)correct / (double)ds->n_samples;
 }
 
-/* Convert raw uint8 images to binary int arrays (0/1) using threshold */
-static int** binarize_images(uint8_t* images, int n, int rows, int cols, int threshold) {
-    int features = rows * cols;
-    int** out = (int**)malloc(sizeof(int*) * n);
-    if (!out) return NULL;
-    for (int i = 0; i < n; ++i) {
-        int* r = (int*)malloc(sizeof(int) * features);
-        if (!r) {
-            for (int j = 0; j < i; ++j) free(out[j]);
-            free(out);
-            return NULL;
+/* Map the binarized cache of an IDX image/label pair if it matches the files and threshold;
+ * otherwise binarize the files and write the cache for the next run (cache_path NULL: no cache). */
+static dataset_t* load_mnist(const char* images_path, const char* labels_path, int threshold, const char* cache_path) {
+    int32_t params = threshold;
+    uint64_t key = dataset_hash_file(images_path, DATASET_HASH_INIT);
+    key = dataset_hash_file(labels_path, key);
+    key = dataset_hash(&params, sizeof(params), key);
+
+    if (cache_path) {
+        dataset_t* cached = dataset_cache_open(cache_path, key, 10);
+        if (cached) {
+            log_info("Mapped binarized cache %s", cache_path);
+            return cached;
         }
-        uint8_t* src = images + (size_t)i * features;
-        for (int k = 0; k < features; ++k) r[k] = (src[k] > threshold) ? 1 : 0;
-        out[i] = r;
     }
-    return out;
-}
 
-/* Compute accuracy by predicting each sample */
-static double compute_accuracy(tsetlin_t* ts, int** X_samples, uint8_t* y, int n_samples) {
-    int correct = 0;
-    for (int i = 0; i < n_samples; ++i) {
-        int pred = tsetlin_predict(ts, X_samples[i], NULL);
-        if (pred == (int)y[i]) ++correct;
+    dataset_t* ds = dataset_load_idx(images_path, labels_path, threshold);
+    if (ds && cache_path) {
+        if (dataset_cache_save(ds, cache_path, key, &params, sizeof(params)) == 0) log_info("Wrote binarized cache %s", cache_path);
+        else log_error("Failed to write binarized cache %s", cache_path);
     }
-    return (double)correct / (double)n_samples;
+    return ds;
 }
 
 int main(int argc, char** argv) {
@@ -95,6 +95,16 @@ int main(int argc, char** argv) {
     bool flag_feedback = false;
     bool flag_compression = false;
     int threshold = -1;
+    int n_threads = 0; /* 0: one worker per CPU */
+    tsetlin_train_mode_t train_mode = TSETLIN_TRAIN_SERIAL;
+    clause_sampling_t sampling = CLAUSE_SAMPLING_BERNOULLI;
+    const char* model_path = "tsetlin_mnist.bin";
+    engine_t engine = ENGINE_CLAUSE;
+    bool flag_cache = true;
+    double stats_every = 0.0; /* > 0: dump training stats this often (TSETLIN_STATS builds) */
+    int mask_precision = RNG_MASK_PRECISION; /* --sampling bitsliced: bits of 1/s in the Type I masks */
+    int absorbing = 0; /* freeze automata at state 1 or N_STATE */
+    int chunk = 0; /* > 0: stream training data through a shuffling pipeline in chunks of this size */
 
     /* parse minimal arguments */
     for (int i = 1; i < argc; ++i) {
@@ -106,95 +116,218 @@ int main(int argc, char** argv) {
         else if (strcmp(argv[i], "--feedback") == 0) flag_feedback = true;
         else if (strcmp(argv[i], "--compression") == 0) flag_compression = true;
         else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) threshold = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) n_threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--train_mode") == 0 && i + 1 < argc) {
+            const char* mode = argv[++i];
+            if (strcmp(mode, "class") == 0) train_mode = TSETLIN_TRAIN_CLASS_PARALLEL;
+            else if (strcmp(mode, "hogwild") == 0) train_mode = TSETLIN_TRAIN_HOGWILD;
+            else train_mode = TSETLIN_TRAIN_SERIAL;
+        }
+        else if (strcmp(argv[i], "--save") == 0 && i + 1 < argc) model_path = argv[++i];
+        else if (strcmp(argv[i], "--no_cache") == 0) flag_cache = false;
+        else if (strcmp(argv[i], "--chunk") == 0 && i + 1 < argc) chunk = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--stats_every") == 0 && i + 1 < argc) stats_every = atof(argv[++i]);
+        else if (strcmp(argv[i], "--mask_precision") == 0 && i + 1 < argc) mask_precision = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--absorbing") == 0) absorbing = 1;
+        else if (strcmp(argv[i], "--engine") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            if (strcmp(name, "inverted") == 0) engine = ENGINE_INVERTED;
+            else if (strcmp(name, "pruned") == 0) engine = ENGINE_PRUNED;
+            else engine = ENGINE_CLAUSE;
+        }
+        else if (strcmp(argv[i], "--sampling") == 0 && i + 1 < argc) {
+            const char* name = argv[++i];
+            if (strcmp(name, "geometric") == 0) sampling = CLAUSE_SAMPLING_GEOMETRIC;
+            else if (strcmp(name, "bitsliced") == 0) sampling = CLAUSE_SAMPLING_BITSLICED;
+            else sampling = CLAUSE_SAMPLING_BERNOULLI;
+        }
     }
 
-    /* deterministic RNG same as Python seed(0) */
-    srand(0);
-
     log_info("Number of clauses: %d, Number of states: %d", N_CLAUSE, N_STATE);
     log_info("Threshold T: %d, Specificity s: %.2f", T, s);
 
-    /* Load MNIST (expects files in current directory) */
-    int train_count, rows, cols;
-    uint8_t* train_images = load_idx_images("mnist/train-images-idx3-ubyte", &train_count, &rows, &cols);
-    if (!train_images) { log_error("Failed to load train images"); return 1; }
-    int train_labels_count;
-    uint8_t* train_labels = load_idx_labels("mnist/train-labels-idx1-ubyte", &train_labels_count);
-    if (!train_labels || train_labels_count != train_count) { log_error("Failed to load train labels"); return 1; }
-
-    int test_count;
-    uint8_t* test_images = load_idx_images("mnist/t10k-images-idx3-ubyte", &test_count, &rows, &cols);
-    if (!test_images) { log_error("Failed to load test images"); return 1; }
-    int test_labels_count;
-    uint8_t* test_labels = load_idx_labels("mnist/t10k-labels-idx1-ubyte", &test_labels_count);
-    if (!test_labels || test_labels_count != test_count) { log_error("Failed to load test labels"); return 1; }
-
-    log_info("Train images: %d, Test images: %d, Image shape: %dx%d", train_count, test_count, rows, cols);
-
-    /* Binarize with threshold 75 */
-    int** X_train = binarize_images(train_images, train_count, rows, cols, 75);
-    int** X_test = binarize_images(test_images, test_count, rows, cols, 75);
-    if (!X_train || !X_test) { log_error("Failed to binarize images"); return 1; }
-
-    int n_features = rows * cols;
+    /* Load MNIST (expects files in current directory), binarized with threshold 75 */
+    double load_start = thread_clock_seconds();
+    dataset_t* train = load_mnist("mnist/train-images-idx3-ubyte", "mnist/train-labels-idx1-ubyte", 75,
+        flag_cache ? "mnist_train.tsd" : NULL);
+    if (!train) { log_error("Failed to load train images"); return 1; }
+    dataset_t* test = load_mnist("mnist/t10k-images-idx3-ubyte", "mnist/t10k-labels-idx1-ubyte", 75,
+        flag_cache ? "mnist_test.tsd" : NULL);
+    if (!test) { log_error("Failed to load test images"); return 1; }
+
+    log_info("Train images: %d, Test images: %d, Image shape: %dx%d", train->n_samples, test->n_samples, train->rows, train->cols);
+    size_t int_rows = sizeof(int) * (size_t)(train->n_samples + test->n_samples) * train->n_features;
+    size_t packed = dataset_size(train) + dataset_size(test);
+    log_info("Datasets ready in %.3fs: %zu bytes packed (%.1fx smaller than int rows)",
+        thread_clock_seconds() - load_start, packed, (double)int_rows / (double)packed);
+
+    int train_count = train->n_samples;
+    int n_features = train->n_features;
     tsetlin_t* ts = tsetlin_new(n_features, 10, N_CLAUSE, N_STATE);
     if (!ts) { log_error("Failed to allocate Tsetlin"); return 1; }
+    tsetlin_seed(ts, 0); /* deterministic training, as Python seed(0) */
+    tsetlin_set_sampling(ts, sampling);
+    if (mask_precision >= 1 && mask_precision <= 32) tsetlin_set_mask_precision(ts, mask_precision);
+    if (absorbing) {
+        tsetlin_set_absorbing(ts, 1);
+        log_info("Absorbing automata: converged literals leave training");
+    }
+    log_info("Feedback sampling: %s", (sampling == CLAUSE_SAMPLING_GEOMETRIC) ? "geometric"
+        : (sampling == CLAUSE_SAMPLING_BITSLICED) ? "bitsliced" : "bernoulli");
+    if (sampling == CLAUSE_SAMPLING_BITSLICED && (threshold >= 0 || absorbing)) {
+        log_warn("Bit-sliced sampling does not combine with --threshold or --absorbing: training samples as bernoulli");
+    }
+    else if (sampling != CLAUSE_SAMPLING_BITSLICED && mask_precision != RNG_MASK_PRECISION) {
+        log_warn("--mask_precision only applies to --sampling bitsliced");
+    }
 
-    double accuracy = compute_accuracy(ts, X_train, train_labels, train_count);
+    threadpool_t* pool = threadpool_new(n_threads);
+    if (!pool) { log_error("Failed to create thread pool"); return 1; }
+    log_info("Inference threads: %d, engine: %s", threadpool_size(pool), (engine == ENGINE_INVERTED) ? "inverted"
+        : (engine == ENGINE_PRUNED) ? "pruned" : "clause");
+
+    if (train_mode != TSETLIN_TRAIN_SERIAL) {
+        log_info("Training mode: %s", (train_mode == TSETLIN_TRAIN_HOGWILD) ? "hogwild" : "class-parallel");
+    }
+
+    pipeline_t* feed = NULL;
+    if (chunk > 0) {
+        feed = pipeline_new_dataset(train, chunk, 0);
+        if (!feed) { log_error("Failed to start the training data pipeline"); return 1; }
+        log_info("Streaming training data in shuffled chunks of %d samples", chunk);
+    }
+
+    if (stats_every > 0.0) {
+        if (tsetlin_stats_enabled()) tsetlin_stats_dump_every(stderr, stats_every);
+        else log_info("--stats_every needs a build with -DTSETLIN_STATS=ON");
+    }
+
+    double accuracy = compute_accuracy(ts, pool, engine, train);
     log_info("Initial train accuracy: %.2f%%", accuracy * 100.0);
 
     /* feedback accumulators per epoch if requested */
     for (int epoch = 0; epoch < epochs; ++epoch) {
         log_info("[Epoch %d/%d] Train Accuracy: %.2f%%", epoch + 1, epochs, accuracy * 100.0);
-        long target_type_1_count = 0;
-        long target_type_2_count = 0;
-        long non_target_type_1_count = 0;
-        long non_target_type_2_count = 0;
-
-        tqdm_t bar;
-        tqdm_init(&bar, (size_t)train_count, "Training", 50);
-
-        for (int i = 0; i < train_count; ++i) {
-            /* call training step; header signature may return feedback pointer or accept out param.
-               We ignore returned feedback pointer here to avoid depending on a particular
-               implementation. If your tsetlin_step implementation fills an out parameter,
-               adjust this call accordingly. */
-            (void)tsetlin_step(ts, X_train[i], (int)train_labels[i], T, s, NULL, threshold);
-            /* If your implementation returns a pointer with feedback counts, you can accumulate them here. */
-            if ((i & 0x3) == 0) { /* update occasionally for performance */
-                tqdm_update(&bar, (size_t)(i + 1));
+        long long target_type_1_count = 0;
+        long long target_type_2_count = 0;
+        long long non_target_type_1_count = 0;
+        long long non_target_type_2_count = 0;
+        tsetlin_train_stats_t stats;
+        tsetlin_stats_reset();
+        double epoch_start = thread_clock_seconds();
+
+        if (feed) {
+            /* The next chunk is read and shuffled on the pipeline thread while this one trains. */
+            double start = thread_clock_seconds();
+            double stall = pipeline_stall_seconds(feed);
+            long samples = 0;
+            const uint64_t* X;
+            const int* y;
+            int count;
+            while ((count = pipeline_next(feed, &X, &y)) > 0) {
+                if (tsetlin_fit_parallel(ts, pool, X, y, count, T, s, 1, threshold, train_mode, &stats) != 0) {
+                    log_error("Training failed");
+                    return 1;
+                }
+                target_type_1_count += stats.target_type1;
+                target_type_2_count += stats.target_type2;
+                non_target_type_1_count += stats.non_target_type1;
+                non_target_type_2_count += stats.non_target_type2;
+                samples += count;
+            }
+            if (count < 0) { log_error("Failed to read training data"); return 1; }
+            double seconds = thread_clock_seconds() - start;
+            log_info("Trained %ld streamed samples in %.2fs (%.0f samples/sec), %.3fs waiting for data",
+                samples, seconds, (seconds > 0.0) ? (double)samples / seconds : 0.0, pipeline_stall_seconds(feed) - stall);
+        }
+        else if (train_mode != TSETLIN_TRAIN_SERIAL || sampling == CLAUSE_SAMPLING_BITSLICED) {
+            /* Bit-sliced states only train through tsetlin_fit_parallel, serial mode included. */
+            if (tsetlin_fit_parallel(ts, pool, train->X, train->y, train_count, T, s, 1, threshold, train_mode, &stats) != 0) {
+                log_error("Training failed");
+                return 1;
             }
+            target_type_1_count = stats.target_type1;
+            target_type_2_count = stats.target_type2;
+            non_target_type_1_count = stats.non_target_type1;
+            non_target_type_2_count = stats.non_target_type2;
+            log_info("Trained %ld samples in %.2fs on %d threads (%.0f samples/sec)",
+                stats.samples, stats.seconds, stats.n_threads, stats.samples_per_sec);
         }
+        else {
+            tqdm_t bar;
+            tqdm_init(&bar, (size_t)train_count, "Training", 50);
 
-        accuracy = compute_accuracy(ts, X_train, train_labels, train_count);
+            for (int i = 0; i < train_count; ++i) {
+                tsetlin_feedback_t fb;
+                if (tsetlin_step_packed(ts, dataset_row(train, i), train->y[i], T, s, &fb, threshold) == 0) {
+                    target_type_1_count += fb.target_type1;
+                    target_type_2_count += fb.target_type2;
+                    non_target_type_1_count += fb.non_target_type1;
+                    non_target_type_2_count += fb.non_target_type2;
+                }
+                tsetlin_stats_poll();
+                if ((i & 0x3) == 0) { /* update occasionally for performance */
+                    tqdm_update(&bar, (size_t)(i + 1));
+                }
+            }
+        }
 
-        if (flag_feedback) {
-            log_info("Epoch feedback (not collected in this C port): Target Type I: %ld, Type II: %ld, NonTarget Type I: %ld, Type II: %ld",
-                target_type_1_count, target_type_2_count, non_target_type_1_count, non_target_type_2_count);
+        if (tsetlin_stats_enabled()) {
+            tsetlin_stats_t epoch_stats;
+            tsetlin_stats_snapshot(&epoch_stats);
+            tsetlin_stats_print(stderr, &epoch_stats, thread_clock_seconds() - epoch_start);
         }
 
-        if (flag_compression) {
-            /* The Python script asks user whether to compress and exit  here we skip interactive prompt for non-interactive runs. */
-            log_info("Compression enabled but interactive prompt is skipped in C port.");
+        accuracy = compute_accuracy(ts, pool, engine, train);
+        if (absorbing) log_info("Live automata: %.2f%%", tsetlin_live_fraction(ts) * 100.0);
+
+        if (flag_feedback) {
+            log_info("Epoch feedback: Target Type I: %lld, Type II: %lld, NonTarget Type I: %lld, Type II: %lld",
+                target_type_1_count, target_type_2_count, non_target_type_1_count, non_target_type_2_count);
         }
     }
 
     /* Final evaluation */
-    double test_acc = compute_accuracy(ts, X_test, test_labels, test_count);
-    log_info("Test Accuracy: %.2f%%", test_acc * 100.0);
+    double eval_start = thread_clock_seconds();
+    double test_acc = compute_accuracy(ts, pool, engine, test);
+    log_info("Test Accuracy: %.2f%% (%d samples in %.3fs)", test_acc * 100.0, test->n_samples, thread_clock_seconds() - eval_start);
 
-    log_info("Model save/load not implemented in this C port.");
+    /* Export the included literals only, as the inference model for deployment. */
+    if (flag_compression) {
+        tsetlin_compact_t* cm = tsetlin_compact_new(ts);
+        if (!cm) log_error("Failed to compress model");
+        else {
+            size_t full = tsetlin_arena_size(ts->n_features, ts->n_classes, ts->n_clauses);
+            size_t compact = tsetlin_compact_size(cm);
+            log_info("Compact model: %zu bytes (full model %zu bytes, %.1fx smaller), %d of %d clauses kept",
+                compact, full, (double)full / (double)compact, cm->n_kept, ts->n_classes * ts->n_clauses);
+            log_info("Compact test accuracy: %.2f%%", compute_compact_accuracy(cm, test) * 100.0);
+            if (tsetlin_compact_save(cm, "tsetlin_mnist_compact.bin") == 0) log_info("Saved compact model to tsetlin_mnist_compact.bin");
+            tsetlin_compact_free(cm);
+        }
+    }
+
+    /* Save, then serve predictions straight from the mapped file as a check. */
+    if (tsetlin_save(ts, model_path) != 0) {
+        log_error("Failed to save model to %s", model_path);
+    }
+    else {
+        log_info("Saved model to %s", model_path);
+        tsetlin_t* mapped = tsetlin_map(model_path);
+        if (!mapped) log_error("Failed to map model %s", model_path);
+        else {
+            double mapped_acc = compute_accuracy(mapped, pool, engine, test);
+            log_info("Loaded mapped model: test accuracy %.2f%%", mapped_acc * 100.0);
+            tsetlin_free(mapped);
+        }
+    }
 
     /* Cleanup */
+    pipeline_free(feed);
+    threadpool_free(pool);
     tsetlin_free(ts);
-    for (int i = 0; i < train_count; ++i) free(X_train[i]);
-    for (int i = 0; i < test_count; ++i) free(X_test[i]);
-    free(X_train);
-    free(X_test);
-    free(train_images);
-    free(test_images);
-    free(train_labels);
-    free(test_labels);
+    dataset_free(train);
+    dataset_free(test);
 
     return 0;
 }
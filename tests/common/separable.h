@@ -0,0 +1,29 @@
+#ifndef TSETLIN_TESTS_SEPARABLE_H
+#define TSETLIN_TESTS_SEPARABLE_H
+
+/* Synthetic, linearly separable training data shared by the unit tests. */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <bitpack.h>
+#include <rng.h>
+
+/*
+ * Sample i is class i % n_classes. Class c sets features [10c, 10c + 10) and clears the other
+ * classes' features; the rest is noise drawn from rng. Fills n_samples packed rows of X
+ * (BITPACK_WORDS(n_features) words each) and the labels y. Needs n_features >= 10 * n_classes.
+ */
+static inline void separable_dataset(int n_features, int n_classes, int n_samples, rng_t* rng, uint64_t* X, int* y) {
+    int n_words = BITPACK_WORDS(n_features);
+    for (int i = 0; i < n_samples; ++i) {
+        uint64_t* row = X + (size_t)i * n_words;
+        memset(row, 0, sizeof(uint64_t) * n_words);
+        y[i] = i % n_classes;
+        for (int k = 0; k < n_features; ++k) {
+            if ((k / 10 == y[i]) || (k >= 10 * n_classes && rng_below(rng, 2))) bitpack_set(row, k);
+        }
+    }
+}
+
+#endif /* TSETLIN_TESTS_SEPARABLE_H */
@@ -0,0 +1,208 @@
+/* =========================================================================
+    Unity - A Test Framework for C
+    ThrowTheSwitch.org
+    Copyright (c) 2007-25 Mike Karlesky, Mark VanderVoord, & Greg Williams
+    SPDX-License-Identifier: MIT
+========================================================================= */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <unity.h>
+#include <log.h>
+
+#include <bitslice.h>
+#include <tsetlin.h>
+#include <threadpool.h>
+
+#include "../common/separable.h"
+
+#define N_FEATURE 100
+#define N_STATE 100
+
+static rng_t rng;
+
+void setUp(void) {
+    rng_seed(&rng, 11);
+}
+
+void tearDown(void) {
+}
+
+static clause_t* random_clause(int n_states) {
+    clause_t* c = clause_new(N_FEATURE, n_states, &rng);
+    TEST_ASSERT_NOT_NULL(c);
+    for (int k = 0; k < c->N_literals; ++k) clause_set_automaton(c, k, 1 + rng_below(&rng, n_states));
+    clause_compress(c, -1);
+    return c;
+}
+
+static void random_row(uint64_t* X) {
+    int n_words = BITPACK_WORDS(N_FEATURE);
+    for (int w = 0; w < n_words; ++w) X[w] = rng_next(&rng);
+    X[n_words - 1] &= ((uint64_t)1 << (N_FEATURE % 64)) - 1;
+}
+
+static uint64_t* new_planes(int n_states) {
+    uint64_t* planes = (uint64_t*)malloc(bitslice_footprint(N_FEATURE, n_states));
+    TEST_ASSERT_NOT_NULL(planes);
+    return planes;
+}
+
+void test_load_store_roundtrip(void) {
+    int n_states[] = { N_STATE, 64, 2 };
+    for (int t = 0; t < 3; ++t) {
+        clause_t* c = random_clause(n_states[t]);
+        clause_t* back = clause_new(N_FEATURE, n_states[t], &rng);
+        uint64_t* planes = new_planes(n_states[t]);
+        bitslice_t bs;
+        bitslice_init(&bs, N_FEATURE, n_states[t], planes);
+        for (int k = 0; k < 2 * N_FEATURE; ++k) TEST_ASSERT_EQUAL_INT(1, bitslice_get(&bs, k));
+
+        bitslice_load(&bs, c);
+        bitslice_store(&bs, back);
+        for (int k = 0; k < c->N_literals; ++k) {
+            TEST_ASSERT_EQUAL_INT(c->p_automata[k], bitslice_get(&bs, k));
+            TEST_ASSERT_EQUAL_INT(c->p_automata[k], back->p_automata[k]);
+        }
+        TEST_ASSERT_EQUAL_INT(c->p_included_count, back->p_included_count);
+        TEST_ASSERT_EQUAL_INT(c->n_included_count, back->n_included_count);
+
+        /* Top plane is the include mask. */
+        for (int k = 0; k < N_FEATURE; ++k) {
+            int p = (int)((bitslice_p_include(&bs)[k >> 6] >> (k & 63)) & 1);
+            int n = (int)((bitslice_n_include(&bs)[k >> 6] >> (k & 63)) & 1);
+            TEST_ASSERT_EQUAL_INT(c->p_automata[k] > n_states[t] / 2, p);
+            TEST_ASSERT_EQUAL_INT(c->n_automata[k] > n_states[t] / 2, n);
+        }
+
+        free(planes);
+        clause_free(c);
+        clause_free(back);
+    }
+}
+
+void test_increment_decrement_saturate(void) {
+    uint64_t* planes = new_planes(N_STATE);
+    bitslice_t bs;
+    bitslice_init(&bs, N_FEATURE, N_STATE, planes);
+
+    /* Everything starts at state 1: penalties are dropped, rewards count. */
+    TEST_ASSERT_EQUAL_UINT64(0, bitslice_decrement(&bs, 0, ~(uint64_t)0));
+    for (int i = 1; i < N_STATE; ++i) TEST_ASSERT_EQUAL_UINT64(0x5, bitslice_increment(&bs, 0, 0x5));
+    TEST_ASSERT_EQUAL_INT(N_STATE, bitslice_get(&bs, 0));
+    TEST_ASSERT_EQUAL_INT(N_STATE, bitslice_get(&bs, 2));
+    TEST_ASSERT_EQUAL_INT(1, bitslice_get(&bs, 1));
+    TEST_ASSERT_EQUAL_UINT64(0x2, bitslice_increment(&bs, 0, 0x7));
+    TEST_ASSERT_EQUAL_INT(N_STATE, bitslice_get(&bs, 0));
+    TEST_ASSERT_EQUAL_INT(2, bitslice_get(&bs, 1));
+
+    TEST_ASSERT_EQUAL_UINT64(0x7, bitslice_decrement(&bs, 0, 0x7));
+    TEST_ASSERT_EQUAL_INT(N_STATE - 1, bitslice_get(&bs, 0));
+    TEST_ASSERT_EQUAL_INT(1, bitslice_get(&bs, 1));
+    free(planes);
+}
+
+void test_type2_matches_clause_update(void) {
+    uint64_t X[BITPACK_WORDS(N_FEATURE)];
+    for (int t = 0; t < 20; ++t) {
+        clause_t* c = random_clause(N_STATE);
+        uint64_t* planes = new_planes(N_STATE);
+        bitslice_t bs;
+        bitslice_init(&bs, N_FEATURE, N_STATE, planes);
+        bitslice_load(&bs, c);
+
+        for (int step = 0; step < 10; ++step) {
+            random_row(X);
+            TEST_ASSERT_EQUAL_INT(clause_evaluate_packed(c, X), bitslice_evaluate(&bs, X));
+            int expected = clause_update_packed(c, X, 0, 1, 3.0, -1, &rng);
+            TEST_ASSERT_EQUAL_INT(expected, bitslice_update(&bs, X, 0, 1, 3.0, &rng));
+        }
+        for (int k = 0; k < c->N_literals; ++k) TEST_ASSERT_EQUAL_INT(c->p_automata[k], bitslice_get(&bs, k));
+
+        free(planes);
+        clause_free(c);
+    }
+}
+
+void test_type1_moves_by_one(void) {
+    uint64_t X[BITPACK_WORDS(N_FEATURE)];
+    clause_t* c = random_clause(N_STATE);
+    uint64_t* planes = new_planes(N_STATE);
+    bitslice_t bs;
+    bitslice_init(&bs, N_FEATURE, N_STATE, planes);
+    bitslice_load(&bs, c);
+    random_row(X);
+
+    /* Erase only penalizes; recognize rewards true literals and penalizes false ones. */
+    int events = bitslice_update(&bs, X, 1, 0, 4.0, &rng);
+    int moved = 0;
+    for (int k = 0; k < c->N_literals; ++k) {
+        int delta = bitslice_get(&bs, k) - c->p_automata[k];
+        TEST_ASSERT_TRUE(delta == 0 || delta == -1);
+        moved -= delta;
+    }
+    TEST_ASSERT_EQUAL_INT(moved, events);
+    TEST_ASSERT_TRUE(events > 0);
+
+    bitslice_store(&bs, c);
+    events = bitslice_update(&bs, X, 1, 1, 4.0, &rng);
+    moved = 0;
+    for (int k = 0; k < c->N_literals; ++k) {
+        int i = k % N_FEATURE;
+        int x = (int)((X[i >> 6] >> (i & 63)) & 1);
+        int literal_true = (k < N_FEATURE) ? x : !x;
+        int delta = bitslice_get(&bs, k) - c->p_automata[k];
+        TEST_ASSERT_TRUE(delta == 0 || delta == (literal_true ? 1 : -1));
+        moved += (delta != 0);
+    }
+    TEST_ASSERT_EQUAL_INT(moved, events);
+
+    /* No Type I events without s > 0, as clause_update_packed. */
+    TEST_ASSERT_EQUAL_INT(0, bitslice_update(&bs, X, 1, 0, 0.0, &rng));
+
+    free(planes);
+    clause_free(c);
+}
+
+void test_bitsliced_training_learns(void) {
+    enum { N_CLASS = 3, N_TRAIN = 300 };
+    int n_words = BITPACK_WORDS(N_FEATURE);
+    uint64_t* X = (uint64_t*)malloc(sizeof(uint64_t) * n_words * N_TRAIN);
+    int y[N_TRAIN];
+    separable_dataset(N_FEATURE, N_CLASS, N_TRAIN, &rng, X, y);
+
+    threadpool_t* pool = threadpool_new(4);
+    TEST_ASSERT_NOT_NULL(pool);
+    tsetlin_train_mode_t modes[] = { TSETLIN_TRAIN_SERIAL, TSETLIN_TRAIN_CLASS_PARALLEL, TSETLIN_TRAIN_HOGWILD };
+    for (int m = 0; m < 3; ++m) {
+        tsetlin_t* model = tsetlin_new(N_FEATURE, N_CLASS, 20, 10);
+        TEST_ASSERT_NOT_NULL(model);
+        tsetlin_set_sampling(model, CLAUSE_SAMPLING_BITSLICED);
+        tsetlin_train_stats_t stats;
+        TEST_ASSERT_EQUAL_INT(0, tsetlin_fit_parallel(model, pool, X, y, N_TRAIN, 10, 3.0, 5, -1, modes[m], &stats));
+        TEST_ASSERT_TRUE(stats.target_type1 + stats.target_type2 > 0);
+
+        int correct = 0;
+        for (int i = 0; i < N_TRAIN; ++i) correct += (tsetlin_predict_packed(model, X + (size_t)i * n_words, NULL) == y[i]);
+        TEST_ASSERT_TRUE(correct > 0.9 * N_TRAIN);
+        tsetlin_free(model);
+    }
+
+    threadpool_free(pool);
+    free(X);
+}
+
+/* not needed when using generate_test_runner.rb */
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_load_store_roundtrip);
+    RUN_TEST(test_increment_decrement_saturate);
+    RUN_TEST(test_type2_matches_clause_update);
+    RUN_TEST(test_type1_moves_by_one);
+    RUN_TEST(test_bitsliced_training_learns);
+
+    return UNITY_END();
+}
@@ -5,39 +5,43 @@
     SPDX-License-Identifier: MIT
 ========================================================================= */
 
+#include <stdlib.h>
+#include <string.h>
+
 #include <unity.h>
 #include <log.h>
 
+#include <bitpack.h>
 #include <clause.h>
+#include <rng.h>
+
+static rng_t rng;
 
 void setUp(void) {
+    rng_seed(&rng, 42);
 }
 
 void tearDown(void) {
 }
 
-/* Helper to update automata actions after direct state manipulation */
+/* Helper to rebuild index lists after direct state manipulation */
 static void update_actions_and_compress(clause_t* c) {
-    for (int i = 0; i < c->N_feature; ++i) {
-        automaton_update(c->p_automata[i]);
-        automaton_update(c->n_automata[i]);
-    }
     clause_compress(c, -1);
 }
 
 static void test_clause_evaluate(void) {
-    clause_t* clause = clause_new(3, 10);
+    clause_t* clause = clause_new(3, 10, &rng);
     TEST_ASSERT_NOT_NULL(clause);
 
     /* Manually set automata states to control actions */
-    clause->p_automata[0]->state = 6; /* Include feature 0 */
-    clause->n_automata[0]->state = 5; /* Exclude (NOT feature 0) */
+    clause->p_automata[0] = 6; /* Include feature 0 */
+    clause->n_automata[0] = 5; /* Exclude (NOT feature 0) */
 
-    clause->p_automata[1]->state = 4; /* Exclude feature 1 */
-    clause->n_automata[1]->state = 7; /* Include (NOT feature 1) */
+    clause->p_automata[1] = 4; /* Exclude feature 1 */
+    clause->n_automata[1] = 7; /* Include (NOT feature 1) */
 
-    clause->p_automata[2]->state = 6; /* Include feature 2 */
-    clause->n_automata[2]->state = 5; /* Exclude (NOT feature 2) */
+    clause->p_automata[2] = 6; /* Include feature 2 */
+    clause->n_automata[2] = 5; /* Exclude (NOT feature 2) */
 
     /* Recompute actions and rebuild compressed lists */
     update_actions_and_compress(clause);
@@ -56,15 +60,15 @@ static void test_clause_evaluate(void) {
 }
 
 static void test_clause_update(void) {
-    clause_t* clause = clause_new(2, 10);
+    clause_t* clause = clause_new(2, 10, &rng);
     TEST_ASSERT_NOT_NULL(clause);
 
     /* Manually set automata states to control actions */
-    clause->p_automata[0]->state = 6; /* Include feature 0 */
-    clause->n_automata[0]->state = 5; /* Exclude (NOT feature 0) */
+    clause->p_automata[0] = 6; /* Include feature 0 */
+    clause->n_automata[0] = 5; /* Exclude (NOT feature 0) */
 
-    clause->p_automata[1]->state = 4; /* Exclude feature 1 */
-    clause->n_automata[1]->state = 7; /* Include (NOT feature 1) */
+    clause->p_automata[1] = 4; /* Exclude feature 1 */
+    clause->n_automata[1] = 7; /* Include (NOT feature 1) */
 
     update_actions_and_compress(clause);
 
@@ -73,22 +77,277 @@ static void test_clause_update(void) {
     TEST_ASSERT_EQUAL_INT(1, clause_output);
 
     /* Perform update: match_target=1 (Type I), s=3.0, threshold=-1 */
-    int feedback = clause_update(clause, X, 1, clause_output, 3.0, -1);
+    int feedback = clause_update(clause, X, 1, clause_output, 3.0, -1, &rng);
 
     /* At least some feedback count may be zero depending on RNG; still check state property */
-    TEST_ASSERT_TRUE(clause->p_automata[0]->state >= 6);
+    TEST_ASSERT_TRUE(clause->p_automata[0] >= 6);
 
     (void)feedback; /* silence unused-variable if needed */
 
     clause_free(clause);
 }
 
+static void test_clause_state_layout(void) {
+    clause_t* clause = clause_new(4, 10, &rng);
+    TEST_ASSERT_NOT_NULL(clause);
+
+    /* Positive and negated automata share one contiguous block. */
+    TEST_ASSERT_TRUE(clause->n_automata == clause->p_automata + 4);
+
+    int states[8] = { 1, 2, 6, 10, 5, 2, 3, 4 };
+    clause_set_state(clause, states, -1);
+
+    int* out = clause_get_state(clause);
+    TEST_ASSERT_NOT_NULL(out);
+    TEST_ASSERT_EQUAL_INT_ARRAY(states, out, 8);
+    free(out);
+
+    TEST_ASSERT_EQUAL_INT(6, clause_get_automaton(clause, 2));
+    TEST_ASSERT_EQUAL_INT(1, clause_get_action(clause, 2));
+    TEST_ASSERT_EQUAL_INT(0, clause_get_action(clause, 4));
+
+    clause_set_automaton(clause, 4, 6);
+    clause_compress(clause, -1);
+    TEST_ASSERT_EQUAL_INT(1, clause->n_included_count);
+    TEST_ASSERT_EQUAL_INT(0, clause->n_included_idxs[0]);
+
+    clause_free(clause);
+}
+
+static void test_clause_evaluate_packed(void) {
+    enum { N = 130 }; /* spans three words, last one partially used */
+    clause_t* clause = clause_new(N, 10, &rng);
+    TEST_ASSERT_NOT_NULL(clause);
+    TEST_ASSERT_EQUAL_INT(BITPACK_WORDS(N), clause->N_words);
+
+    int X[N];
+    uint64_t Xp[BITPACK_WORDS(N)];
+    for (int round = 0; round < 200; ++round) {
+        /* Sparse random includes so that the clause fires on some inputs. */
+        for (int i = 0; i < N; ++i) {
+            clause->p_automata[i] = (rand() % 64 == 0) ? 6 : 5;
+            clause->n_automata[i] = (rand() % 64 == 0) ? 6 : 5;
+            X[i] = rand() % 2;
+        }
+        update_actions_and_compress(clause);
+
+        bitpack_pack(X, N, Xp);
+        TEST_ASSERT_EQUAL_INT(clause_evaluate(clause, X), clause_evaluate_packed(clause, Xp));
+    }
+
+    clause_free(clause);
+}
+
+/* Included lists and masks as membership flags (the lists are unordered). */
+static void included_members(const clause_t* c, int* members, uint64_t* masks) {
+    for (int i = 0; i < 2 * c->N_feature; ++i) members[i] = 0;
+    for (int ii = 0; ii < c->p_included_count; ++ii) members[c->p_included_idxs[ii]]++;
+    for (int ii = 0; ii < c->n_included_count; ++ii) members[c->N_feature + c->n_included_idxs[ii]]++;
+    for (int w = 0; w < 2 * c->N_words; ++w) masks[w] = c->p_include_mask[w];
+}
+
+static void test_clause_update_keeps_lists_exact(void) {
+    enum { N = 100 };
+    clause_t* clause = clause_new(N, 6, &rng);
+    TEST_ASSERT_NOT_NULL(clause);
+
+    int X[N];
+    uint64_t Xp[BITPACK_WORDS(N)];
+    int members[2 * N], expected_members[2 * N];
+    uint64_t masks[2 * BITPACK_WORDS(N)], expected_masks[2 * BITPACK_WORDS(N)];
+    for (int round = 0; round < 500; ++round) {
+        for (int i = 0; i < N; ++i) X[i] = rand() % 2;
+        bitpack_pack(X, N, Xp);
+        int match_target = rand() % 2;
+        int output = clause_evaluate_packed(clause, Xp);
+        if (round % 2) clause_update_packed(clause, Xp, match_target, output, 3.0, -1, &rng);
+        else clause_update_geometric(clause, Xp, match_target, output, 3.0, -1, &rng);
+
+        included_members(clause, members, masks);
+        clause_compress(clause, -1);
+        included_members(clause, expected_members, expected_masks);
+        TEST_ASSERT_EQUAL_INT_ARRAY(expected_members, members, 2 * N);
+        TEST_ASSERT_EQUAL_MEMORY(expected_masks, masks, sizeof(masks));
+    }
+
+    clause_free(clause);
+}
+
+/*
+ * Mean per-automaton state change over many updates from the same start, per sampling path.
+ * Start states alternate between the bounds and the middle so the guards are exercised.
+ */
+static void mean_deltas(clause_sampling_t sampling, int clause_output, int threshold, const uint64_t* Xp,
+    int n, int rounds, double* deltas, double* mean_feedback) {
+    int start[2 * 64];
+    for (int k = 0; k < 2 * n; ++k) start[k] = (k % 7 == 0) ? 1 : (k % 11 == 0) ? 10 : 4 + k % 4;
+    for (int k = 0; k < 2 * n; ++k) deltas[k] = 0.0;
+    *mean_feedback = 0.0;
+
+    clause_t* clause = clause_new(n, 10, &rng);
+    TEST_ASSERT_NOT_NULL(clause);
+    for (int r = 0; r < rounds; ++r) {
+        clause_set_state(clause, start, threshold);
+        int feedback = (sampling == CLAUSE_SAMPLING_GEOMETRIC)
+            ? clause_update_geometric(clause, Xp, 1, clause_output, 4.0, threshold, &rng)
+            : clause_update_packed(clause, Xp, 1, clause_output, 4.0, threshold, &rng);
+        *mean_feedback += (double)feedback / rounds;
+        for (int k = 0; k < 2 * n; ++k) deltas[k] += (double)(clause_get_automaton(clause, k) - start[k]) / rounds;
+    }
+    clause_free(clause);
+}
+
+static void test_clause_update_geometric_equivalent(void) {
+    enum { N = 64, ROUNDS = 4000 };
+    int X[N];
+    uint64_t Xp[BITPACK_WORDS(N)];
+    for (int i = 0; i < N; ++i) X[i] = (i * 5) % 3 == 0;
+    bitpack_pack(X, N, Xp);
+
+    double expected[2 * N], actual[2 * N];
+    for (int clause_output = 0; clause_output <= 1; ++clause_output) {
+        for (int threshold = -1; threshold <= 2; threshold += 3) {
+            double expected_feedback, actual_feedback;
+            mean_deltas(CLAUSE_SAMPLING_BERNOULLI, clause_output, threshold, Xp, N, ROUNDS, expected, &expected_feedback);
+            mean_deltas(CLAUSE_SAMPLING_GEOMETRIC, clause_output, threshold, Xp, N, ROUNDS, actual, &actual_feedback);
+
+            /* each delta is a mean of ROUNDS draws in [-1, 1]: std <= 0.016 */
+            for (int k = 0; k < 2 * N; ++k) TEST_ASSERT_DOUBLE_WITHIN(0.08, expected[k], actual[k]);
+            TEST_ASSERT_DOUBLE_WITHIN(0.03 * expected_feedback + 0.1, expected_feedback, actual_feedback);
+        }
+    }
+}
+
+/* Sorted trainable members of one half, for comparison with the live automata. */
+static int sorted_trainable(const int* idxs, int count, int* out) {
+    int n = 0;
+    for (int ii = 0; ii < count; ++ii) out[n++] = idxs[ii];
+    for (int a = 1; a < n; ++a) {
+        for (int b = a; b > 0 && out[b - 1] > out[b]; --b) {
+            int t = out[b];
+            out[b] = out[b - 1];
+            out[b - 1] = t;
+        }
+    }
+    return n;
+}
+
+static void test_clause_absorbing_freezes_bounds(void) {
+    enum { N = 64, STATES = 6 };
+    clause_t* clause = clause_new(N, STATES, &rng);
+    TEST_ASSERT_NOT_NULL(clause);
+    clause_set_absorbing(clause, 1);
+    TEST_ASSERT_EQUAL_INT(N, clause->p_trainable_count);
+    TEST_ASSERT_EQUAL_INT(2 * N, clause_live_count(clause));
+
+    int X[N];
+    uint64_t Xp[BITPACK_WORDS(N)];
+    int before[2 * N];
+    int live[N], listed[N];
+    for (int round = 0; round < 2000; ++round) {
+        for (int i = 0; i < N; ++i) X[i] = rand() % 2;
+        bitpack_pack(X, N, Xp);
+        for (int k = 0; k < 2 * N; ++k) before[k] = clause_get_automaton(clause, k);
+
+        int output = clause_evaluate_packed(clause, Xp);
+        if (round % 2) clause_update_packed(clause, Xp, rand() % 2, output, 3.0, -1, &rng);
+        else clause_update_geometric(clause, Xp, rand() % 2, output, 3.0, -1, &rng);
+
+        /* absorbed automata never move again */
+        for (int k = 0; k < 2 * N; ++k) {
+            if (before[k] == 1 || before[k] == STATES) TEST_ASSERT_EQUAL_INT(before[k], clause_get_automaton(clause, k));
+        }
+
+        /* the trainable lists are exactly the live automata */
+        for (int half = 0; half < 2; ++half) {
+            int n_live = 0;
+            for (int i = 0; i < N; ++i) {
+                int state = clause_get_automaton(clause, half * N + i);
+                if (state > 1 && state < STATES) live[n_live++] = i;
+            }
+            int n_listed = half ? sorted_trainable(clause->n_trainable_idxs, clause->n_trainable_count, listed)
+                                : sorted_trainable(clause->p_trainable_idxs, clause->p_trainable_count, listed);
+            TEST_ASSERT_EQUAL_INT(n_live, n_listed);
+            if (n_live) TEST_ASSERT_EQUAL_INT_ARRAY(live, listed, n_live);
+        }
+    }
+    TEST_ASSERT_TRUE(clause_live_count(clause) < N); /* most automata converge with 6 states */
+
+    /* Off again: every automaton trains, the bounds are ordinary states. */
+    clause_set_absorbing(clause, 0);
+    TEST_ASSERT_EQUAL_INT(0, clause->p_trainable_count + clause->n_trainable_count);
+    clause_free(clause);
+}
+
+static void test_clause_threshold_lists_incremental(void) {
+    enum { N = 100, STATES = 20 };
+    clause_t* clause = clause_new(N, STATES, &rng);
+    TEST_ASSERT_NOT_NULL(clause);
+
+    int X[N];
+    uint64_t Xp[BITPACK_WORDS(N)];
+    int before[2 * N];
+    int expected[N], listed[N];
+    for (int round = 0; round < 1000; ++round) {
+        /* A new threshold rebuilds the lists once, and so does the old one after unthresholded
+         * updates, which may move any automaton. */
+        int threshold = (round < 400) ? 3 : (round < 600) ? -1 : (round < 800) ? 3 : 5;
+        int rebuilt = (clause->trainable_threshold != threshold);
+        for (int i = 0; i < N; ++i) X[i] = rand() % 2;
+        bitpack_pack(X, N, Xp);
+        for (int k = 0; k < 2 * N; ++k) before[k] = clause_get_automaton(clause, k);
+        int listed_before[2 * N];
+        for (int k = 0; k < 2 * N; ++k) listed_before[k] = 0;
+        if (clause->trainable_threshold == threshold) {
+            for (int ii = 0; ii < clause->p_trainable_count; ++ii) listed_before[clause->p_trainable_idxs[ii]] = 1;
+            for (int ii = 0; ii < clause->n_trainable_count; ++ii) listed_before[N + clause->n_trainable_idxs[ii]] = 1;
+        }
+
+        int output = clause_evaluate_packed(clause, Xp);
+        if (round % 2) clause_update_packed(clause, Xp, rand() % 2, output, 3.0, threshold, &rng);
+        else clause_update_geometric(clause, Xp, rand() % 2, output, 3.0, threshold, &rng);
+        if (threshold < 0) {
+            TEST_ASSERT_TRUE(clause->trainable_threshold < -1); /* lists kept for a threshold are stale */
+            continue;
+        }
+        TEST_ASSERT_EQUAL_INT(threshold, clause->trainable_threshold);
+
+        /* only automata listed before the update moved */
+        if (!rebuilt) {
+            for (int k = 0; k < 2 * N; ++k) {
+                if (!listed_before[k]) TEST_ASSERT_EQUAL_INT(before[k], clause_get_automaton(clause, k));
+            }
+        }
+
+        /* the kept lists equal a rebuild from the states */
+        for (int half = 0; half < 2; ++half) {
+            int n_expected = 0;
+            for (int i = 0; i < N; ++i) {
+                int state = clause_get_automaton(clause, half * N + i);
+                if (abs(state - STATES / 2) <= threshold) expected[n_expected++] = i;
+            }
+            int n_listed = half ? sorted_trainable(clause->n_trainable_idxs, clause->n_trainable_count, listed)
+                                : sorted_trainable(clause->p_trainable_idxs, clause->p_trainable_count, listed);
+            TEST_ASSERT_EQUAL_INT(n_expected, n_listed);
+            if (n_expected) TEST_ASSERT_EQUAL_INT_ARRAY(expected, listed, n_expected);
+        }
+    }
+
+    clause_free(clause);
+}
+
 /* not needed when using generate_test_runner.rb */
 int main(void) {
     UNITY_BEGIN();
 
     RUN_TEST(test_clause_evaluate);
     RUN_TEST(test_clause_update);
+    RUN_TEST(test_clause_state_layout);
+    RUN_TEST(test_clause_evaluate_packed);
+    RUN_TEST(test_clause_update_geometric_equivalent);
+    RUN_TEST(test_clause_update_keeps_lists_exact);
+    RUN_TEST(test_clause_absorbing_freezes_bounds);
+    RUN_TEST(test_clause_threshold_lists_incremental);
 
     return UNITY_END();
 }
\ No newline at end of file
@@ -0,0 +1,33 @@
+/* Train and save a small model for unit_test_codegen: make_model PATH */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <tsetlin.h>
+
+#include "../common/separable.h"
+
+#define N_FEATURE 100 /* not a multiple of 64 */
+#define N_CLASS 3
+#define N_SAMPLE 600
+
+int main(int argc, char** argv) {
+    if (argc < 2) return 2;
+
+    tsetlin_t* ts = tsetlin_new(N_FEATURE, N_CLASS, 20, 10);
+    if (!ts) return 1;
+
+    static uint64_t X[N_SAMPLE * BITPACK_WORDS(N_FEATURE)];
+    static int y[N_SAMPLE];
+    rng_t rng;
+    rng_seed(&rng, 5);
+    separable_dataset(N_FEATURE, N_CLASS, N_SAMPLE, &rng, X, y);
+
+    int status = 0;
+    for (int i = 0; i < N_SAMPLE && status == 0; ++i) {
+        if (tsetlin_step_packed(ts, X + (size_t)i * BITPACK_WORDS(N_FEATURE), y[i], 10, 3.0, NULL, -1) != 0) status = 1;
+    }
+
+    if (status == 0 && tsetlin_save(ts, argv[1]) != 0) status = 1;
+    tsetlin_free(ts);
+    return status;
+}
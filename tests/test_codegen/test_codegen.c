@@ -0,0 +1,59 @@
+/* =========================================================================
+    Unity - A Test Framework for C
+    ThrowTheSwitch.org
+    Copyright (c) 2007-25 Mike Karlesky, Mark VanderVoord, & Greg Williams
+    SPDX-License-Identifier: MIT
+========================================================================= */
+
+#include <stdlib.h>
+
+#include <unity.h>
+#include <log.h>
+
+#include <tsetlin.h>
+#include "codegen_model.h" /* generated from CODEGEN_MODEL_PATH by tsetlin_codegen */
+
+static tsetlin_t* ts;
+
+void setUp(void) {
+    ts = tsetlin_load(CODEGEN_MODEL_PATH);
+}
+
+void tearDown(void) {
+    tsetlin_free(ts);
+}
+
+static void test_codegen_dimensions(void) {
+    TEST_ASSERT_NOT_NULL(ts);
+    TEST_ASSERT_EQUAL_INT(CODEGEN_MODEL_N_FEATURES, ts->n_features);
+    TEST_ASSERT_EQUAL_INT(CODEGEN_MODEL_N_CLASSES, ts->n_classes);
+    TEST_ASSERT_EQUAL_INT(CODEGEN_MODEL_N_WORDS, BITPACK_WORDS(ts->n_features));
+}
+
+static void test_codegen_matches_model(void) {
+    TEST_ASSERT_NOT_NULL(ts);
+
+    int X[CODEGEN_MODEL_N_FEATURES];
+    uint64_t Xp[CODEGEN_MODEL_N_WORDS];
+    for (int round = 0; round < 2000; ++round) {
+        int y = round % CODEGEN_MODEL_N_CLASSES;
+        for (int k = 0; k < CODEGEN_MODEL_N_FEATURES; ++k) X[k] = (round & 1) ? rand() % 2 : ((k / 10 == y) || rand() % 4 == 0);
+        bitpack_pack(X, CODEGEN_MODEL_N_FEATURES, Xp);
+
+        int expected_votes[CODEGEN_MODEL_N_CLASSES], votes[CODEGEN_MODEL_N_CLASSES];
+        int expected = tsetlin_predict(ts, X, expected_votes);
+        TEST_ASSERT_EQUAL_INT(expected, codegen_model_predict(X, votes));
+        TEST_ASSERT_EQUAL_INT_ARRAY(expected_votes, votes, CODEGEN_MODEL_N_CLASSES);
+        TEST_ASSERT_EQUAL_INT(expected, codegen_model_predict_packed(Xp, NULL));
+    }
+}
+
+/* not needed when using generate_test_runner.rb */
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_codegen_dimensions);
+    RUN_TEST(test_codegen_matches_model);
+
+    return UNITY_END();
+}
@@ -0,0 +1,109 @@
+/* =========================================================================
+    Unity - A Test Framework for C
+    ThrowTheSwitch.org
+    Copyright (c) 2007-25 Mike Karlesky, Mark VanderVoord, & Greg Williams
+    SPDX-License-Identifier: MIT
+========================================================================= */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <unity.h>
+#include <log.h>
+
+#include <compact.h>
+#include <tsetlin.h>
+
+#define N_FEATURE 150
+#define N_CLASS 4
+#define N_CLAUSE 20
+#define N_SAMPLE 200
+#define COMPACT_PATH "unit_test_compact_model.bin"
+
+static tsetlin_t* ts;
+static int* rows[N_SAMPLE];
+
+void setUp(void) {
+    ts = tsetlin_new(N_FEATURE, N_CLASS, N_CLAUSE, 10);
+    for (int i = 0; i < N_SAMPLE; ++i) {
+        rows[i] = (int*)malloc(sizeof(int) * N_FEATURE);
+        for (int k = 0; k < N_FEATURE; ++k) rows[i][k] = rand() % 2;
+    }
+    for (int epoch = 0; epoch < 3; ++epoch) {
+        for (int i = 0; i < N_SAMPLE; ++i) tsetlin_step(ts, rows[i], (rows[i][0] << 1) | rows[i][1], 10, 3.0, NULL, -1);
+    }
+
+    /* One always-firing and one contradictory clause in class 0. */
+    clause_t* empty = tsetlin_get_clause(ts, 0, 0);
+    clause_t* never = tsetlin_get_clause(ts, 0, N_CLAUSE - 1);
+    for (int k = 0; k < 2 * N_FEATURE; ++k) {
+        clause_set_automaton(empty, k, 5);
+        clause_set_automaton(never, k, 5);
+    }
+    clause_set_automaton(never, 3, 6);
+    clause_set_automaton(never, N_FEATURE + 3, 6);
+    clause_compress(empty, -1);
+    clause_compress(never, -1);
+}
+
+void tearDown(void) {
+    for (int i = 0; i < N_SAMPLE; ++i) free(rows[i]);
+    tsetlin_free(ts);
+}
+
+static void assert_same_predictions(const tsetlin_compact_t* cm) {
+    uint64_t X[BITPACK_WORDS(N_FEATURE)];
+    for (int i = 0; i < N_SAMPLE; ++i) {
+        int expected_votes[N_CLASS], votes[N_CLASS], packed_votes[N_CLASS];
+        int expected = tsetlin_predict(ts, rows[i], expected_votes);
+        TEST_ASSERT_EQUAL_INT(expected, tsetlin_compact_predict(cm, rows[i], votes));
+        TEST_ASSERT_EQUAL_INT_ARRAY(expected_votes, votes, N_CLASS);
+
+        bitpack_pack(rows[i], N_FEATURE, X);
+        TEST_ASSERT_EQUAL_INT(expected, tsetlin_compact_predict_packed(cm, X, packed_votes));
+        TEST_ASSERT_EQUAL_INT_ARRAY(expected_votes, packed_votes, N_CLASS);
+    }
+}
+
+static void test_compact_matches_model(void) {
+    tsetlin_compact_t* cm = tsetlin_compact_new(ts);
+    TEST_ASSERT_NOT_NULL(cm);
+
+    /* the empty clause became bias, the contradictory one was dropped */
+    TEST_ASSERT_TRUE(cm->n_kept <= N_CLASS * N_CLAUSE - 2);
+    TEST_ASSERT_TRUE(cm->bias[0] >= 1);
+    TEST_ASSERT_TRUE(tsetlin_compact_size(cm) < tsetlin_arena_size(N_FEATURE, N_CLASS, N_CLAUSE) / 10);
+
+    assert_same_predictions(cm);
+    tsetlin_compact_free(cm);
+}
+
+static void test_compact_save_load(void) {
+    tsetlin_compact_t* cm = tsetlin_compact_new(ts);
+    TEST_ASSERT_NOT_NULL(cm);
+    TEST_ASSERT_EQUAL_INT(0, tsetlin_compact_save(cm, COMPACT_PATH));
+
+    tsetlin_compact_t* loaded = tsetlin_compact_load(COMPACT_PATH);
+    TEST_ASSERT_NOT_NULL(loaded);
+    TEST_ASSERT_EQUAL_INT(cm->n_kept, loaded->n_kept);
+    TEST_ASSERT_EQUAL_INT(cm->n_entries, loaded->n_entries);
+    assert_same_predictions(loaded);
+
+    /* a model file is not a compact file */
+    TEST_ASSERT_EQUAL_INT(0, tsetlin_save(ts, COMPACT_PATH));
+    TEST_ASSERT_NULL(tsetlin_compact_load(COMPACT_PATH));
+
+    remove(COMPACT_PATH);
+    tsetlin_compact_free(loaded);
+    tsetlin_compact_free(cm);
+}
+
+/* not needed when using generate_test_runner.rb */
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_compact_matches_model);
+    RUN_TEST(test_compact_save_load);
+
+    return UNITY_END();
+}
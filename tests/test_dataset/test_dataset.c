@@ -0,0 +1,158 @@
+/* =========================================================================
+    Unity - A Test Framework for C
+    ThrowTheSwitch.org
+    Copyright (c) 2007-25 Mike Karlesky, Mark VanderVoord, & Greg Williams
+    SPDX-License-Identifier: MIT
+========================================================================= */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <unity.h>
+#include <log.h>
+
+#include <dataset.h>
+
+#define N_IMAGES 1500 /* over one binarization chunk */
+#define ROWS 28
+#define COLS 28
+#define IMAGES_PATH "unit_test_dataset_images.idx"
+#define LABELS_PATH "unit_test_dataset_labels.idx"
+#define CACHE_PATH "unit_test_dataset_cache.tsd"
+
+static unsigned char* pixels;
+static unsigned char labels[N_IMAGES];
+
+static void put_be32(FILE* f, unsigned v) {
+    unsigned char b[4] = { (unsigned char)(v >> 24), (unsigned char)(v >> 16), (unsigned char)(v >> 8), (unsigned char)v };
+    fwrite(b, 1, 4, f);
+}
+
+/* Write an IDX image file of n images (magic and count as given) and a label file of n_labels. */
+static void write_files(unsigned magic, int n, int n_labels) {
+    FILE* f = fopen(IMAGES_PATH, "wb");
+    put_be32(f, magic);
+    put_be32(f, N_IMAGES);
+    put_be32(f, ROWS);
+    put_be32(f, COLS);
+    fwrite(pixels, 1, (size_t)n * ROWS * COLS, f);
+    fclose(f);
+
+    f = fopen(LABELS_PATH, "wb");
+    put_be32(f, 0x801);
+    put_be32(f, n_labels);
+    fwrite(labels, 1, (size_t)n_labels, f);
+    fclose(f);
+}
+
+void setUp(void) {
+    pixels = (unsigned char*)malloc((size_t)N_IMAGES * ROWS * COLS);
+    for (size_t k = 0; k < (size_t)N_IMAGES * ROWS * COLS; ++k) pixels[k] = (unsigned char)(rand() & 0xFF);
+    for (int i = 0; i < N_IMAGES; ++i) labels[i] = (unsigned char)(i % 10);
+}
+
+void tearDown(void) {
+    free(pixels);
+    remove(IMAGES_PATH);
+    remove(LABELS_PATH);
+    remove(CACHE_PATH);
+}
+
+static void test_load_idx_binarizes_packed(void) {
+    write_files(0x803, N_IMAGES, N_IMAGES);
+    dataset_t* ds = dataset_load_idx(IMAGES_PATH, LABELS_PATH, 75);
+    TEST_ASSERT_NOT_NULL(ds);
+    TEST_ASSERT_EQUAL_INT(N_IMAGES, ds->n_samples);
+    TEST_ASSERT_EQUAL_INT(ROWS * COLS, ds->n_features);
+    TEST_ASSERT_EQUAL_INT(BITPACK_WORDS(ROWS * COLS), ds->n_words);
+    TEST_ASSERT_EQUAL_INT(ROWS, ds->rows);
+    TEST_ASSERT_EQUAL_INT(COLS, ds->cols);
+
+    int X[ROWS * COLS];
+    uint64_t expected[BITPACK_WORDS(ROWS * COLS)];
+    for (int i = 0; i < N_IMAGES; ++i) {
+        for (int k = 0; k < ROWS * COLS; ++k) X[k] = pixels[(size_t)i * ROWS * COLS + k] > 75;
+        bitpack_pack(X, ROWS * COLS, expected);
+        TEST_ASSERT_EQUAL_MEMORY(expected, dataset_row(ds, i), sizeof(expected));
+        TEST_ASSERT_EQUAL_INT(labels[i], ds->y[i]);
+    }
+
+    /* 1 bit per pixel instead of one int */
+    TEST_ASSERT_TRUE(dataset_size(ds) * 25 < sizeof(int) * (size_t)N_IMAGES * ROWS * COLS);
+    dataset_free(ds);
+
+    /* without labels */
+    ds = dataset_load_idx(IMAGES_PATH, NULL, 200);
+    TEST_ASSERT_NOT_NULL(ds);
+    TEST_ASSERT_NULL(ds->y);
+    TEST_ASSERT_EQUAL_INT(bitpack_get(dataset_row(ds, 7), 5), pixels[7 * ROWS * COLS + 5] > 200);
+    dataset_free(ds);
+}
+
+static void test_load_idx_rejects_malformed(void) {
+    write_files(0x801, N_IMAGES, N_IMAGES); /* wrong magic */
+    TEST_ASSERT_NULL(dataset_load_idx(IMAGES_PATH, LABELS_PATH, 75));
+
+    write_files(0x803, N_IMAGES - 1, N_IMAGES); /* truncated images */
+    TEST_ASSERT_NULL(dataset_load_idx(IMAGES_PATH, LABELS_PATH, 75));
+
+    write_files(0x803, N_IMAGES, N_IMAGES - 1); /* label count differs */
+    TEST_ASSERT_NULL(dataset_load_idx(IMAGES_PATH, LABELS_PATH, 75));
+
+    TEST_ASSERT_NULL(dataset_load_idx("unit_test_dataset_missing.idx", NULL, 75));
+}
+
+static void test_cache_roundtrip_and_validation(void) {
+    write_files(0x803, N_IMAGES, N_IMAGES);
+    dataset_t* ds = dataset_load_idx(IMAGES_PATH, LABELS_PATH, 75);
+    TEST_ASSERT_NOT_NULL(ds);
+
+    int32_t threshold = 75;
+    uint64_t key = dataset_hash(&threshold, sizeof(threshold), dataset_hash_file(IMAGES_PATH, DATASET_HASH_INIT));
+    TEST_ASSERT_TRUE(key != dataset_hash_file("unit_test_dataset_missing.idx", DATASET_HASH_INIT));
+    TEST_ASSERT_NULL(dataset_cache_open(CACHE_PATH, key, 10)); /* not written yet */
+    TEST_ASSERT_EQUAL_INT(0, dataset_cache_save(ds, CACHE_PATH, key, &threshold, sizeof(threshold)));
+
+    /* two concurrent readers map the same pages */
+    dataset_t* a = dataset_cache_open(CACHE_PATH, key, 10);
+    dataset_t* b = dataset_cache_open(CACHE_PATH, key, 10);
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_NOT_NULL(a->mapping);
+    TEST_ASSERT_EQUAL_INT(ds->n_samples, a->n_samples);
+    TEST_ASSERT_EQUAL_INT(ds->n_features, a->n_features);
+    TEST_ASSERT_EQUAL_INT(ROWS, a->rows);
+    TEST_ASSERT_EQUAL_INT(COLS, a->cols);
+    TEST_ASSERT_EQUAL_MEMORY(ds->X, a->X, sizeof(uint64_t) * (size_t)ds->n_samples * ds->n_words);
+    TEST_ASSERT_EQUAL_INT_ARRAY(ds->y, b->y, ds->n_samples);
+    TEST_ASSERT_EQUAL_INT(sizeof(threshold), (int)a->params_size);
+    TEST_ASSERT_EQUAL_INT(75, *(const int32_t*)a->params);
+    dataset_free(a);
+    dataset_free(b);
+
+    /* another key (other source or parameters) is a miss */
+    TEST_ASSERT_NULL(dataset_cache_open(CACHE_PATH, key + 1, 10));
+
+    /* labels 0 .. 9 do not fit a 9-class model */
+    TEST_ASSERT_NULL(dataset_cache_open(CACHE_PATH, key, 9));
+
+    /* a corrupted header fails its hash */
+    FILE* f = fopen(CACHE_PATH, "r+b");
+    fseek(f, 20, SEEK_SET);
+    fputc(0x7F, f);
+    fclose(f);
+    TEST_ASSERT_NULL(dataset_cache_open(CACHE_PATH, key, 10));
+
+    dataset_free(ds);
+}
+
+/* not needed when using generate_test_runner.rb */
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_load_idx_binarizes_packed);
+    RUN_TEST(test_load_idx_rejects_malformed);
+    RUN_TEST(test_cache_roundtrip_and_validation);
+
+    return UNITY_END();
+}
@@ -0,0 +1,105 @@
+/* =========================================================================
+    Unity - A Test Framework for C
+    ThrowTheSwitch.org
+    Copyright (c) 2007-25 Mike Karlesky, Mark VanderVoord, & Greg Williams
+    SPDX-License-Identifier: MIT
+========================================================================= */
+
+#include <stdlib.h>
+
+#include <unity.h>
+#include <log.h>
+
+#include <inverted.h>
+#include <tsetlin.h>
+
+#define N_FEATURE 150
+#define N_CLASS 4
+#define N_CLAUSE 140 /* 70 clauses per half: two words, the second one partial */
+#define N_SAMPLE 200
+
+static tsetlin_t* ts;
+static int* rows[N_SAMPLE];
+
+void setUp(void) {
+    ts = tsetlin_new(N_FEATURE, N_CLASS, N_CLAUSE, 10);
+    for (int i = 0; i < N_SAMPLE; ++i) {
+        rows[i] = (int*)malloc(sizeof(int) * N_FEATURE);
+        for (int k = 0; k < N_FEATURE; ++k) rows[i][k] = rand() % 2;
+    }
+    for (int epoch = 0; epoch < 3; ++epoch) {
+        for (int i = 0; i < N_SAMPLE; ++i) tsetlin_step(ts, rows[i], (rows[i][0] << 1) | rows[i][1], 10, 3.0, NULL, -1);
+    }
+
+    /* One always-firing and one contradictory clause, in the last word of a half. */
+    clause_t* empty = tsetlin_get_clause(ts, 1, N_CLAUSE / 2 - 1);
+    clause_t* never = tsetlin_get_clause(ts, 2, N_CLAUSE - 1);
+    for (int k = 0; k < 2 * N_FEATURE; ++k) {
+        clause_set_automaton(empty, k, 5);
+        clause_set_automaton(never, k, 5);
+    }
+    clause_set_automaton(never, 3, 6);
+    clause_set_automaton(never, N_FEATURE + 3, 6);
+    clause_compress(empty, -1);
+    clause_compress(never, -1);
+}
+
+void tearDown(void) {
+    for (int i = 0; i < N_SAMPLE; ++i) free(rows[i]);
+    tsetlin_free(ts);
+}
+
+static void test_inverted_matches_model(void) {
+    tsetlin_inverted_t* ix = tsetlin_inverted_new(ts);
+    TEST_ASSERT_NOT_NULL(ix);
+    TEST_ASSERT_TRUE(ix->n_literals <= 2 * N_FEATURE);
+    TEST_ASSERT_EQUAL_INT(2, ix->half_words);
+
+    uint64_t X[BITPACK_WORDS(N_FEATURE)];
+    for (int i = 0; i < N_SAMPLE; ++i) {
+        int expected_votes[N_CLASS], votes[N_CLASS], packed_votes[N_CLASS];
+        int expected = tsetlin_predict(ts, rows[i], expected_votes);
+        TEST_ASSERT_EQUAL_INT(expected, tsetlin_inverted_predict(ix, rows[i], votes));
+        TEST_ASSERT_EQUAL_INT_ARRAY(expected_votes, votes, N_CLASS);
+
+        bitpack_pack(rows[i], N_FEATURE, X);
+        TEST_ASSERT_EQUAL_INT(expected, tsetlin_inverted_predict_packed(ix, X, packed_votes));
+        TEST_ASSERT_EQUAL_INT_ARRAY(expected_votes, packed_votes, N_CLASS);
+    }
+
+    tsetlin_inverted_free(ix);
+}
+
+static void test_inverted_parallel_matches_batch(void) {
+    tsetlin_inverted_t* ix = tsetlin_inverted_new(ts);
+    threadpool_t* pool = threadpool_new(3);
+    TEST_ASSERT_NOT_NULL(ix);
+    TEST_ASSERT_NOT_NULL(pool);
+
+    int expected[N_SAMPLE], preds[N_SAMPLE];
+    int* expected_votes = (int*)malloc(sizeof(int) * N_SAMPLE * N_CLASS);
+    int* votes = (int*)malloc(sizeof(int) * N_SAMPLE * N_CLASS);
+    TEST_ASSERT_EQUAL_INT(0, tsetlin_predict_batch(ts, (const int**)rows, N_SAMPLE, expected, expected_votes));
+
+    TEST_ASSERT_EQUAL_INT(0, tsetlin_inverted_predict_parallel(ix, pool, (const int**)rows, N_SAMPLE, preds, votes));
+    TEST_ASSERT_EQUAL_INT_ARRAY(expected, preds, N_SAMPLE);
+    TEST_ASSERT_EQUAL_INT_ARRAY(expected_votes, votes, N_SAMPLE * N_CLASS);
+
+    TEST_ASSERT_EQUAL_INT(0, tsetlin_inverted_predict_parallel(ix, NULL, (const int**)rows, N_SAMPLE, preds, NULL));
+    TEST_ASSERT_EQUAL_INT_ARRAY(expected, preds, N_SAMPLE);
+
+    free(expected_votes);
+    free(votes);
+    threadpool_free(pool);
+    tsetlin_inverted_free(ix);
+}
+
+/* not needed when using generate_test_runner.rb */
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_inverted_matches_model);
+    RUN_TEST(test_inverted_parallel_matches_batch);
+
+    return UNITY_END();
+}
@@ -0,0 +1,127 @@
+/* =========================================================================
+    Unity - A Test Framework for C
+    ThrowTheSwitch.org
+    Copyright (c) 2007-25 Mike Karlesky, Mark VanderVoord, & Greg Williams
+    SPDX-License-Identifier: MIT
+========================================================================= */
+
+#include <stdlib.h>
+
+#include <unity.h>
+#include <log.h>
+
+#include <bitpack.h>
+#include <kernel.h>
+#include <tsetlin.h>
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+    kernel_select(KERNEL_SCALAR);
+}
+
+static uint64_t random_word(void) {
+    uint64_t w = 0;
+    for (int i = 0; i < 4; ++i) w = (w << 16) ^ (uint64_t)(rand() & 0xFFFF);
+    return w;
+}
+
+/* Sparse word: each bit set with probability 1/32. */
+static uint64_t sparse_word(void) {
+    return random_word() & random_word() & random_word() & random_word() & random_word();
+}
+
+static void test_kernel_scalar_always_supported(void) {
+    TEST_ASSERT_TRUE(kernel_supported(KERNEL_SCALAR));
+    TEST_ASSERT_TRUE(kernel_select(KERNEL_SCALAR));
+    TEST_ASSERT_EQUAL_INT(KERNEL_SCALAR, kernel_active());
+    TEST_ASSERT_FALSE(kernel_select(KERNEL_COUNT));
+}
+
+static void test_kernel_evaluate_matches_scalar(void) {
+    enum { MAX_WORDS = 40 };
+    uint64_t p[MAX_WORDS], n[MAX_WORDS], x[MAX_WORDS];
+
+    for (int id = 0; id < KERNEL_COUNT; ++id) {
+        if (!kernel_supported((kernel_id_t)id)) continue;
+        TEST_ASSERT_TRUE(kernel_select((kernel_id_t)id));
+
+        for (int n_words = 1; n_words <= MAX_WORDS; ++n_words) {
+            for (int round = 0; round < 200; ++round) {
+                for (int w = 0; w < n_words; ++w) {
+                    x[w] = random_word();
+                    /* Derive masks from x so that both outcomes occur. */
+                    p[w] = x[w] & sparse_word();
+                    n[w] = ~x[w] & sparse_word();
+                    if (round % 2) {
+                        int bit = rand() % 64;
+                        if (rand() % 2) p[w] |= ~x[w] & ((uint64_t)1 << bit);
+                        else n[w] |= x[w] & ((uint64_t)1 << bit);
+                    }
+                }
+                int expected = kernel_evaluate_scalar(p, n, x, n_words);
+                TEST_ASSERT_EQUAL_INT(expected, kernel_evaluate(p, n, x, n_words));
+            }
+        }
+    }
+}
+
+static void test_kernel_votes_bit_exact(void) {
+    enum { N_FEATURE = 300, N_CLASS = 4, N_CLAUSE = 40, N_SAMPLE = 100 };
+    tsetlin_t* ts = tsetlin_new(N_FEATURE, N_CLASS, N_CLAUSE, 10);
+    TEST_ASSERT_NOT_NULL(ts);
+
+    /* Short random clauses so that votes are non-trivial. */
+    for (int c = 0; c < N_CLASS; ++c) {
+        for (int j = 0; j < N_CLAUSE; ++j) {
+            clause_t* clause = tsetlin_get_clause(ts, c, j);
+            for (int k = 0; k < clause->N_literals; ++k) {
+                clause_set_automaton(clause, k, (rand() % 200 == 0) ? 6 : 5);
+            }
+            clause_compress(clause, -1);
+        }
+    }
+
+    int n_words = BITPACK_WORDS(N_FEATURE);
+    uint64_t* X = (uint64_t*)malloc(sizeof(uint64_t) * n_words * N_SAMPLE);
+    int X_row[N_FEATURE];
+    for (int i = 0; i < N_SAMPLE; ++i) {
+        for (int k = 0; k < N_FEATURE; ++k) X_row[k] = rand() % 2;
+        bitpack_pack(X_row, N_FEATURE, X + (size_t)i * n_words);
+    }
+
+    int expected[N_SAMPLE][N_CLASS];
+    int expected_pred[N_SAMPLE];
+    kernel_select(KERNEL_SCALAR);
+    for (int i = 0; i < N_SAMPLE; ++i) {
+        expected_pred[i] = tsetlin_predict_packed(ts, X + (size_t)i * n_words, expected[i]);
+    }
+
+    for (int id = 0; id < KERNEL_COUNT; ++id) {
+        if (!kernel_select((kernel_id_t)id)) {
+            log_info("Kernel %s not supported on this CPU, skipped", kernel_name((kernel_id_t)id));
+            continue;
+        }
+        for (int i = 0; i < N_SAMPLE; ++i) {
+            int votes[N_CLASS];
+            int pred = tsetlin_predict_packed(ts, X + (size_t)i * n_words, votes);
+            TEST_ASSERT_EQUAL_INT(expected_pred[i], pred);
+            TEST_ASSERT_EQUAL_INT_ARRAY(expected[i], votes, N_CLASS);
+        }
+    }
+
+    free(X);
+    tsetlin_free(ts);
+}
+
+/* not needed when using generate_test_runner.rb */
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_kernel_scalar_always_supported);
+    RUN_TEST(test_kernel_evaluate_matches_scalar);
+    RUN_TEST(test_kernel_votes_bit_exact);
+
+    return UNITY_END();
+}
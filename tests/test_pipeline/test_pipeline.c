@@ -0,0 +1,173 @@
+/* =========================================================================
+    Unity - A Test Framework for C
+    ThrowTheSwitch.org
+    Copyright (c) 2007-25 Mike Karlesky, Mark VanderVoord, & Greg Williams
+    SPDX-License-Identifier: MIT
+========================================================================= */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <unity.h>
+#include <log.h>
+
+#include <pipeline.h>
+
+#define N_SAMPLES 1000
+#define N_FEATURES 70 /* two words per row */
+#define CHUNK 64      /* the last chunk is partial */
+#define EPOCHS 3
+#define CACHE_PATH "unit_test_pipeline_cache.tsd"
+
+/* Sample i: label i, row holding i in word 0 and ~i in word 1, so rows and labels can be matched. */
+static void make_row(int i, uint64_t* row) {
+    row[0] = (uint64_t)i;
+    row[1] = ~(uint64_t)i & 0x3F;
+}
+
+typedef struct {
+    int fail_from; /* first sample index whose read fails, or N_SAMPLES */
+} source_t;
+
+static int read_source(void* ctx, int first, int count, uint64_t* X, int* y) {
+    const source_t* src = (const source_t*)ctx;
+    if (first + count > src->fail_from) return -1;
+    for (int k = 0; k < count; ++k) {
+        make_row(first + k, X + (size_t)k * 2);
+        y[k] = first + k;
+    }
+    return 0;
+}
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+    remove(CACHE_PATH);
+}
+
+/* Run EPOCHS epochs, checking rows against labels and that every chunk stays in one window of
+ * CHUNK consecutive samples; order receives the labels in stream order. */
+static void run_epochs(pipeline_t* p, int* order) {
+    for (int epoch = 0; epoch < EPOCHS; ++epoch) {
+        int seen = 0;
+        const uint64_t* X;
+        const int* y;
+        int count;
+        while ((count = pipeline_next(p, &X, &y)) > 0) {
+            int window = y[0] / CHUNK;
+            for (int k = 0; k < count; ++k) {
+                uint64_t row[2];
+                make_row(y[k], row);
+                TEST_ASSERT_EQUAL_MEMORY(row, X + (size_t)k * 2, sizeof(row));
+                TEST_ASSERT_EQUAL_INT(window, y[k] / CHUNK);
+                TEST_ASSERT_TRUE(seen + k < N_SAMPLES);
+                order[epoch * N_SAMPLES + seen + k] = y[k];
+            }
+            seen += count;
+        }
+        TEST_ASSERT_EQUAL_INT(0, count);
+        TEST_ASSERT_EQUAL_INT(N_SAMPLES, seen);
+    }
+}
+
+void test_epochs_cover_every_sample_once(void) {
+    source_t src = { N_SAMPLES };
+    pipeline_t* p = pipeline_new(N_SAMPLES, N_FEATURES, CHUNK, read_source, &src, 42);
+    TEST_ASSERT_NOT_NULL(p);
+
+    int* order = (int*)malloc(sizeof(int) * EPOCHS * N_SAMPLES);
+    run_epochs(p, order);
+
+    for (int epoch = 0; epoch < EPOCHS; ++epoch) {
+        int count[N_SAMPLES] = { 0 };
+        for (int k = 0; k < N_SAMPLES; ++k) count[order[epoch * N_SAMPLES + k]]++;
+        for (int i = 0; i < N_SAMPLES; ++i) TEST_ASSERT_EQUAL_INT(1, count[i]);
+    }
+
+    /* shuffled, and differently every epoch */
+    int in_place = 0, same = 0;
+    for (int k = 0; k < N_SAMPLES; ++k) {
+        in_place += order[k] == k;
+        same += order[k] == order[N_SAMPLES + k];
+    }
+    TEST_ASSERT_TRUE(in_place < N_SAMPLES / 10);
+    TEST_ASSERT_TRUE(same < N_SAMPLES / 10);
+
+    /* the order depends on the seed only */
+    pipeline_t* q = pipeline_new(N_SAMPLES, N_FEATURES, CHUNK, read_source, &src, 42);
+    int* again = (int*)malloc(sizeof(int) * EPOCHS * N_SAMPLES);
+    run_epochs(q, again);
+    TEST_ASSERT_EQUAL_INT_ARRAY(order, again, EPOCHS * N_SAMPLES);
+    TEST_ASSERT_TRUE(pipeline_stall_seconds(q) >= 0.0);
+
+    free(again);
+    free(order);
+    pipeline_free(q);
+    pipeline_free(p);
+}
+
+void test_source_failure_is_reported(void) {
+    source_t src = { N_SAMPLES / 2 };
+    pipeline_t* p = pipeline_new(N_SAMPLES, N_FEATURES, CHUNK, read_source, &src, 1);
+    TEST_ASSERT_NOT_NULL(p);
+
+    const uint64_t* X;
+    const int* y;
+    int count;
+    while ((count = pipeline_next(p, &X, &y)) > 0) {
+    }
+    TEST_ASSERT_EQUAL_INT(-1, count);
+    TEST_ASSERT_NULL(X);
+    TEST_ASSERT_EQUAL_INT(-1, pipeline_next(p, &X, &y));
+    pipeline_free(p);
+
+    /* freed while the thread waits for a slot */
+    src.fail_from = N_SAMPLES;
+    p = pipeline_new(N_SAMPLES, N_FEATURES, CHUNK, read_source, &src, 1);
+    TEST_ASSERT_TRUE(pipeline_next(p, &X, &y) > 0);
+    pipeline_free(p);
+}
+
+void test_mapped_cache_source(void) {
+    dataset_t* ds = dataset_new(N_SAMPLES, N_FEATURES, 1);
+    TEST_ASSERT_NOT_NULL(ds);
+    for (int i = 0; i < N_SAMPLES; ++i) {
+        make_row(i, ds->X + (size_t)i * ds->n_words);
+        ds->y[i] = i;
+    }
+    TEST_ASSERT_EQUAL_INT(0, dataset_cache_save(ds, CACHE_PATH, 7, NULL, 0));
+    dataset_t* mapped = dataset_cache_open(CACHE_PATH, 7, N_SAMPLES);
+    TEST_ASSERT_NOT_NULL(mapped);
+
+    pipeline_t* p = pipeline_new_dataset(mapped, CHUNK, 3);
+    TEST_ASSERT_NOT_NULL(p);
+    int* order = (int*)malloc(sizeof(int) * EPOCHS * N_SAMPLES);
+    run_epochs(p, order); /* discarded pages read back from the file */
+    free(order);
+    pipeline_free(p);
+
+    /* a chunk larger than the source is one window */
+    const uint64_t* X;
+    const int* y;
+    p = pipeline_new_dataset(ds, 4 * N_SAMPLES, 3);
+    TEST_ASSERT_EQUAL_INT(N_SAMPLES, pipeline_next(p, &X, &y));
+    TEST_ASSERT_EQUAL_INT(0, pipeline_next(p, &X, &y));
+    TEST_ASSERT_EQUAL_INT(N_SAMPLES, pipeline_next(p, &X, &y));
+    pipeline_free(p);
+
+    dataset_free(mapped);
+    dataset_free(ds);
+}
+
+/* not needed when using generate_test_runner.rb */
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_epochs_cover_every_sample_once);
+    RUN_TEST(test_source_failure_is_reported);
+    RUN_TEST(test_mapped_cache_source);
+
+    return UNITY_END();
+}
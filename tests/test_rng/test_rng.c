@@ -0,0 +1,139 @@
+/* =========================================================================
+    Unity - A Test Framework for C
+    ThrowTheSwitch.org
+    Copyright (c) 2007-25 Mike Karlesky, Mark VanderVoord, & Greg Williams
+    SPDX-License-Identifier: MIT
+========================================================================= */
+
+#include <string.h>
+
+#include <unity.h>
+#include <log.h>
+
+#include <bitpack.h>
+#include <rng.h>
+
+void setUp(void) {
+}
+
+void tearDown(void) {
+}
+
+static void test_rng_seed_reproducible(void) {
+    rng_t a, b;
+    rng_seed(&a, 7);
+    rng_seed(&b, 7);
+    for (int i = 0; i < 1000; ++i) {
+        TEST_ASSERT_TRUE(rng_next(&a) == rng_next(&b));
+    }
+
+    rng_seed(&b, 8);
+    TEST_ASSERT_TRUE(rng_next(&a) != rng_next(&b));
+}
+
+static void test_rng_split_streams_differ(void) {
+    rng_t parent, child, copy;
+    rng_seed(&parent, 0);
+    copy = parent;
+
+    rng_split(&parent, &child);
+    /* the child continues the parent's old stream, the parent moves on */
+    TEST_ASSERT_TRUE(rng_next(&child) == rng_next(&copy));
+    TEST_ASSERT_TRUE(rng_next(&parent) != rng_next(&child));
+}
+
+static void test_rng_bernoulli_rate(void) {
+    enum { N = 200000 };
+    rng_t rng;
+    rng_seed(&rng, 1);
+
+    TEST_ASSERT_TRUE(rng_threshold(0.0) == 0);
+    TEST_ASSERT_TRUE(rng_threshold(1.0) == RNG_ONE);
+    TEST_ASSERT_TRUE(rng_threshold(-1.0) == 0);
+    TEST_ASSERT_TRUE(rng_threshold(2.0) == RNG_ONE);
+
+    double ps[] = { 0.0, 0.01, 1.0 / 3.0, 0.9, 1.0 };
+    for (int k = 0; k < 5; ++k) {
+        uint64_t t = rng_threshold(ps[k]);
+        int hits = 0;
+        for (int i = 0; i < N; ++i) hits += rng_bernoulli(&rng, t);
+        /* well within 5 standard deviations for every p */
+        TEST_ASSERT_DOUBLE_WITHIN(0.006, ps[k], (double)hits / N);
+    }
+}
+
+static void test_rng_below_range(void) {
+    rng_t rng;
+    rng_seed(&rng, 3);
+    int counts[5] = { 0, 0, 0, 0, 0 };
+    for (int i = 0; i < 50000; ++i) {
+        int v = rng_below(&rng, 5);
+        TEST_ASSERT_TRUE(v >= 0 && v < 5);
+        counts[v]++;
+    }
+    for (int v = 0; v < 5; ++v) TEST_ASSERT_INT_WITHIN(500, 10000, counts[v]);
+}
+
+/* Random words rng_mask took: steps of a copy of the stream until it catches up. */
+static int mask_words(rng_t* rng, uint64_t threshold, int precision) {
+    rng_t before = *rng;
+    rng_mask(rng, threshold, precision);
+    int words = 0;
+    while (memcmp(before.s, rng->s, sizeof(before.s)) != 0 && words <= 32) {
+        rng_next(&before);
+        ++words;
+    }
+    return words;
+}
+
+static void test_rng_mask_rate(void) {
+    enum { N = 20000 };
+    rng_t rng;
+    rng_seed(&rng, 5);
+
+    TEST_ASSERT_TRUE(rng_mask(&rng, 0, RNG_MASK_PRECISION) == 0);
+    TEST_ASSERT_TRUE(rng_mask(&rng, RNG_ONE, RNG_MASK_PRECISION) == ~(uint64_t)0);
+
+    double ps[] = { 0.01, 0.2, 1.0 / 3.0, 0.5, 0.9 };
+    int precisions[] = { RNG_MASK_PRECISION, 8, 3 };
+    for (int k = 0; k < 5; ++k) {
+        for (int j = 0; j < 3; ++j) {
+            int precision = precisions[j];
+            uint64_t t = rng_threshold(ps[k]);
+            double expected = (double)(t >> (32 - precision)) / (double)((uint64_t)1 << precision);
+
+            int per_bit[64] = { 0 };
+            long hits = 0, pairs = 0, words = 0;
+            for (int i = 0; i < N; ++i) {
+                rng_t probe = rng;
+                words += mask_words(&probe, t, precision);
+                uint64_t m = rng_mask(&rng, t, precision);
+                for (int b = 0; b < 64; ++b) per_bit[b] += (int)((m >> b) & 1);
+                hits += bitpack_popcount(m);
+                pairs += bitpack_popcount(m & (m >> 1)); /* neighbouring bits both set */
+            }
+
+            /* every bit position at the truncated rate, neighbours independent */
+            TEST_ASSERT_DOUBLE_WITHIN(0.002, expected, (double)hits / (64.0 * N));
+            TEST_ASSERT_DOUBLE_WITHIN(0.003, expected * expected, (double)pairs / (63.0 * N));
+            for (int b = 0; b < 64; ++b) TEST_ASSERT_DOUBLE_WITHIN(0.02, expected, (double)per_bit[b] / N);
+
+            /* a handful of words per mask, never more than precision */
+            TEST_ASSERT_TRUE((double)words / N < 10.0);
+            TEST_ASSERT_TRUE(words <= (long)precision * N);
+        }
+    }
+}
+
+/* not needed when using generate_test_runner.rb */
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_rng_seed_reproducible);
+    RUN_TEST(test_rng_split_streams_differ);
+    RUN_TEST(test_rng_bernoulli_rate);
+    RUN_TEST(test_rng_below_range);
+    RUN_TEST(test_rng_mask_rate);
+
+    return UNITY_END();
+}
@@ -0,0 +1,138 @@
+/* =========================================================================
+    Unity - A Test Framework for C
+    ThrowTheSwitch.org
+    Copyright (c) 2007-25 Mike Karlesky, Mark VanderVoord, & Greg Williams
+    SPDX-License-Identifier: MIT
+========================================================================= */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <unity.h>
+#include <log.h>
+
+#include <sparse.h>
+#include <tsetlin.h>
+
+#define N_FEATURE 3000
+#define N_CLASS 3
+#define N_CLAUSE 20
+#define N_SAMPLE 150
+#define MAX_ACTIVE 24
+#define MODEL_PATH "unit_test_sparse_model.bin"
+
+static int* rows[N_SAMPLE];                 /* dense */
+static int actives[N_SAMPLE][MAX_ACTIVE];
+static sparse_sample_t samples[N_SAMPLE];   /* the same rows, sparse */
+static int labels[N_SAMPLE];
+
+void setUp(void) {
+    srand(7);
+    for (int i = 0; i < N_SAMPLE; ++i) {
+        labels[i] = i % N_CLASS;
+        rows[i] = (int*)calloc(N_FEATURE, sizeof(int));
+        rows[i][labels[i]] = 1; /* a class-revealing feature, plus noise */
+        for (int k = 0; k < MAX_ACTIVE - 1; ++k) rows[i][rand() % N_FEATURE] = 1;
+        samples[i].active = actives[i];
+        samples[i].n_active = sparse_from_dense(rows[i], N_FEATURE, actives[i]);
+    }
+}
+
+void tearDown(void) {
+    for (int i = 0; i < N_SAMPLE; ++i) free(rows[i]);
+}
+
+static void test_sparse_hash_sorted_distinct(void) {
+    uint64_t keys[8] = { 42, 7, 1ull << 40, 42, 123456789, 7, 0, 99 };
+    int active[8], again[8];
+    int n = sparse_hash(keys, 8, 1000, active);
+    TEST_ASSERT_EQUAL_INT(6, n); /* 42 and 7 repeat */
+    for (int k = 0; k < n; ++k) {
+        TEST_ASSERT_TRUE(active[k] >= 0 && active[k] < 1000);
+        if (k > 0) TEST_ASSERT_TRUE(active[k] > active[k - 1]);
+    }
+    TEST_ASSERT_EQUAL_INT(n, sparse_hash(keys, 8, 1000, again));
+    TEST_ASSERT_EQUAL_INT_ARRAY(active, again, n);
+
+    /* a fixed function of the key: well spread over the width */
+    int hits[16] = { 0 };
+    int buckets[1];
+    for (uint64_t key = 0; key < 16000; ++key) {
+        sparse_hash(&key, 1, 16, buckets);
+        ++hits[buckets[0]];
+    }
+    for (int b = 0; b < 16; ++b) TEST_ASSERT_INT_WITHIN(150, 1000, hits[b]);
+}
+
+static void test_sparse_scatter_clear(void) {
+    uint64_t words[BITPACK_WORDS(N_FEATURE)] = { 0 }, packed[BITPACK_WORDS(N_FEATURE)];
+    for (int i = 0; i < N_SAMPLE; ++i) {
+        sparse_scatter(&samples[i], words);
+        bitpack_pack(rows[i], N_FEATURE, packed);
+        TEST_ASSERT_EQUAL_MEMORY(packed, words, sizeof(words));
+        sparse_clear(&samples[i], words);
+        for (int w = 0; w < BITPACK_WORDS(N_FEATURE); ++w) TEST_ASSERT_TRUE(words[w] == 0);
+    }
+}
+
+static void assert_sparse_matches_dense(const tsetlin_t* model) {
+    for (int i = 0; i < N_SAMPLE; ++i) {
+        int expected_votes[N_CLASS], votes[N_CLASS];
+        int expected = tsetlin_predict(model, rows[i], expected_votes);
+        TEST_ASSERT_EQUAL_INT(expected, tsetlin_predict_sparse(model, &samples[i], votes));
+        TEST_ASSERT_EQUAL_INT_ARRAY(expected_votes, votes, N_CLASS);
+    }
+}
+
+static void test_sparse_train_and_predict_match_dense(void) {
+    tsetlin_t* dense = tsetlin_new(N_FEATURE, N_CLASS, N_CLAUSE, 10);
+    tsetlin_t* sparse = tsetlin_new(N_FEATURE, N_CLASS, N_CLAUSE, 10);
+    TEST_ASSERT_NOT_NULL(dense);
+    TEST_ASSERT_NOT_NULL(sparse);
+
+    for (int epoch = 0; epoch < 15; ++epoch) {
+        for (int i = 0; i < N_SAMPLE; ++i) {
+            tsetlin_feedback_t a, b;
+            tsetlin_step(dense, rows[i], labels[i], 10, 3.0, &a, -1);
+            tsetlin_step_sparse(sparse, &samples[i], labels[i], 10, 3.0, &b, -1);
+            TEST_ASSERT_EQUAL_MEMORY(&a, &b, sizeof(a));
+        }
+    }
+
+    /* same draws, same model */
+    for (int c = 0; c < N_CLASS; ++c) {
+        for (int j = 0; j < N_CLAUSE; ++j) {
+            for (int k = 0; k < 2 * N_FEATURE; k += 7) {
+                TEST_ASSERT_EQUAL_INT(tsetlin_get_automaton(dense, c, j, k), tsetlin_get_automaton(sparse, c, j, k));
+            }
+        }
+    }
+
+    assert_sparse_matches_dense(sparse);
+    int correct = 0;
+    for (int i = 0; i < N_SAMPLE; ++i) correct += tsetlin_predict_sparse(sparse, &samples[i], NULL) == labels[i];
+    TEST_ASSERT_TRUE(correct > N_SAMPLE * 9 / 10);
+
+    /* mapped models carry no index lists, but evaluate sparse inputs the same */
+    TEST_ASSERT_EQUAL_INT(0, tsetlin_save(sparse, MODEL_PATH));
+    tsetlin_t* mapped = tsetlin_map(MODEL_PATH);
+    TEST_ASSERT_NOT_NULL(mapped);
+    assert_sparse_matches_dense(mapped);
+
+    tsetlin_free(mapped);
+    remove(MODEL_PATH);
+    tsetlin_free(dense);
+    tsetlin_free(sparse);
+}
+
+/* not needed when using generate_test_runner.rb */
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_sparse_hash_sorted_distinct);
+    RUN_TEST(test_sparse_scatter_clear);
+    RUN_TEST(test_sparse_train_and_predict_match_dense);
+
+    return UNITY_END();
+}
@@ -0,0 +1,158 @@
+/* =========================================================================
+    Unity - A Test Framework for C
+    ThrowTheSwitch.org
+    Copyright (c) 2007-25 Mike Karlesky, Mark VanderVoord, & Greg Williams
+    SPDX-License-Identifier: MIT
+========================================================================= */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <unity.h>
+#include <log.h>
+
+#include <stats.h>
+#include <tsetlin.h>
+
+#define N_FEATURE 100
+#define N_CLASS 3
+#define N_CLAUSE 20
+#define N_STATE 100
+#define N_SAMPLE 60
+#define T 10
+#define S 3.0
+
+static uint64_t X[N_SAMPLE * BITPACK_WORDS(N_FEATURE)];
+static int y[N_SAMPLE];
+
+void setUp(void) {
+    rng_t rng;
+    rng_seed(&rng, 3);
+    int n_words = BITPACK_WORDS(N_FEATURE);
+    for (int i = 0; i < N_SAMPLE; ++i) {
+        uint64_t* row = X + (size_t)i * n_words;
+        for (int w = 0; w < n_words; ++w) row[w] = rng_next(&rng);
+        row[n_words - 1] &= ((uint64_t)1 << (N_FEATURE % 64)) - 1;
+        y[i] = i % N_CLASS;
+    }
+}
+
+void tearDown(void) {
+}
+
+void test_fit_reports_feedback_of_steps(void) {
+    int n_words = BITPACK_WORDS(N_FEATURE);
+    tsetlin_t* a = tsetlin_new(N_FEATURE, N_CLASS, N_CLAUSE, N_STATE);
+    tsetlin_t* b = tsetlin_new(N_FEATURE, N_CLASS, N_CLAUSE, N_STATE);
+    tsetlin_seed(a, 5);
+    tsetlin_seed(b, 5);
+
+    int64_t sums[4] = { 0, 0, 0, 0 };
+    for (int i = 0; i < N_SAMPLE; ++i) {
+        tsetlin_feedback_t fb;
+        TEST_ASSERT_EQUAL_INT(0, tsetlin_step_packed(a, X + (size_t)i * n_words, y[i], T, S, &fb, -1));
+        sums[0] += fb.target_type1;
+        sums[1] += fb.target_type2;
+        sums[2] += fb.non_target_type1;
+        sums[3] += fb.non_target_type2;
+    }
+
+    tsetlin_train_stats_t stats;
+    TEST_ASSERT_EQUAL_INT(0, tsetlin_fit_parallel(b, NULL, X, y, N_SAMPLE, T, S, 1, -1, TSETLIN_TRAIN_SERIAL, &stats));
+    TEST_ASSERT_TRUE(sums[0] > 0);
+    TEST_ASSERT_TRUE(stats.target_type1 == sums[0]);
+    TEST_ASSERT_TRUE(stats.target_type2 == sums[1]);
+    TEST_ASSERT_TRUE(stats.non_target_type1 == sums[2]);
+    TEST_ASSERT_TRUE(stats.non_target_type2 == sums[3]);
+
+    /* class-parallel collects them per class */
+    TEST_ASSERT_EQUAL_INT(0, tsetlin_fit_parallel(b, NULL, X, y, N_SAMPLE, T, S, 1, -1, TSETLIN_TRAIN_CLASS_PARALLEL, &stats));
+    TEST_ASSERT_TRUE(stats.target_type1 > 0);
+    TEST_ASSERT_TRUE(stats.non_target_type1 > 0);
+
+    tsetlin_free(a);
+    tsetlin_free(b);
+}
+
+void test_counters_follow_training(void) {
+    tsetlin_t* ts = tsetlin_new(N_FEATURE, N_CLASS, N_CLAUSE, N_STATE);
+    tsetlin_seed(ts, 9);
+
+    tsetlin_stats_reset();
+    tsetlin_train_stats_t train;
+    TEST_ASSERT_EQUAL_INT(0, tsetlin_fit_parallel(ts, NULL, X, y, N_SAMPLE, T, S, 2, -1, TSETLIN_TRAIN_SERIAL, &train));
+
+    tsetlin_stats_t s;
+    tsetlin_stats_snapshot(&s);
+    if (!tsetlin_stats_enabled()) {
+        tsetlin_stats_t zero;
+        memset(&zero, 0, sizeof(zero));
+        TEST_ASSERT_EQUAL_MEMORY(&zero, &s, sizeof(s));
+        tsetlin_free(ts);
+        return;
+    }
+
+    /* every step evaluates all clauses of its target and its non-target class */
+    TEST_ASSERT_TRUE(s.evaluations == (uint64_t)2 * N_SAMPLE * 2 * N_CLAUSE);
+    TEST_ASSERT_TRUE(s.evaluations_false <= s.evaluations);
+    TEST_ASSERT_TRUE(s.evaluation_words >= s.evaluations);
+    TEST_ASSERT_TRUE(s.evaluation_words <= s.evaluations * BITPACK_WORDS(N_FEATURE));
+
+    uint64_t type1 = 0, type2 = 0;
+    for (int c = 0; c < N_CLASS; ++c) {
+        type1 += s.class_type1[c];
+        type2 += s.class_type2[c];
+    }
+    TEST_ASSERT_TRUE(s.type1_events == (uint64_t)(train.target_type1 + train.non_target_type1));
+    TEST_ASSERT_TRUE(s.type2_events == (uint64_t)(train.target_type2 + train.non_target_type2));
+    TEST_ASSERT_TRUE(type1 == s.type1_events);
+    TEST_ASSERT_TRUE(type2 == s.type2_events);
+    TEST_ASSERT_TRUE(s.type1_clauses > 0 && s.type2_clauses > 0);
+    TEST_ASSERT_TRUE(s.include_flips + s.exclude_flips > 0);
+    TEST_ASSERT_TRUE(s.rng_draws > 0);
+    TEST_ASSERT_TRUE(s.phase_seconds[TSETLIN_PHASE_FEEDBACK] > 0.0);
+
+    /* prediction counts its evaluations and time; reset clears everything */
+    tsetlin_stats_reset();
+    tsetlin_predict_packed(ts, X, NULL);
+    tsetlin_stats_snapshot(&s);
+    TEST_ASSERT_TRUE(s.evaluations == (uint64_t)N_CLASS * N_CLAUSE);
+    TEST_ASSERT_TRUE(s.type1_clauses == 0 && s.rng_draws == 0);
+
+    tsetlin_free(ts);
+}
+
+void test_totals_cover_classes_past_breakdown(void) {
+    enum { WIDE = TSETLIN_STATS_MAX_CLASSES + 6 };
+    tsetlin_t* ts = tsetlin_new(N_FEATURE, WIDE, N_CLAUSE, N_STATE);
+    tsetlin_seed(ts, 11);
+
+    /* every step targets the last class, which has no per-class slot */
+    int last[N_SAMPLE];
+    for (int i = 0; i < N_SAMPLE; ++i) last[i] = WIDE - 1;
+    tsetlin_stats_reset();
+    tsetlin_train_stats_t train;
+    TEST_ASSERT_EQUAL_INT(0, tsetlin_fit_parallel(ts, NULL, X, last, N_SAMPLE, T, S, 1, -1, TSETLIN_TRAIN_SERIAL, &train));
+
+    tsetlin_stats_t s;
+    tsetlin_stats_snapshot(&s);
+    if (tsetlin_stats_enabled()) {
+        TEST_ASSERT_TRUE(train.target_type1 > 0);
+        TEST_ASSERT_TRUE(s.type1_events == (uint64_t)(train.target_type1 + train.non_target_type1));
+        TEST_ASSERT_TRUE(s.type2_events == (uint64_t)(train.target_type2 + train.non_target_type2));
+    }
+
+    tsetlin_free(ts);
+}
+
+/* not needed when using generate_test_runner.rb */
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_fit_reports_feedback_of_steps);
+    RUN_TEST(test_counters_follow_training);
+    RUN_TEST(test_totals_cover_classes_past_breakdown);
+
+    return UNITY_END();
+}
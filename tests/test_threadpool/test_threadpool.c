@@ -0,0 +1,80 @@
+/* =========================================================================
+    Unity - A Test Framework for C
+    ThrowTheSwitch.org
+    Copyright (c) 2007-25 Mike Karlesky, Mark VanderVoord, & Greg Williams
+    SPDX-License-Identifier: MIT
+========================================================================= */
+
+#include <string.h>
+
+#include <unity.h>
+#include <log.h>
+
+#include <threadpool.h>
+
+#define N_ITEMS 10007
+
+static int hits[N_ITEMS];
+static int worker_seen[64];
+
+void setUp(void) {
+    memset(hits, 0, sizeof(hits));
+    memset(worker_seen, 0, sizeof(worker_seen));
+}
+
+void tearDown(void) {
+}
+
+/* Items are disjoint across calls, so plain increments are race-free unless an item is run twice. */
+static void mark_items(void* ctx, int begin, int end, int worker) {
+    (void)ctx;
+    for (int i = begin; i < end; ++i) {
+        hits[i]++;
+        /* Uneven cost so that stealing kicks in. */
+        if (i < N_ITEMS / 8) {
+            volatile int spin = 0;
+            for (int k = 0; k < 2000; ++k) spin += k;
+        }
+    }
+    worker_seen[worker] = 1;
+}
+
+static void test_parallel_for_covers_every_item_once(void) {
+    threadpool_t* pool = threadpool_new(4);
+    TEST_ASSERT_NOT_NULL(pool);
+    TEST_ASSERT_EQUAL_INT(4, threadpool_size(pool));
+
+    for (int round = 0; round < 3; ++round) {
+        memset(hits, 0, sizeof(hits));
+        threadpool_parallel_for(pool, N_ITEMS, 16, mark_items, NULL);
+        for (int i = 0; i < N_ITEMS; ++i) TEST_ASSERT_EQUAL_INT(1, hits[i]);
+    }
+    for (int w = 4; w < 64; ++w) TEST_ASSERT_EQUAL_INT(0, worker_seen[w]);
+
+    threadpool_free(pool);
+}
+
+static void test_null_pool_runs_inline(void) {
+    TEST_ASSERT_EQUAL_INT(1, threadpool_size(NULL));
+    threadpool_parallel_for(NULL, N_ITEMS, 16, mark_items, NULL);
+    for (int i = 0; i < N_ITEMS; ++i) TEST_ASSERT_EQUAL_INT(1, hits[i]);
+    TEST_ASSERT_EQUAL_INT(1, worker_seen[0]);
+}
+
+static void test_default_size_uses_cpus(void) {
+    threadpool_t* pool = threadpool_new(0);
+    TEST_ASSERT_NOT_NULL(pool);
+    TEST_ASSERT_TRUE(threadpool_size(pool) >= 1);
+    threadpool_free(pool);
+}
+
+/* not needed when using generate_test_runner.rb */
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_parallel_for_covers_every_item_once);
+    RUN_TEST(test_null_pool_runs_inline);
+    RUN_TEST(test_default_size_uses_cpus);
+
+    return UNITY_END();
+}
@@ -0,0 +1,434 @@
+/* =========================================================================
+    Unity - A Test Framework for C
+    ThrowTheSwitch.org
+    Copyright (c) 2007-25 Mike Karlesky, Mark VanderVoord, & Greg Williams
+    SPDX-License-Identifier: MIT
+========================================================================= */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <unity.h>
+#include <log.h>
+
+#include <tsetlin.h>
+
+#include "../common/separable.h"
+
+#define N_FEATURE 100
+#define N_CLASS 3
+#define N_CLAUSE 20
+#define N_SAMPLE 150 /* not a multiple of the internal block size */
+
+static tsetlin_t* ts;
+static int* rows[N_SAMPLE];
+
+void setUp(void) {
+    ts = tsetlin_new(N_FEATURE, N_CLASS, N_CLAUSE, 10);
+
+    /* Short random clauses so that votes are non-trivial. */
+    for (int c = 0; c < N_CLASS; ++c) {
+        for (int j = 0; j < N_CLAUSE; ++j) {
+            clause_t* clause = tsetlin_get_clause(ts, c, j);
+            for (int k = 0; k < clause->N_literals; ++k) {
+                clause_set_automaton(clause, k, (rand() % 60 == 0) ? 6 : 5);
+            }
+            clause_compress(clause, -1);
+        }
+    }
+
+    for (int i = 0; i < N_SAMPLE; ++i) {
+        rows[i] = (int*)malloc(sizeof(int) * N_FEATURE);
+        for (int k = 0; k < N_FEATURE; ++k) rows[i][k] = rand() % 2;
+    }
+}
+
+void tearDown(void) {
+    for (int i = 0; i < N_SAMPLE; ++i) free(rows[i]);
+    tsetlin_free(ts);
+}
+
+static void test_predict_batch_matches_predict(void) {
+    int preds[N_SAMPLE];
+    int votes[N_SAMPLE * N_CLASS];
+    TEST_ASSERT_EQUAL_INT(0, tsetlin_predict_batch(ts, (const int**)rows, N_SAMPLE, preds, votes));
+
+    for (int i = 0; i < N_SAMPLE; ++i) {
+        int expected_votes[N_CLASS];
+        int expected = tsetlin_predict(ts, rows[i], expected_votes);
+        TEST_ASSERT_EQUAL_INT(expected, preds[i]);
+        TEST_ASSERT_EQUAL_INT_ARRAY(expected_votes, votes + i * N_CLASS, N_CLASS);
+    }
+}
+
+static void test_predict_batch_packed_matches_predict(void) {
+    int n_words = BITPACK_WORDS(N_FEATURE);
+    uint64_t* X = (uint64_t*)malloc(sizeof(uint64_t) * n_words * N_SAMPLE);
+    for (int i = 0; i < N_SAMPLE; ++i) bitpack_pack(rows[i], N_FEATURE, X + (size_t)i * n_words);
+
+    int preds[N_SAMPLE];
+    TEST_ASSERT_EQUAL_INT(0, tsetlin_predict_batch_packed(ts, X, N_SAMPLE, preds, NULL));
+    for (int i = 0; i < N_SAMPLE; ++i) {
+        TEST_ASSERT_EQUAL_INT(tsetlin_predict(ts, rows[i], NULL), preds[i]);
+    }
+
+    free(X);
+}
+
+static void test_predict_parallel_matches_batch(void) {
+    int expected[N_SAMPLE];
+    int expected_votes[N_SAMPLE * N_CLASS];
+    TEST_ASSERT_EQUAL_INT(0, tsetlin_predict_batch(ts, (const int**)rows, N_SAMPLE, expected, expected_votes));
+
+    threadpool_t* pool = threadpool_new(4);
+    TEST_ASSERT_NOT_NULL(pool);
+
+    int preds[N_SAMPLE];
+    int votes[N_SAMPLE * N_CLASS];
+    TEST_ASSERT_EQUAL_INT(0, tsetlin_predict_parallel(ts, pool, (const int**)rows, N_SAMPLE, preds, votes));
+    TEST_ASSERT_EQUAL_INT_ARRAY(expected, preds, N_SAMPLE);
+    TEST_ASSERT_EQUAL_INT_ARRAY(expected_votes, votes, N_SAMPLE * N_CLASS);
+
+    threadpool_free(pool);
+}
+
+/* Separable training data, see separable_dataset. */
+static uint64_t* separable_train(int n_samples, int* y) {
+    rng_t rng;
+    rng_seed(&rng, (uint64_t)rand());
+    uint64_t* X = (uint64_t*)malloc(sizeof(uint64_t) * BITPACK_WORDS(N_FEATURE) * n_samples);
+    TEST_ASSERT_NOT_NULL(X);
+    separable_dataset(N_FEATURE, N_CLASS, n_samples, &rng, X, y);
+    return X;
+}
+
+static double fit_and_score(tsetlin_train_mode_t mode, threadpool_t* pool, tsetlin_train_stats_t* stats) {
+    enum { N_TRAIN = 300 };
+    int y[N_TRAIN];
+    uint64_t* X = separable_train(N_TRAIN, y);
+
+    tsetlin_t* model = tsetlin_new(N_FEATURE, N_CLASS, N_CLAUSE, 10);
+    TEST_ASSERT_NOT_NULL(model);
+    TEST_ASSERT_EQUAL_INT(0, tsetlin_fit_parallel(model, pool, X, y, N_TRAIN, 10, 3.0, 5, -1, mode, stats));
+
+    int preds[N_TRAIN];
+    TEST_ASSERT_EQUAL_INT(0, tsetlin_predict_batch_packed(model, X, N_TRAIN, preds, NULL));
+    int correct = 0;
+    for (int i = 0; i < N_TRAIN; ++i) correct += (preds[i] == y[i]);
+
+    tsetlin_free(model);
+    free(X);
+    return (double)correct / N_TRAIN;
+}
+
+static void test_fit_parallel_modes_learn(void) {
+    threadpool_t* pool = threadpool_new(4);
+    TEST_ASSERT_NOT_NULL(pool);
+
+    tsetlin_train_mode_t modes[] = { TSETLIN_TRAIN_SERIAL, TSETLIN_TRAIN_CLASS_PARALLEL, TSETLIN_TRAIN_HOGWILD };
+    for (int m = 0; m < 3; ++m) {
+        tsetlin_train_stats_t stats;
+        double accuracy = fit_and_score(modes[m], pool, &stats);
+        TEST_ASSERT_TRUE(accuracy > 0.9);
+        TEST_ASSERT_EQUAL_INT(300 * 5, stats.samples);
+        TEST_ASSERT_TRUE(stats.samples_per_sec > 0.0);
+        TEST_ASSERT_EQUAL_INT(modes[m] == TSETLIN_TRAIN_SERIAL ? 1 : 4, stats.n_threads);
+    }
+
+    threadpool_free(pool);
+}
+
+static void test_absorbing_training_learns(void) {
+    enum { N_TRAIN = 300 };
+    int y[N_TRAIN];
+    uint64_t* X = separable_train(N_TRAIN, y);
+
+    tsetlin_t* model = tsetlin_new(N_FEATURE, N_CLASS, N_CLAUSE, 10);
+    TEST_ASSERT_NOT_NULL(model);
+    TEST_ASSERT_EQUAL_INT(0, tsetlin_set_absorbing(model, 1));
+    TEST_ASSERT_DOUBLE_WITHIN(1e-9, 1.0, tsetlin_live_fraction(model));
+
+    double live = 1.0;
+    for (int epoch = 0; epoch < 5; ++epoch) {
+        TEST_ASSERT_EQUAL_INT(0, tsetlin_fit_parallel(model, NULL, X, y, N_TRAIN, 10, 3.0, 1, -1, TSETLIN_TRAIN_SERIAL, NULL));
+        double now = tsetlin_live_fraction(model);
+        TEST_ASSERT_TRUE(now <= live); /* absorbed automata stay absorbed */
+        live = now;
+    }
+    TEST_ASSERT_TRUE(live < 1.0);
+
+    int preds[N_TRAIN];
+    TEST_ASSERT_EQUAL_INT(0, tsetlin_predict_batch_packed(model, X, N_TRAIN, preds, NULL));
+    int correct = 0;
+    for (int i = 0; i < N_TRAIN; ++i) correct += (preds[i] == y[i]);
+    TEST_ASSERT_TRUE(correct > 0.9 * N_TRAIN);
+
+    tsetlin_free(model);
+    free(X);
+}
+
+/* Short random clauses as in setUp; density sets how often a literal is included. */
+static tsetlin_t* random_model(int n_classes, int n_clauses, int density) {
+    tsetlin_t* model = tsetlin_new(N_FEATURE, n_classes, n_clauses, 10);
+    TEST_ASSERT_NOT_NULL(model);
+    for (int c = 0; c < n_classes; ++c) {
+        for (int j = 0; j < n_clauses; ++j) {
+            clause_t* clause = tsetlin_get_clause(model, c, j);
+            for (int k = 0; k < clause->N_literals; ++k) clause_set_automaton(clause, k, (rand() % density == 0) ? 6 : 5);
+            clause_compress(clause, -1);
+        }
+    }
+    return model;
+}
+
+static void test_predict_pruned_matches_full(void) {
+    uint64_t X[BITPACK_WORDS(N_FEATURE)];
+
+    /* setUp model, more classes and clauses than a turn, and more classes than the stack path */
+    tsetlin_t* models[] = { ts, random_model(12, 64, 40), random_model(70, 10, 80), random_model(5, 30, 1000) };
+    for (int m = 0; m < 4; ++m) {
+        tsetlin_t* model = models[m];
+        int total = model->n_classes * model->n_clauses;
+        for (int i = 0; i < N_SAMPLE; ++i) {
+            bitpack_pack(rows[i], N_FEATURE, X);
+            int evaluated = -1;
+            TEST_ASSERT_EQUAL_INT(tsetlin_predict_packed(model, X, NULL), tsetlin_predict_pruned(model, X, &evaluated));
+            TEST_ASSERT_TRUE(evaluated >= 0 && evaluated <= total);
+        }
+        if (m > 0) tsetlin_free(model);
+    }
+
+    /* A trained, well separated model decides early. */
+    enum { N_TRAIN = 300 };
+    int y[N_TRAIN];
+    uint64_t* Xt = separable_train(N_TRAIN, y);
+    tsetlin_t* model = tsetlin_new(N_FEATURE, N_CLASS, 40, 10);
+    TEST_ASSERT_NOT_NULL(model);
+    TEST_ASSERT_EQUAL_INT(0, tsetlin_fit_parallel(model, NULL, Xt, y, N_TRAIN, 10, 3.0, 5, -1, TSETLIN_TRAIN_SERIAL, NULL));
+
+    int full[N_TRAIN], pruned[N_TRAIN];
+    double fraction = 0.0;
+    TEST_ASSERT_EQUAL_INT(0, tsetlin_predict_batch_packed(model, Xt, N_TRAIN, full, NULL));
+    TEST_ASSERT_EQUAL_INT(0, tsetlin_predict_batch_pruned(model, Xt, N_TRAIN, pruned, &fraction));
+    TEST_ASSERT_EQUAL_INT_ARRAY(full, pruned, N_TRAIN);
+    TEST_ASSERT_TRUE(fraction > 0.0 && fraction < 1.0);
+
+    tsetlin_free(model);
+    free(Xt);
+}
+
+/* Train a fresh model on the packed setUp rows and return its automaton states. */
+static int* train_states(threadpool_t* pool, tsetlin_train_mode_t mode, uint64_t seed) {
+    int n_words = BITPACK_WORDS(N_FEATURE);
+    uint64_t X[N_SAMPLE * BITPACK_WORDS(N_FEATURE)];
+    int y[N_SAMPLE];
+    for (int i = 0; i < N_SAMPLE; ++i) {
+        bitpack_pack(rows[i], N_FEATURE, X + (size_t)i * n_words);
+        y[i] = rows[i][0] + rows[i][1]; /* three classes */
+    }
+
+    tsetlin_t* model = tsetlin_new(N_FEATURE, N_CLASS, N_CLAUSE, 10);
+    TEST_ASSERT_NOT_NULL(model);
+    tsetlin_seed(model, seed);
+    TEST_ASSERT_EQUAL_INT(0, tsetlin_fit_parallel(model, pool, X, y, N_SAMPLE, 10, 3.0, 2, -1, mode, NULL));
+
+    int n_literals = 2 * N_FEATURE;
+    int* states = (int*)malloc(sizeof(int) * N_CLASS * N_CLAUSE * n_literals);
+    for (int c = 0; c < N_CLASS; ++c) {
+        for (int j = 0; j < N_CLAUSE; ++j) {
+            for (int k = 0; k < n_literals; ++k) {
+                states[(c * N_CLAUSE + j) * n_literals + k] = tsetlin_get_automaton(model, c, j, k);
+            }
+        }
+    }
+    tsetlin_free(model);
+    return states;
+}
+
+static void test_training_reproducible_from_seed(void) {
+    int n = N_CLASS * N_CLAUSE * 2 * N_FEATURE;
+    threadpool_t* pool = threadpool_new(4);
+    TEST_ASSERT_NOT_NULL(pool);
+
+    int* a = train_states(NULL, TSETLIN_TRAIN_SERIAL, 11);
+    int* b = train_states(NULL, TSETLIN_TRAIN_SERIAL, 11);
+    TEST_ASSERT_EQUAL_INT_ARRAY(a, b, n);
+    free(b);
+
+    /* class-parallel draws from one stream per class, whatever the number of workers */
+    free(a);
+    a = train_states(NULL, TSETLIN_TRAIN_CLASS_PARALLEL, 11);
+    b = train_states(pool, TSETLIN_TRAIN_CLASS_PARALLEL, 11);
+    TEST_ASSERT_EQUAL_INT_ARRAY(a, b, n);
+
+    free(a);
+    free(b);
+    threadpool_free(pool);
+}
+
+static void test_new_in_caller_memory(void) {
+    size_t size = tsetlin_arena_size(N_FEATURE, N_CLASS, N_CLAUSE);
+    unsigned char* raw = (unsigned char*)malloc(size + 64);
+    TEST_ASSERT_NOT_NULL(raw);
+    unsigned char* mem = raw + (64 - (uintptr_t)raw % 64) % 64;
+
+    TEST_ASSERT_NULL(tsetlin_new_in(mem, size - 1, N_FEATURE, N_CLASS, N_CLAUSE, 10));
+    TEST_ASSERT_NULL(tsetlin_new_in(mem + 8, size, N_FEATURE, N_CLASS, N_CLAUSE, 10));
+
+    tsetlin_t* placed = tsetlin_new_in(mem, size, N_FEATURE, N_CLASS, N_CLAUSE, 10);
+    tsetlin_t* owned = tsetlin_new(N_FEATURE, N_CLASS, N_CLAUSE, 10);
+    TEST_ASSERT_TRUE((unsigned char*)placed == mem);
+    TEST_ASSERT_NOT_NULL(owned);
+
+    /* same initial states, and every clause array lies inside the caller's region */
+    for (int c = 0; c < N_CLASS; ++c) {
+        for (int j = 0; j < N_CLAUSE; ++j) {
+            clause_t* clause = tsetlin_get_clause(placed, c, j);
+            TEST_ASSERT_TRUE((unsigned char*)clause->p_automata >= mem);
+            TEST_ASSERT_TRUE((unsigned char*)(clause->n_trainable_idxs + N_FEATURE) <= mem + size);
+            for (int k = 0; k < 2 * N_FEATURE; ++k) {
+                TEST_ASSERT_EQUAL_INT(tsetlin_get_automaton(owned, c, j, k), tsetlin_get_automaton(placed, c, j, k));
+            }
+        }
+    }
+
+    /* both train the same way */
+    for (int i = 0; i < N_SAMPLE; ++i) {
+        tsetlin_step(placed, rows[i], i % N_CLASS, 10, 3.0, NULL, -1);
+        tsetlin_step(owned, rows[i], i % N_CLASS, 10, 3.0, NULL, -1);
+    }
+    for (int i = 0; i < N_SAMPLE; ++i) {
+        int votes_placed[N_CLASS], votes_owned[N_CLASS];
+        TEST_ASSERT_EQUAL_INT(tsetlin_predict(owned, rows[i], votes_owned), tsetlin_predict(placed, rows[i], votes_placed));
+        TEST_ASSERT_EQUAL_INT_ARRAY(votes_owned, votes_placed, N_CLASS);
+    }
+
+    tsetlin_free(placed); /* no-op: the caller owns mem */
+    tsetlin_free(owned);
+    free(raw);
+}
+
+#define MODEL_PATH "unit_test_tsetlin_model.bin"
+
+static void test_save_load_map_roundtrip(void) {
+    for (int i = 0; i < N_SAMPLE; ++i) TEST_ASSERT_EQUAL_INT(0, tsetlin_step(ts, rows[i], i % N_CLASS, 10, 3.0, NULL, -1));
+    TEST_ASSERT_EQUAL_INT(0, tsetlin_save(ts, MODEL_PATH));
+
+    tsetlin_t* loaded = tsetlin_load(MODEL_PATH);
+    tsetlin_t* mapped = tsetlin_map(MODEL_PATH);
+    TEST_ASSERT_NOT_NULL(loaded);
+    TEST_ASSERT_NOT_NULL(mapped);
+    TEST_ASSERT_EQUAL_INT(N_CLAUSE, mapped->n_clauses);
+
+    for (int c = 0; c < N_CLASS; ++c) {
+        for (int j = 0; j < N_CLAUSE; ++j) {
+            for (int k = 0; k < 2 * N_FEATURE; ++k) {
+                int expected = tsetlin_get_automaton(ts, c, j, k);
+                TEST_ASSERT_EQUAL_INT(expected, tsetlin_get_automaton(loaded, c, j, k));
+                TEST_ASSERT_EQUAL_INT(expected, tsetlin_get_automaton(mapped, c, j, k));
+            }
+        }
+    }
+
+    int preds[N_SAMPLE], mapped_preds[N_SAMPLE];
+    int votes[N_SAMPLE * N_CLASS], mapped_votes[N_SAMPLE * N_CLASS];
+    TEST_ASSERT_EQUAL_INT(0, tsetlin_predict_batch(ts, (const int**)rows, N_SAMPLE, preds, votes));
+    TEST_ASSERT_EQUAL_INT(0, tsetlin_predict_batch(mapped, (const int**)rows, N_SAMPLE, mapped_preds, mapped_votes));
+    TEST_ASSERT_EQUAL_INT_ARRAY(preds, mapped_preds, N_SAMPLE);
+    TEST_ASSERT_EQUAL_INT_ARRAY(votes, mapped_votes, N_SAMPLE * N_CLASS);
+    for (int i = 0; i < N_SAMPLE; ++i) TEST_ASSERT_EQUAL_INT(preds[i], tsetlin_predict(loaded, rows[i], NULL));
+
+    /* mapped models cannot be trained */
+    uint64_t X[BITPACK_WORDS(N_FEATURE)];
+    int y = 0;
+    bitpack_pack(rows[0], N_FEATURE, X);
+    TEST_ASSERT_EQUAL_INT(-1, tsetlin_fit_parallel(mapped, NULL, X, &y, 1, 10, 3.0, 1, -1, TSETLIN_TRAIN_SERIAL, NULL));
+    tsetlin_feedback_t fb;
+    TEST_ASSERT_EQUAL_INT(-1, tsetlin_step_packed(mapped, X, y, 10, 3.0, &fb, -1));
+    TEST_ASSERT_EQUAL_INT(-1, tsetlin_step(mapped, rows[0], y, 10, 3.0, &fb, -1));
+    TEST_ASSERT_EQUAL_INT(-1, tsetlin_set_absorbing(mapped, 1));
+    TEST_ASSERT_EQUAL_INT(0, mapped->absorbing);
+
+    tsetlin_free(loaded);
+    tsetlin_free(mapped);
+
+    FILE* f = fopen(MODEL_PATH, "r+b");
+    TEST_ASSERT_NOT_NULL(f);
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fclose(f);
+    unsigned char* bytes = (unsigned char*)malloc((size_t)size);
+    f = fopen(MODEL_PATH, "rb");
+    TEST_ASSERT_EQUAL_INT((int)size, (int)fread(bytes, 1, (size_t)size, f));
+    fclose(f);
+
+    /* states outside [1, n_states] are rejected: the first state of the first clause follows the header */
+    static const int bad_states[] = { 0, 11 };
+    for (int b = 0; b < 2; ++b) {
+        f = fopen(MODEL_PATH, "r+b");
+        fseek(f, 64, SEEK_SET);
+        fputc(bad_states[b], f);
+        fputc(0, f);
+        fclose(f);
+        TEST_ASSERT_NULL(tsetlin_load(MODEL_PATH));
+        TEST_ASSERT_NULL(tsetlin_map(MODEL_PATH));
+    }
+
+    /* an include mask that disagrees with its states is rejected by tsetlin_map; tsetlin_load
+     * rebuilds the masks from the states */
+    size_t masks_offset = 0;
+    for (int i = 7; i >= 0; --i) masks_offset = (masks_offset << 8) | bytes[48 + i];
+    bytes[masks_offset] ^= 1;
+    f = fopen(MODEL_PATH, "wb");
+    fwrite(bytes, 1, (size_t)size, f);
+    fclose(f);
+    bytes[masks_offset] ^= 1;
+    loaded = tsetlin_load(MODEL_PATH);
+    TEST_ASSERT_NOT_NULL(loaded);
+    tsetlin_free(loaded);
+    TEST_ASSERT_NULL(tsetlin_map(MODEL_PATH));
+
+    /* a header whose block offsets wrap around (2^30 features, 2^20 x 2^20 clauses) is rejected */
+    unsigned char header[64];
+    memcpy(header, bytes, sizeof(header));
+    const unsigned char huge[12] = { 0, 0, 0, 0x40, 0, 0, 0x10, 0, 0, 0, 0x10, 0 }; /* LE u32 at 16, 20, 24 */
+    memcpy(header + 16, huge, sizeof(huge));
+    for (int i = 0; i < 3; ++i) {
+        memset(header + 40 + 8 * i, 0, 8);
+        header[40 + 8 * i] = 64; /* states_offset = masks_offset = file_size = 64 */
+    }
+    f = fopen(MODEL_PATH, "wb");
+    fwrite(header, 1, sizeof(header), f);
+    fclose(f);
+    TEST_ASSERT_NULL(tsetlin_load(MODEL_PATH));
+    TEST_ASSERT_NULL(tsetlin_map(MODEL_PATH));
+
+    /* a truncated file is rejected */
+    f = fopen(MODEL_PATH, "wb");
+    fwrite(bytes, 1, (size_t)size - 64, f);
+    fclose(f);
+    free(bytes);
+    TEST_ASSERT_NULL(tsetlin_load(MODEL_PATH));
+    TEST_ASSERT_NULL(tsetlin_map(MODEL_PATH));
+
+    remove(MODEL_PATH);
+    TEST_ASSERT_NULL(tsetlin_load(MODEL_PATH));
+}
+
+/* not needed when using generate_test_runner.rb */
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_predict_batch_matches_predict);
+    RUN_TEST(test_predict_batch_packed_matches_predict);
+    RUN_TEST(test_predict_parallel_matches_batch);
+    RUN_TEST(test_fit_parallel_modes_learn);
+    RUN_TEST(test_absorbing_training_learns);
+    RUN_TEST(test_predict_pruned_matches_full);
+    RUN_TEST(test_training_reproducible_from_seed);
+    RUN_TEST(test_new_in_caller_memory);
+    RUN_TEST(test_save_load_map_roundtrip);
+
+    return UNITY_END();
+}
@@ -0,0 +1,433 @@
+/*
+ * tsetlin_bench: micro-benchmarks of the clause kernels and the model step / predict on
+ * synthetic data, over a grid of feature, state, class and clause counts.
+ *
+ *   tsetlin_bench [--json PATH] [--quick] [--reps N] [--filter TEXT]
+ *
+ * Every benchmark is warmed up, then timed over N repetitions (default 30) of a batch of calls
+ * sized to run for at least BENCH_MIN_BATCH_SECONDS. Each repetition yields the mean time per
+ * call over its batch; reported are the median, min and max of those batch means, which show
+ * run-to-run spread, not per-call tail latency. --json writes the results for tracking across
+ * releases; --quick runs a reduced grid; --filter keeps benchmarks whose name contains TEXT.
+ * The `bench` build target runs this with --json bench.json.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <bitpack.h>
+#include <bitslice.h>
+#include <clause.h>
+#include <rng.h>
+#include <thread.h>
+#include <tsetlin.h>
+
+#define BENCH_JSON_VERSION 2
+#define BENCH_INPUTS 256                 /* distinct synthetic inputs, cycled through */
+#define BENCH_MIN_BATCH_SECONDS 1e-3
+#define BENCH_WARMUP_SECONDS 50e-3
+#define BENCH_MAX_MODEL_BYTES ((size_t)512 << 20) /* larger grid points are skipped */
+
+/* Grid axes. Clause benchmarks run over features x states, model benchmarks over
+ * features x classes x clauses with the first state count. */
+static const int grid_features[] = { 64, 784, 4096 };
+static const int grid_states[] = { 100, 1000 };
+static const int grid_classes[] = { 2, 10 };
+static const int grid_clauses[] = { 100, 1000 };
+static const int quick_features[] = { 784 };
+static const int quick_states[] = { 100 };
+static const int quick_classes[] = { 10 };
+static const int quick_clauses[] = { 100 };
+
+#define COUNT(a) ((int)(sizeof(a) / sizeof((a)[0])))
+
+typedef struct {
+    int n_features, n_words;
+    const uint64_t* Xp;     /* BENCH_INPUTS packed rows */
+    const int* Xi;          /* the same rows unpacked */
+    const int* y;           /* BENCH_INPUTS labels */
+    clause_t* c;
+    bitslice_t* bs;         /* run_bitslice_update: bit-sliced states of c */
+    tsetlin_t* ts;
+    int match_target;       /* clause_update: 1 Type I, 0 Type II */
+    int threshold;
+    int T;
+    double s;
+    rng_t rng;
+    int next;               /* input cursor */
+    volatile int sink;
+} bench_ctx_t;
+
+typedef void (*bench_fn)(bench_ctx_t* ctx, long n_calls);
+
+typedef struct {
+    const char* name;
+    int n_features, n_states, n_classes, n_clauses, threshold; /* 0 where not applicable, threshold -1 */
+    int samples;            /* calls are training or prediction samples */
+    long batch;
+    int reps;
+    double min_ns, median_ns, max_ns, mean_ns; /* over the batch means of the repetitions */
+} result_t;
+
+typedef struct {
+    result_t* items;
+    int count, capacity;
+} results_t;
+
+static int next_input(bench_ctx_t* ctx) {
+    int i = ctx->next;
+    ctx->next = (i + 1 == BENCH_INPUTS) ? 0 : i + 1;
+    return i;
+}
+
+static void run_clause_evaluate(bench_ctx_t* ctx, long n_calls) {
+    int sum = 0;
+    for (long k = 0; k < n_calls; ++k) sum += clause_evaluate(ctx->c, ctx->Xi + (size_t)next_input(ctx) * ctx->n_features);
+    ctx->sink += sum;
+}
+
+static void run_clause_evaluate_packed(bench_ctx_t* ctx, long n_calls) {
+    int sum = 0;
+    for (long k = 0; k < n_calls; ++k) sum += clause_evaluate_packed(ctx->c, ctx->Xp + (size_t)next_input(ctx) * ctx->n_words);
+    ctx->sink += sum;
+}
+
+/* clause_output 1: Type I then rewards or penalizes every literal, Type II acts at all. */
+static void run_clause_update(bench_ctx_t* ctx, long n_calls) {
+    int sum = 0;
+    for (long k = 0; k < n_calls; ++k) {
+        const int* X = ctx->Xi + (size_t)next_input(ctx) * ctx->n_features;
+        sum += clause_update(ctx->c, X, ctx->match_target, 1, ctx->s, ctx->threshold, &ctx->rng);
+    }
+    ctx->sink += sum;
+}
+
+static void run_clause_update_packed(bench_ctx_t* ctx, long n_calls) {
+    int sum = 0;
+    for (long k = 0; k < n_calls; ++k) {
+        const uint64_t* X = ctx->Xp + (size_t)next_input(ctx) * ctx->n_words;
+        sum += clause_update_packed(ctx->c, X, ctx->match_target, 1, ctx->s, ctx->threshold, &ctx->rng);
+    }
+    ctx->sink += sum;
+}
+
+static void run_bitslice_update(bench_ctx_t* ctx, long n_calls) {
+    int sum = 0;
+    for (long k = 0; k < n_calls; ++k) {
+        const uint64_t* X = ctx->Xp + (size_t)next_input(ctx) * ctx->n_words;
+        sum += bitslice_update(ctx->bs, X, ctx->match_target, 1, ctx->s, &ctx->rng);
+    }
+    ctx->sink += sum;
+}
+
+static void run_tsetlin_step(bench_ctx_t* ctx, long n_calls) {
+    for (long k = 0; k < n_calls; ++k) {
+        int i = next_input(ctx);
+        tsetlin_step(ctx->ts, ctx->Xi + (size_t)i * ctx->n_features, ctx->y[i], ctx->T, ctx->s, NULL, ctx->threshold);
+    }
+}
+
+static void run_tsetlin_step_packed(bench_ctx_t* ctx, long n_calls) {
+    for (long k = 0; k < n_calls; ++k) {
+        int i = next_input(ctx);
+        tsetlin_step_packed(ctx->ts, ctx->Xp + (size_t)i * ctx->n_words, ctx->y[i], ctx->T, ctx->s, NULL, ctx->threshold);
+    }
+}
+
+static void run_tsetlin_predict(bench_ctx_t* ctx, long n_calls) {
+    int sum = 0;
+    for (long k = 0; k < n_calls; ++k) sum += tsetlin_predict(ctx->ts, ctx->Xi + (size_t)next_input(ctx) * ctx->n_features, NULL);
+    ctx->sink += sum;
+}
+
+static void run_tsetlin_predict_packed(bench_ctx_t* ctx, long n_calls) {
+    int sum = 0;
+    for (long k = 0; k < n_calls; ++k) sum += tsetlin_predict_packed(ctx->ts, ctx->Xp + (size_t)next_input(ctx) * ctx->n_words, NULL);
+    ctx->sink += sum;
+}
+
+static void run_tsetlin_predict_pruned(bench_ctx_t* ctx, long n_calls) {
+    int sum = 0;
+    for (long k = 0; k < n_calls; ++k) sum += tsetlin_predict_pruned(ctx->ts, ctx->Xp + (size_t)next_input(ctx) * ctx->n_words, NULL);
+    ctx->sink += sum;
+}
+
+static int compare_double(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double time_batch(bench_fn fn, bench_ctx_t* ctx, long n_calls) {
+    double start = thread_clock_seconds();
+    fn(ctx, n_calls);
+    return thread_clock_seconds() - start;
+}
+
+/* Warm up, size the batch, time reps batches; fills the timing fields of r. */
+static void measure(bench_fn fn, bench_ctx_t* ctx, int reps, double warmup, result_t* r) {
+    double spent = 0.0;
+    while (spent < warmup) spent += time_batch(fn, ctx, 1);
+
+    long batch = 1;
+    while (batch < (1L << 24) && time_batch(fn, ctx, batch) < BENCH_MIN_BATCH_SECONDS) batch *= 2;
+
+    double* ns = (double*)malloc(sizeof(double) * reps);
+    if (!ns) exit(1);
+    double total = 0.0;
+    for (int k = 0; k < reps; ++k) {
+        ns[k] = time_batch(fn, ctx, batch) * 1e9 / (double)batch;
+        total += ns[k];
+    }
+    qsort(ns, reps, sizeof(double), compare_double);
+
+    r->batch = batch;
+    r->reps = reps;
+    r->min_ns = ns[0];
+    r->median_ns = (reps % 2) ? ns[reps / 2] : 0.5 * (ns[reps / 2 - 1] + ns[reps / 2]);
+    r->max_ns = ns[reps - 1];
+    r->mean_ns = total / reps;
+    free(ns);
+}
+
+static void report(results_t* results, const result_t* r) {
+    if (results->count == results->capacity) {
+        int capacity = results->capacity ? 2 * results->capacity : 64;
+        result_t* items = (result_t*)realloc(results->items, sizeof(result_t) * capacity);
+        if (!items) exit(1);
+        results->items = items;
+        results->capacity = capacity;
+    }
+    results->items[results->count++] = *r;
+
+    char shape[96];
+    if (r->n_classes) sprintf(shape, "f=%d k=%d c=%d st=%d", r->n_features, r->n_classes, r->n_clauses, r->n_states);
+    else sprintf(shape, "f=%d st=%d", r->n_features, r->n_states);
+    if (r->threshold >= 0) sprintf(shape + strlen(shape), " th=%d", r->threshold);
+    printf("%-30s %-30s %12.1f ns/op  min %10.1f  max %10.1f", r->name, shape, r->median_ns, r->min_ns, r->max_ns);
+    if (r->samples) printf("  %12.0f samples/s", 1e9 / r->median_ns);
+    printf("\n");
+    fflush(stdout);
+}
+
+static int wanted(const char* name, const char* filter) {
+    return !filter || strstr(name, filter) != NULL;
+}
+
+/* Random rows, each bit set with probability 1/2, padding bits clear; labels below n_classes. */
+static void make_inputs(int n_features, int n_classes, uint64_t* Xp, int* Xi, int* y, rng_t* rng) {
+    int n_words = BITPACK_WORDS(n_features);
+    int tail = n_features % 64;
+    for (int i = 0; i < BENCH_INPUTS; ++i) {
+        uint64_t* row = Xp + (size_t)i * n_words;
+        for (int w = 0; w < n_words; ++w) row[w] = rng_next(rng);
+        if (tail) row[n_words - 1] &= ((uint64_t)1 << tail) - 1;
+        bitpack_unpack(row, n_features, Xi + (size_t)i * n_features);
+        y[i] = rng_below(rng, n_classes);
+    }
+}
+
+static void bench_clauses(results_t* results, int n_features, int n_states, int reps, double warmup, const char* filter,
+    const uint64_t* Xp, const int* Xi) {
+    static const struct { const char* name; bench_fn fn; int match_target; int thresholded; } cases[] = {
+        { "clause_evaluate", run_clause_evaluate, 0, 0 },
+        { "clause_evaluate_packed", run_clause_evaluate_packed, 0, 0 },
+        { "clause_update_type1", run_clause_update, 1, 0 },
+        { "clause_update_type1", run_clause_update, 1, 1 },
+        { "clause_update_type2", run_clause_update, 0, 0 },
+        { "clause_update_type2", run_clause_update, 0, 1 },
+        { "clause_update_packed_type1", run_clause_update_packed, 1, 0 },
+        { "clause_update_packed_type1", run_clause_update_packed, 1, 1 },
+        { "clause_update_packed_type2", run_clause_update_packed, 0, 0 },
+        { "clause_update_packed_type2", run_clause_update_packed, 0, 1 },
+        { "bitslice_update_type1", run_bitslice_update, 1, 0 },
+        { "bitslice_update_type2", run_bitslice_update, 0, 0 },
+    };
+
+    for (int k = 0; k < COUNT(cases); ++k) {
+        if (!wanted(cases[k].name, filter)) continue;
+
+        bench_ctx_t ctx;
+        memset(&ctx, 0, sizeof(ctx));
+        rng_seed(&ctx.rng, 1);
+        ctx.n_features = n_features;
+        ctx.n_words = BITPACK_WORDS(n_features);
+        ctx.Xp = Xp;
+        ctx.Xi = Xi;
+        ctx.match_target = cases[k].match_target;
+        ctx.threshold = cases[k].thresholded ? n_states / 10 : -1;
+        ctx.s = 5.0;
+        ctx.c = clause_new(n_features, n_states, &ctx.rng);
+        if (!ctx.c) exit(1);
+        if (ctx.threshold >= 0) clause_compress(ctx.c, ctx.threshold);
+
+        bitslice_t bs;
+        uint64_t* planes = NULL;
+        if (cases[k].fn == run_bitslice_update) {
+            planes = (uint64_t*)malloc(bitslice_footprint(n_features, n_states));
+            if (!planes) exit(1);
+            bitslice_init(&bs, n_features, n_states, planes);
+            bitslice_load(&bs, ctx.c);
+            ctx.bs = &bs;
+        }
+
+        result_t r;
+        memset(&r, 0, sizeof(r));
+        r.name = cases[k].name;
+        r.n_features = n_features;
+        r.n_states = n_states;
+        r.threshold = ctx.threshold;
+        measure(cases[k].fn, &ctx, reps, warmup, &r);
+        report(results, &r);
+        free(planes);
+        clause_free(ctx.c);
+    }
+}
+
+static void bench_model(results_t* results, int n_features, int n_states, int n_classes, int n_clauses, int reps, double warmup,
+    const char* filter, const uint64_t* Xp, const int* Xi, const int* y) {
+    static const struct { const char* name; bench_fn fn; int thresholded; } cases[] = {
+        { "tsetlin_step", run_tsetlin_step, 0 },
+        { "tsetlin_step", run_tsetlin_step, 1 },
+        { "tsetlin_step_packed", run_tsetlin_step_packed, 0 },
+        { "tsetlin_step_packed", run_tsetlin_step_packed, 1 },
+        { "tsetlin_predict", run_tsetlin_predict, 0 },
+        { "tsetlin_predict_packed", run_tsetlin_predict_packed, 0 },
+        { "tsetlin_predict_pruned", run_tsetlin_predict_pruned, 0 },
+    };
+
+    size_t bytes = tsetlin_arena_size(n_features, n_classes, n_clauses);
+    if (bytes > BENCH_MAX_MODEL_BYTES) {
+        printf("skipped f=%d k=%d c=%d: model of %zu bytes\n", n_features, n_classes, n_clauses, bytes);
+        return;
+    }
+
+    for (int k = 0; k < COUNT(cases); ++k) {
+        if (!wanted(cases[k].name, filter)) continue;
+
+        bench_ctx_t ctx;
+        memset(&ctx, 0, sizeof(ctx));
+        ctx.n_features = n_features;
+        ctx.n_words = BITPACK_WORDS(n_features);
+        ctx.Xp = Xp;
+        ctx.Xi = Xi;
+        ctx.y = y;
+        ctx.threshold = cases[k].thresholded ? n_states / 10 : -1;
+        ctx.s = 5.0;
+        ctx.T = n_clauses / 2;
+        ctx.ts = tsetlin_new(n_features, n_classes, n_clauses, n_states);
+        if (!ctx.ts) exit(1);
+        tsetlin_seed(ctx.ts, 1);
+
+        result_t r;
+        memset(&r, 0, sizeof(r));
+        r.name = cases[k].name;
+        r.n_features = n_features;
+        r.n_states = n_states;
+        r.n_classes = n_classes;
+        r.n_clauses = n_clauses;
+        r.threshold = ctx.threshold;
+        r.samples = 1;
+        measure(cases[k].fn, &ctx, reps, warmup, &r);
+        report(results, &r);
+        tsetlin_free(ctx.ts);
+    }
+}
+
+static int write_json(const results_t* results, const char* path) {
+    FILE* f = fopen(path, "w");
+    if (!f) return -1;
+
+#if defined(__VERSION__)
+    const char* compiler = __VERSION__;
+#elif defined(_MSC_VER)
+    const char* compiler = "msvc";
+#else
+    const char* compiler = "unknown";
+#endif
+
+    fprintf(f, "{\n  \"version\": %d,\n  \"timestamp\": %lld,\n  \"compiler\": \"", BENCH_JSON_VERSION, (long long)time(NULL));
+    for (const char* p = compiler; *p; ++p) {
+        if (*p == '"' || *p == '\\') fputc('\\', f);
+        fputc(*p, f);
+    }
+    fprintf(f, "\",\n  \"results\": [\n");
+    for (int i = 0; i < results->count; ++i) {
+        const result_t* r = &results->items[i];
+        fprintf(f, "    {\"name\": \"%s\", \"n_features\": %d, \"n_states\": %d, \"n_classes\": %d, \"n_clauses\": %d, \"threshold\": %d, "
+            "\"batch\": %ld, \"reps\": %d, \"ns_per_op\": %.2f, \"min_ns\": %.2f, \"median_ns\": %.2f, \"max_ns\": %.2f, "
+            "\"mean_ns\": %.2f, \"ops_per_sec\": %.1f",
+            r->name, r->n_features, r->n_states, r->n_classes, r->n_clauses, r->threshold,
+            r->batch, r->reps, r->median_ns, r->min_ns, r->median_ns, r->max_ns, r->mean_ns, 1e9 / r->median_ns);
+        if (r->samples) fprintf(f, ", \"samples_per_sec\": %.1f", 1e9 / r->median_ns);
+        fprintf(f, "}%s\n", (i + 1 < results->count) ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    return fclose(f) == 0 ? 0 : -1;
+}
+
+int main(int argc, char** argv) {
+    const char* json_path = NULL;
+    const char* filter = NULL;
+    int quick = 0;
+    int reps = 30;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) json_path = argv[++i];
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) filter = argv[++i];
+        else if (strcmp(argv[i], "--reps") == 0 && i + 1 < argc) reps = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--quick") == 0) quick = 1;
+        else {
+            fprintf(stderr, "usage: %s [--json PATH] [--quick] [--reps N] [--filter TEXT]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (reps < 1) reps = 1;
+
+    const int* features = quick ? quick_features : grid_features;
+    const int* states = quick ? quick_states : grid_states;
+    const int* classes = quick ? quick_classes : grid_classes;
+    const int* clauses = quick ? quick_clauses : grid_clauses;
+    int n_features_axis = quick ? COUNT(quick_features) : COUNT(grid_features);
+    int n_states_axis = quick ? COUNT(quick_states) : COUNT(grid_states);
+    int n_classes_axis = quick ? COUNT(quick_classes) : COUNT(grid_classes);
+    int n_clauses_axis = quick ? COUNT(quick_clauses) : COUNT(grid_clauses);
+    double warmup = quick ? BENCH_WARMUP_SECONDS / 5 : BENCH_WARMUP_SECONDS;
+
+    results_t results = { NULL, 0, 0 };
+    rng_t rng;
+    rng_seed(&rng, 7);
+
+    for (int a = 0; a < n_features_axis; ++a) {
+        int n_features = features[a];
+        uint64_t* Xp = (uint64_t*)malloc(sizeof(uint64_t) * BENCH_INPUTS * BITPACK_WORDS(n_features));
+        int* Xi = (int*)malloc(sizeof(int) * BENCH_INPUTS * (size_t)n_features);
+        int* y = (int*)malloc(sizeof(int) * BENCH_INPUTS);
+        if (!Xp || !Xi || !y) return 1;
+
+        for (int b = 0; b < n_states_axis; ++b) {
+            make_inputs(n_features, 2, Xp, Xi, y, &rng);
+            bench_clauses(&results, n_features, states[b], reps, warmup, filter, Xp, Xi);
+        }
+        for (int b = 0; b < n_classes_axis; ++b) {
+            make_inputs(n_features, classes[b], Xp, Xi, y, &rng);
+            for (int c = 0; c < n_clauses_axis; ++c) {
+                bench_model(&results, n_features, states[0], classes[b], clauses[c], reps, warmup, filter, Xp, Xi, y);
+            }
+        }
+
+        free(Xp);
+        free(Xi);
+        free(y);
+    }
+
+    int status = 0;
+    if (json_path) {
+        if (write_json(&results, json_path) == 0) printf("wrote %d results to %s\n", results.count, json_path);
+        else {
+            fprintf(stderr, "cannot write %s\n", json_path);
+            status = 1;
+        }
+    }
+    free(results.items);
+    return status;
+}
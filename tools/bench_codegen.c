@@ -0,0 +1,83 @@
+/*
+ * bench_codegen: compare the generated predictor against the generic one on the same model.
+ *
+ *   bench_codegen [MODEL] [N_SAMPLES]
+ *
+ * MODEL defaults to the TSETLIN_CODEGEN_MODEL the predictor was generated from. Inputs are
+ * random packed rows; both predictors must agree on every one.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <compact.h>
+#include <thread.h>
+#include <tsetlin.h>
+#include <tsetlin_generated.h>
+
+#define REPEATS 5 /* best of */
+
+int main(int argc, char** argv) {
+    const char* model = (argc > 1) ? argv[1] : TSETLIN_CODEGEN_MODEL;
+    int n_samples = (argc > 2) ? atoi(argv[2]) : 10000;
+    if (n_samples <= 0) n_samples = 10000;
+
+    tsetlin_t* ts = tsetlin_load(model);
+    if (!ts) {
+        fprintf(stderr, "cannot load %s\n", model);
+        return 1;
+    }
+    if (ts->n_features != TSETLIN_GENERATED_N_FEATURES || ts->n_classes != TSETLIN_GENERATED_N_CLASSES) {
+        fprintf(stderr, "%s does not match the generated predictor\n", model);
+        return 1;
+    }
+    tsetlin_compact_t* cm = tsetlin_compact_new(ts);
+
+    int n_words = TSETLIN_GENERATED_N_WORDS;
+    uint64_t* X = (uint64_t*)malloc(sizeof(uint64_t) * (size_t)n_words * n_samples);
+    int* expected = (int*)malloc(sizeof(int) * n_samples);
+    if (!cm || !X || !expected) return 1;
+
+    rng_t rng;
+    rng_seed(&rng, 1);
+    int tail = ts->n_features % 64;
+    for (int i = 0; i < n_samples; ++i) {
+        uint64_t* row = X + (size_t)i * n_words;
+        for (int w = 0; w < n_words; ++w) row[w] = rng_next(&rng);
+        if (tail) row[n_words - 1] &= ((uint64_t)1 << tail) - 1; /* padding bits stay clear */
+    }
+
+    /* Best-of-REPEATS ns/sample of each predictor; the generated one is checked against the generic one. */
+    const char* names[3] = { "generic (tsetlin_predict_packed)", "compact (tsetlin_compact_predict_packed)", "generated" };
+    double best[3] = { 1e30, 1e30, 1e30 };
+    long mismatches = 0;
+    volatile int sink = 0;
+    for (int r = 0; r < REPEATS; ++r) {
+        for (int p = 0; p < 3; ++p) {
+            double start = thread_clock_seconds();
+            for (int i = 0; i < n_samples; ++i) {
+                const uint64_t* row = X + (size_t)i * n_words;
+                int pred;
+                if (p == 0) pred = expected[i] = tsetlin_predict_packed(ts, row, NULL);
+                else if (p == 1) pred = tsetlin_compact_predict_packed(cm, row, NULL);
+                else pred = tsetlin_generated_predict_packed(row, NULL);
+                if (p > 0 && pred != expected[i]) ++mismatches;
+                sink += pred;
+            }
+            double ns = (thread_clock_seconds() - start) * 1e9 / n_samples;
+            if (ns < best[p]) best[p] = ns;
+        }
+    }
+    (void)sink;
+
+    printf("model: %s (%d features, %d classes, %d clauses)\n", model, ts->n_features, ts->n_classes, ts->n_clauses);
+    for (int p = 0; p < 3; ++p) {
+        printf("%-42s %10.1f ns/sample  %6.2fx\n", names[p], best[p], best[0] / best[p]);
+    }
+    printf("mismatches: %ld\n", mismatches);
+
+    free(X);
+    free(expected);
+    tsetlin_compact_free(cm);
+    tsetlin_free(ts);
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,145 @@
+/*
+ * tsetlin_codegen: compile a trained model into a standalone C predictor.
+ *
+ *   tsetlin_codegen MODEL OUT_BASE [NAME]
+ *
+ * MODEL is a file from tsetlin_save or tsetlin_compact_save. Writes OUT_BASE.h and OUT_BASE.c
+ * defining NAME_predict / NAME_predict_packed (NAME defaults to tsetlin_generated). Every clause
+ * becomes a straight-line test against constant masks, with the dimensions as compile-time
+ * constants. The output needs only <stdint.h>: no heap allocation and no tsetlin library.
+ */
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <compact.h>
+#include <tsetlin.h>
+
+static void upper(const char* in, char* out, size_t size) {
+    size_t i = 0;
+    for (; in[i] && i + 1 < size; ++i) out[i] = (char)toupper((unsigned char)in[i]);
+    out[i] = '\0';
+}
+
+static int write_header(const tsetlin_compact_t* cm, const char* path, const char* name, const char* model) {
+    char NAME[256];
+    upper(name, NAME, sizeof(NAME));
+
+    FILE* f = fopen(path, "w");
+    if (!f) return -1;
+
+    fprintf(f, "/* Generated by tsetlin_codegen from %s. Do not edit. */\n", model);
+    fprintf(f, "#ifndef %s_H\n#define %s_H\n\n#include <stdint.h>\n\n", NAME, NAME);
+    fprintf(f, "#define %s_N_FEATURES %d\n", NAME, cm->n_features);
+    fprintf(f, "#define %s_N_CLASSES %d\n", NAME, cm->n_classes);
+    fprintf(f, "#define %s_N_WORDS %d /* packed input words, see bitpack.h */\n\n", NAME, cm->n_words);
+    fprintf(f, "#ifdef __cplusplus\nextern \"C\" {\n#endif\n\n");
+    fprintf(f, "    /* Same result as tsetlin_predict_packed on the source model. X holds %s_N_WORDS packed words;\n", NAME);
+    fprintf(f, "     * votes_out is NULL or receives %s_N_CLASSES votes. */\n", NAME);
+    fprintf(f, "    int %s_predict_packed(const uint64_t* X, int* votes_out);\n\n", name);
+    fprintf(f, "    /* Same as %s_predict_packed with X as %s_N_FEATURES ints (0 or 1). */\n", name, NAME);
+    fprintf(f, "    int %s_predict(const int* X, int* votes_out);\n\n", name);
+    fprintf(f, "#ifdef __cplusplus\n}\n#endif\n\n#endif /* %s_H */\n", NAME);
+
+    return (fclose(f) == 0) ? 0 : -1;
+}
+
+static int write_source(const tsetlin_compact_t* cm, const char* path, const char* header, const char* name, const char* model) {
+    char NAME[256];
+    upper(name, NAME, sizeof(NAME));
+
+    FILE* f = fopen(path, "w");
+    if (!f) return -1;
+
+    fprintf(f, "/* Generated by tsetlin_codegen from %s. Do not edit. */\n", model);
+    fprintf(f, "#include \"%s\"\n\n", header);
+
+    /* A clause fires when every word it reads has its positive literals set and its negated
+     * literals clear: (X[w] & (p | n)) == p. */
+    fprintf(f, "int %s_predict_packed(const uint64_t* X, int* votes_out) {\n", name);
+    fprintf(f, "    int votes[%s_N_CLASSES];\n\n", NAME);
+    for (int c = 0; c < cm->n_classes; ++c) {
+        fprintf(f, "    /* class %d */\n", c);
+        fprintf(f, "    votes[%d] = %d;\n", c, cm->bias[c]);
+        for (int k = cm->class_begin[c]; k < cm->class_begin[c + 1]; ++k) {
+            fprintf(f, "    votes[%d] %s= ", c, (cm->sign[k] > 0) ? "+" : "-");
+            for (int e = cm->entry_begin[k]; e < cm->entry_begin[k + 1]; ++e) {
+                unsigned long long p = (unsigned long long)cm->entry_p[e];
+                unsigned long long n = (unsigned long long)cm->entry_n[e];
+                fprintf(f, "%s(X[%u] & 0x%016llxull) == 0x%016llxull", (e > cm->entry_begin[k]) ? "\n        && " : "",
+                    (unsigned)cm->entry_word[e], p | n, p);
+            }
+            fprintf(f, ";\n");
+        }
+        fprintf(f, "\n");
+    }
+
+    fprintf(f, "    int best = 0;\n");
+    fprintf(f, "    for (int c = 1; c < %s_N_CLASSES; ++c) {\n", NAME);
+    fprintf(f, "        if (votes[c] > votes[best]) best = c;\n");
+    fprintf(f, "    }\n");
+    fprintf(f, "    if (votes_out) {\n");
+    fprintf(f, "        for (int c = 0; c < %s_N_CLASSES; ++c) votes_out[c] = votes[c];\n", NAME);
+    fprintf(f, "    }\n");
+    fprintf(f, "    return best;\n}\n\n");
+
+    fprintf(f, "int %s_predict(const int* X, int* votes_out) {\n", name);
+    fprintf(f, "    uint64_t Xp[%s_N_WORDS] = { 0 };\n", NAME);
+    fprintf(f, "    for (int i = 0; i < %s_N_FEATURES; ++i) {\n", NAME);
+    fprintf(f, "        Xp[i >> 6] |= (uint64_t)(X[i] != 0) << (i & 63);\n");
+    fprintf(f, "    }\n");
+    fprintf(f, "    return %s_predict_packed(Xp, votes_out);\n}\n", name);
+
+    return (fclose(f) == 0) ? 0 : -1;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "usage: %s MODEL OUT_BASE [NAME]\n", argv[0]);
+        return 2;
+    }
+    const char* model = argv[1];
+    const char* out_base = argv[2];
+    const char* name = (argc > 3) ? argv[3] : "tsetlin_generated";
+
+    /* Accept a compact export as well as a full model. */
+    tsetlin_compact_t* cm = tsetlin_compact_load(model);
+    if (!cm) {
+        tsetlin_t* ts = tsetlin_load(model);
+        if (!ts) {
+            fprintf(stderr, "%s: cannot read model %s\n", argv[0], model);
+            return 1;
+        }
+        cm = tsetlin_compact_new(ts);
+        tsetlin_free(ts);
+        if (!cm) {
+            fprintf(stderr, "%s: out of memory\n", argv[0]);
+            return 1;
+        }
+    }
+
+    size_t base_len = strlen(out_base);
+    char* header_path = (char*)malloc(base_len + 3);
+    char* source_path = (char*)malloc(base_len + 3);
+    if (!header_path || !source_path) return 1;
+    sprintf(header_path, "%s.h", out_base);
+    sprintf(source_path, "%s.c", out_base);
+
+    /* The source includes the header by its file name. */
+    const char* header_name = header_path;
+    for (const char* p = header_path; *p; ++p) {
+        if (*p == '/' || *p == '\\') header_name = p + 1;
+    }
+
+    int status = 0;
+    if (write_header(cm, header_path, name, model) != 0 || write_source(cm, source_path, header_name, name, model) != 0) {
+        fprintf(stderr, "%s: cannot write %s.{h,c}\n", argv[0], out_base);
+        status = 1;
+    }
+
+    free(header_path);
+    free(source_path);
+    tsetlin_compact_free(cm);
+    return status;
+}
@@ -3,11 +3,18 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+    /* Compact automaton state used by the clause storage (see clause.h).
+     * Only the state is stored; the action is derived as state > N_state / 2. */
+    typedef uint16_t automaton_state_t;
+
+#define AUTOMATON_STATE_MAX UINT16_MAX
+
     typedef struct {
         int N_state;
         int middle_state;
@@ -0,0 +1,29 @@
+#include "bitpack.h"
+
+#include <assert.h>
+#include <stddef.h>
+
+void bitpack_pack(const int* X, int n_bits, uint64_t* out) {
+    assert(X != NULL);
+    assert(out != NULL);
+
+    int n_words = BITPACK_WORDS(n_bits);
+    for (int w = 0; w < n_words; ++w) {
+        int base = w * 64;
+        int end = (base + 64 < n_bits) ? base + 64 : n_bits;
+        uint64_t word = 0;
+        for (int i = base; i < end; ++i) {
+            word |= (uint64_t)(X[i] != 0) << (i - base);
+        }
+        out[w] = word;
+    }
+}
+
+void bitpack_unpack(const uint64_t* in, int n_bits, int* X) {
+    assert(in != NULL);
+    assert(X != NULL);
+
+    for (int i = 0; i < n_bits; ++i) {
+        X[i] = bitpack_get(in, i);
+    }
+}
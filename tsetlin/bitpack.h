@@ -0,0 +1,48 @@
+#ifndef TSETLIN_BITPACK_H
+#define TSETLIN_BITPACK_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /* Number of 64-bit words needed to hold n_bits packed bits. */
+#define BITPACK_WORDS(n_bits) (((n_bits) + 63) / 64)
+
+    /* Pack X (array length n_bits, values 0 or 1) into out (BITPACK_WORDS(n_bits) words).
+     * Bit i of the input lives in bit (i % 64) of word i / 64; padding bits are cleared. */
+    void bitpack_pack(const int* X, int n_bits, uint64_t* out);
+
+    /* Unpack n_bits bits of in into X (values 0 or 1). */
+    void bitpack_unpack(const uint64_t* in, int n_bits, int* X);
+
+    static inline int bitpack_get(const uint64_t* words, int i) {
+        return (int)((words[i >> 6] >> (i & 63)) & 1u);
+    }
+
+    static inline void bitpack_set(uint64_t* words, int i) {
+        words[i >> 6] |= (uint64_t)1 << (i & 63);
+    }
+
+    static inline void bitpack_clear(uint64_t* words, int i) {
+        words[i >> 6] &= ~((uint64_t)1 << (i & 63));
+    }
+
+    /* Number of set bits in x. */
+    static inline int bitpack_popcount(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_popcountll(x);
+#else
+        x = x - ((x >> 1) & 0x5555555555555555ull);
+        x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+        x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+        return (int)((x * 0x0101010101010101ull) >> 56);
+#endif
+    }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TSETLIN_BITPACK_H */
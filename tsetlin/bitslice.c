@@ -0,0 +1,196 @@
+#include "bitslice.h"
+#include "bitpack.h"
+#include "kernel.h"
+#include "stats.h"
+
+#include <assert.h>
+#include <string.h>
+
+static int plane_count(int n_states) {
+    int b = 1;
+    while ((1 << b) < n_states) ++b;
+    return b;
+}
+
+size_t bitslice_footprint(int n_features, int n_states) {
+    return sizeof(uint64_t) * (size_t)plane_count(n_states) * 2 * BITPACK_WORDS(n_features);
+}
+
+static inline uint64_t* plane(const bitslice_t* bs, int k) {
+    return bs->planes + (size_t)k * 2 * bs->n_words;
+}
+
+/* Valid bits of word w: all but the padding of the last word of each half. */
+static inline uint64_t valid_bits(const bitslice_t* bs, int w) {
+    return (w % bs->n_words == bs->n_words - 1) ? bs->tail_mask : ~(uint64_t)0;
+}
+
+static uint32_t encode(const bitslice_t* bs, int state) {
+    return (uint32_t)(state - 1 - bs->n_states / 2 + (1 << (bs->n_planes - 1)));
+}
+
+/* Automata of word w whose encoded state equals value. */
+static inline uint64_t equals(const bitslice_t* bs, int w, uint32_t value) {
+    uint64_t eq = ~(uint64_t)0;
+    for (int k = 0; k < bs->n_planes; ++k) {
+        uint64_t bits = plane(bs, k)[w];
+        eq &= ((value >> k) & 1) ? bits : ~bits;
+    }
+    return eq;
+}
+
+/* Set every automaton of word w selected by mask to encoded value. */
+static void assign(bitslice_t* bs, int w, uint64_t mask, uint32_t value) {
+    for (int k = 0; k < bs->n_planes; ++k) {
+        uint64_t* bits = &plane(bs, k)[w];
+        *bits = ((value >> k) & 1) ? (*bits | mask) : (*bits & ~mask);
+    }
+}
+
+void bitslice_init(bitslice_t* bs, int n_features, int n_states, uint64_t* planes) {
+    assert(bs != NULL);
+    assert(planes != NULL);
+    assert(n_features > 0);
+    assert(n_states >= 2 && (n_states % 2) == 0);
+
+    bs->n_features = n_features;
+    bs->n_words = BITPACK_WORDS(n_features);
+    bs->n_states = n_states;
+    bs->n_planes = plane_count(n_states);
+    bs->planes = planes;
+    bs->tail_mask = (n_features % 64) ? ((uint64_t)1 << (n_features % 64)) - 1 : ~(uint64_t)0;
+    bs->v_min = encode(bs, 1);
+    bs->v_max = encode(bs, n_states);
+    bs->mask_precision = RNG_MASK_PRECISION;
+
+    memset(planes, 0, bitslice_footprint(n_features, n_states));
+    for (int w = 0; w < 2 * bs->n_words; ++w) assign(bs, w, valid_bits(bs, w), bs->v_min);
+}
+
+void bitslice_load(bitslice_t* bs, const clause_t* c) {
+    assert(bs != NULL && c != NULL);
+    assert(c->N_feature == bs->n_features && c->N_states == bs->n_states);
+
+    memset(bs->planes, 0, bitslice_footprint(bs->n_features, bs->n_states));
+    for (int k = 0; k < c->N_literals; ++k) {
+        int half = k / c->N_feature;
+        int i = k - half * c->N_feature;
+        int w = half * bs->n_words + (i >> 6);
+        uint64_t bit = (uint64_t)1 << (i & 63);
+        uint32_t v = encode(bs, c->p_automata[k]);
+        for (int p = 0; p < bs->n_planes; ++p) {
+            if ((v >> p) & 1) plane(bs, p)[w] |= bit;
+        }
+    }
+}
+
+int bitslice_get(const bitslice_t* bs, int literal) {
+    assert(bs != NULL);
+    assert(literal >= 0 && literal < 2 * bs->n_features);
+    int half = literal / bs->n_features;
+    int i = literal - half * bs->n_features;
+    int w = half * bs->n_words + (i >> 6);
+    uint32_t v = 0;
+    for (int p = 0; p < bs->n_planes; ++p) v |= (uint32_t)((plane(bs, p)[w] >> (i & 63)) & 1) << p;
+    return (int)v + 1 + bs->n_states / 2 - (1 << (bs->n_planes - 1));
+}
+
+void bitslice_store(const bitslice_t* bs, clause_t* c) {
+    assert(bs != NULL && c != NULL);
+    assert(c->N_feature == bs->n_features && c->N_states == bs->n_states);
+
+    for (int k = 0; k < c->N_literals; ++k) c->p_automata[k] = (automaton_state_t)bitslice_get(bs, k);
+    clause_compress(c, -1);
+}
+
+uint64_t bitslice_increment(bitslice_t* bs, int w, uint64_t mask) {
+    mask &= ~equals(bs, w, bs->v_max);
+    uint64_t carry = mask;
+    for (int k = 0; k < bs->n_planes && carry; ++k) {
+        uint64_t* bits = &plane(bs, k)[w];
+        uint64_t next = *bits & carry;
+        *bits ^= carry;
+        carry = next;
+    }
+    return mask;
+}
+
+uint64_t bitslice_decrement(bitslice_t* bs, int w, uint64_t mask) {
+    mask &= ~equals(bs, w, bs->v_min);
+    uint64_t borrow = mask;
+    for (int k = 0; k < bs->n_planes && borrow; ++k) {
+        uint64_t* bits = &plane(bs, k)[w];
+        uint64_t next = ~*bits & borrow;
+        *bits ^= borrow;
+        borrow = next;
+    }
+    return mask;
+}
+
+int bitslice_evaluate(const bitslice_t* bs, const uint64_t* X) {
+    assert(bs != NULL && X != NULL);
+    int result = kernel_evaluate(bitslice_p_include(bs), bitslice_n_include(bs), X, bs->n_words);
+    TSETLIN_STAT_ADD(evaluations, 1);
+    TSETLIN_STAT_ADD(evaluations_false, result == 0);
+    return result;
+}
+
+/* Count the automata whose action (top plane) flipped between before and after. */
+static inline void count_flips(uint64_t before, uint64_t after) {
+    TSETLIN_STAT_ADD(include_flips, bitpack_popcount(~before & after));
+    TSETLIN_STAT_ADD(exclude_flips, bitpack_popcount(before & ~after));
+    (void)before; (void)after;
+}
+
+int bitslice_update(bitslice_t* bs, const uint64_t* X, int match_target, int clause_output, double s, rng_t* rng) {
+    assert(bs != NULL);
+    assert(X != NULL);
+    assert(rng != NULL);
+
+    int n_words = bs->n_words;
+    uint64_t* top = plane(bs, bs->n_planes - 1);
+    int feedback_count = 0;
+
+    if (match_target != 1) {
+        /* Type II: excluded literals that are false under X move towards include. */
+        if (clause_output != 1) return 0;
+        for (int w = 0; w < n_words; ++w) {
+            uint64_t x = X[w];
+            uint64_t valid = valid_bits(bs, w);
+            uint64_t p_before = top[w], n_before = top[n_words + w];
+            feedback_count += bitpack_popcount(bitslice_increment(bs, w, ~x & ~p_before & valid));
+            feedback_count += bitpack_popcount(bitslice_increment(bs, n_words + w, x & ~n_before & valid));
+            count_flips(p_before, top[w]);
+            count_flips(n_before, top[n_words + w]);
+        }
+        return feedback_count;
+    }
+
+    if (!(s > 0.0)) return 0; /* no Type I events, as clause_update_packed */
+    uint64_t s1 = rng_threshold(1.0 / s);
+
+    for (int w = 0; w < n_words; ++w) {
+        uint64_t x = X[w];
+        uint64_t valid = valid_bits(bs, w);
+        uint64_t p_before = top[w], n_before = top[n_words + w];
+        uint64_t p_events = rng_mask(rng, s1, bs->mask_precision) & valid;
+        uint64_t n_events = rng_mask(rng, s1, bs->mask_precision) & valid;
+
+        if (clause_output == 0) {
+            /* Erase: every literal is penalized with probability 1/s. */
+            feedback_count += bitpack_popcount(bitslice_decrement(bs, w, p_events));
+            feedback_count += bitpack_popcount(bitslice_decrement(bs, n_words + w, n_events));
+        }
+        else {
+            /* Recognize: a true literal is rewarded unless its 1/s event fires (probability
+             * (s-1)/s), a false one is penalized when it fires. */
+            feedback_count += bitpack_popcount(bitslice_increment(bs, w, x & ~p_events & valid));
+            feedback_count += bitpack_popcount(bitslice_decrement(bs, w, ~x & p_events));
+            feedback_count += bitpack_popcount(bitslice_increment(bs, n_words + w, ~x & ~n_events & valid));
+            feedback_count += bitpack_popcount(bitslice_decrement(bs, n_words + w, x & n_events));
+        }
+        count_flips(p_before, top[w]);
+        count_flips(n_before, top[n_words + w]);
+    }
+    return feedback_count;
+}
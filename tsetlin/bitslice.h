@@ -0,0 +1,85 @@
+#ifndef TSETLIN_BITSLICE_H
+#define TSETLIN_BITSLICE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "clause.h"
+#include "rng.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /*
+     * Bit-sliced automaton states of one clause: plane k holds bit k of the states of all 2 * N
+     * literals, 64 automata per word, so reward and penalty are ripple-carry increment and decrement
+     * of 64 automata at once. A state s in [1, n_states] is stored as s - 1 - n_states / 2 +
+     * 2^(n_planes - 1): the top plane is then the action, and doubles as the include mask.
+     *
+     * This is a training-time layout (CLAUSE_SAMPLING_BITSLICED): tsetlin_fit_parallel loads the
+     * clauses into it, trains, and stores the states back, so clause_t and the file formats keep
+     * one state per literal.
+     */
+    typedef struct {
+        int n_features;
+        int n_words;        /* BITPACK_WORDS(n_features) words per literal half */
+        int n_states;
+        int n_planes;       /* ceil(log2(n_states)) */
+        uint32_t v_min;     /* encoding of state 1 */
+        uint32_t v_max;     /* encoding of state n_states */
+        uint64_t tail_mask; /* valid bits of the last word of each half */
+        int mask_precision; /* rng_mask precision of the Type I events, RNG_MASK_PRECISION by default */
+
+        /* n_planes planes of 2 * n_words words: X_i automata in the first n_words, NOT X_i after.
+         * Padding bits stay 0. */
+        uint64_t* planes;
+    } bitslice_t;
+
+    /* Bytes of planes for a clause of n_features features and n_states states. */
+    size_t bitslice_footprint(int n_features, int n_states);
+
+    /* Set up bs over planes (bitslice_footprint bytes, owned by the caller) with every automaton at
+     * state 1. */
+    void bitslice_init(bitslice_t* bs, int n_features, int n_states, uint64_t* planes);
+
+    /* Copy the states of c into bs, or back from bs into c (its masks and lists are rebuilt, and
+     * its trainable lists cleared as by clause_compress(c, -1)). Same n_features and n_states. */
+    void bitslice_load(bitslice_t* bs, const clause_t* c);
+    void bitslice_store(const bitslice_t* bs, clause_t* c);
+
+    /* State of literal k, same layout as clause_get_automaton. */
+    int bitslice_get(const bitslice_t* bs, int literal);
+
+    /* Include mask words: bit i of word w is set when literal 64 * w + i of the half is included. */
+    static inline const uint64_t* bitslice_p_include(const bitslice_t* bs) {
+        return bs->planes + (size_t)(bs->n_planes - 1) * 2 * bs->n_words;
+    }
+
+    static inline const uint64_t* bitslice_n_include(const bitslice_t* bs) {
+        return bitslice_p_include(bs) + bs->n_words;
+    }
+
+    /* Reward (+1) / penalize (-1) the automata of word w (0 .. 2 * n_words - 1) selected by mask,
+     * saturating at n_states / 1: the automata already there are left out. Returns the mask of
+     * automata changed. */
+    uint64_t bitslice_increment(bitslice_t* bs, int w, uint64_t mask);
+    uint64_t bitslice_decrement(bitslice_t* bs, int w, uint64_t mask);
+
+    /* Same as clause_evaluate_packed on the clause the states came from. */
+    int bitslice_evaluate(const bitslice_t* bs, const uint64_t* X);
+
+    /*
+     * Same dynamics as clause_update_packed without threshold, a word of 64 automata at a time.
+     * Type II is deterministic given X and the actions, and gives the same states as
+     * clause_update_packed. Type I selects its probability-1/s events with rng_mask, one mask per word
+     * and literal half; the (s-1)/s rewards of true literals are the complement of the same mask.
+     * Returns the number of automata feedback events.
+     */
+    int bitslice_update(bitslice_t* bs, const uint64_t* X, int match_target, int clause_output, double s, rng_t* rng);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TSETLIN_BITSLICE_H */
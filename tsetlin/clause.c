@@ -1,144 +1,231 @@
 #include "clause.h"
+#include "bitpack.h"
+#include "kernel.h"
+#include "rng.h"
+#include "stats.h"
 
 #include <assert.h>
+#include <math.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
-
-/* Helper: append index to dynamic int array, resizing as needed. */
-static void append_idx(int** arr, int* count, int idx) {
-    int new_count = (*count) + 1;
-    int* tmp = (int*)realloc(*arr, sizeof(int) * new_count);
-    if (!tmp) return; /* allocation failure: silently ignore (best-effort) */
-    tmp[new_count - 1] = idx;
-    *arr = tmp;
-    *count = new_count;
-}
-
-/* Helper: remove index from list if present. Order of remaining elements preserved. */
-static void remove_idx(int** arr, int* count, int idx) {
-    if (!*arr || *count == 0) return;
-    int found = -1;
-    for (int i = 0; i < *count; ++i) {
-        if ((*arr)[i] == idx) { found = i; break; }
-    }
-    if (found < 0) return;
-    for (int i = found; i < (*count) - 1; ++i) {
-        (*arr)[i] = (*arr)[i + 1];
-    }
-    --(*count);
-    if (*count == 0) {
-        free(*arr);
-        *arr = NULL;
-    }
-    else {
-        int* tmp = (int*)realloc(*arr, sizeof(int) * (*count));
-        if (tmp) *arr = tmp;
-    }
+
+/* Helpers for compact automaton states; action is derived as state > middle_state.
+ * Reward/penalty return true when the action flips. */
+static inline int state_action(automaton_state_t state, int middle_state) {
+    return (state > middle_state) ? 1 : 0;
 }
 
-clause_t* clause_new(int N_feature, int N_states) {
-    assert((N_states % 2) == 0);
+static inline bool state_reward(automaton_state_t* state, int middle_state) {
+    *state += 1;
+    return *state == middle_state + 1;
+}
 
-    clause_t* c = (clause_t*)calloc(1, sizeof(clause_t));
-    if (!c) return NULL;
+static inline bool state_penalty(automaton_state_t* state, int middle_state) {
+    *state -= 1;
+    return *state == middle_state;
+}
+
+/* Included lists are dense and unordered with capacity N_feature; pos[i] is the slot of feature i
+ * (-1 when absent), so insert and remove are O(1) swaps and never allocate. */
+static inline void list_insert(int* idxs, int* count, int* pos, int i) {
+    pos[i] = *count;
+    idxs[(*count)++] = i;
+}
+
+static inline void list_remove(int* idxs, int* count, int* pos, int i) {
+    int at = pos[i];
+    int last = idxs[--(*count)];
+    idxs[at] = last;
+    pos[last] = at;
+    pos[i] = -1;
+}
+
+/* Keep the masks and included lists exact when an automaton of feature i crosses the middle state. */
+static inline void include_p(clause_t* c, int i) {
+    TSETLIN_STAT_ADD(include_flips, 1);
+    bitpack_set(c->p_include_mask, i);
+    list_insert(c->p_included_idxs, &c->p_included_count, c->p_included_pos, i);
+}
+
+static inline void exclude_p(clause_t* c, int i) {
+    TSETLIN_STAT_ADD(exclude_flips, 1);
+    bitpack_clear(c->p_include_mask, i);
+    list_remove(c->p_included_idxs, &c->p_included_count, c->p_included_pos, i);
+}
+
+static inline void include_n(clause_t* c, int i) {
+    TSETLIN_STAT_ADD(include_flips, 1);
+    bitpack_set(c->n_include_mask, i);
+    list_insert(c->n_included_idxs, &c->n_included_count, c->n_included_pos, i);
+}
 
+static inline void exclude_n(clause_t* c, int i) {
+    TSETLIN_STAT_ADD(exclude_flips, 1);
+    bitpack_clear(c->n_include_mask, i);
+    list_remove(c->n_included_idxs, &c->n_included_count, c->n_included_pos, i);
+}
+
+#define CLAUSE_ALIGN 64 /* every array of the clause block starts on a cache line */
+
+static size_t align_up(size_t n) {
+    return (n + CLAUSE_ALIGN - 1) & ~(size_t)(CLAUSE_ALIGN - 1);
+}
+
+size_t clause_footprint(int N_feature) {
+    size_t n = (size_t)(N_feature > 0 ? N_feature : 1);
+    return align_up(sizeof(uint64_t) * 2 * (size_t)BITPACK_WORDS(N_feature))
+        + align_up(sizeof(automaton_state_t) * 2 * n)
+        + align_up(sizeof(int) * 6 * n);
+}
+
+void clause_init(clause_t* c, int N_feature, int N_states, void* mem, rng_t* rng) {
+    assert(c != NULL);
+    assert(mem != NULL);
+    assert((N_states % 2) == 0);
+    assert(N_states <= AUTOMATON_STATE_MAX);
+    assert(rng != NULL);
+
+    memset(c, 0, sizeof(clause_t));
     c->N_feature = N_feature;
     c->N_states = N_states;
     c->N_literals = 2 * N_feature;
+    c->N_words = BITPACK_WORDS(N_feature);
 
-    c->p_automata = (automaton_t**)calloc(N_feature, sizeof(automaton_t*));
-    c->n_automata = (automaton_t**)calloc(N_feature, sizeof(automaton_t*));
-    if (!c->p_automata || !c->n_automata) {
-        clause_free(c);
-        return NULL;
-    }
+    size_t n = (size_t)(N_feature > 0 ? N_feature : 1);
+    unsigned char* p = (unsigned char*)mem;
+    memset(p, 0, clause_footprint(N_feature));
 
-    /* Create automata; initialize with state = -1 as in Python. */
-    for (int i = 0; i < N_feature; ++i) {
-        c->p_automata[i] = automaton_new(N_states, -1);
-        c->n_automata[i] = automaton_new(N_states, -1);
-        if (!c->p_automata[i] || !c->n_automata[i]) {
-            clause_free(c);
-            return NULL;
-        }
-    }
+    /* Include masks, then the states (positive automata first, then negated ones), then the
+     * included lists, their positions and the trainable lists, N_feature ints each. */
+    c->p_include_mask = (uint64_t*)p;
+    c->n_include_mask = c->p_include_mask + c->N_words;
+    p += align_up(sizeof(uint64_t) * 2 * (size_t)c->N_words);
+
+    c->p_automata = (automaton_state_t*)p;
+    c->n_automata = c->p_automata + N_feature;
+    p += align_up(sizeof(automaton_state_t) * 2 * n);
+
+    c->p_included_idxs = (int*)p;
+    c->n_included_idxs = c->p_included_idxs + N_feature;
+    c->p_included_pos = c->n_included_idxs + N_feature;
+    c->n_included_pos = c->p_included_pos + N_feature;
+    c->p_trainable_idxs = c->n_included_pos + N_feature;
+    c->n_trainable_idxs = c->p_trainable_idxs + N_feature;
 
     /* Randomly initialise automata states: middle_state + {0,1} and complementary. */
-    /* Do not reseed global RNG here; use rand() as-is. */
     for (int i = 0; i < N_feature; ++i) {
-        int choice = rand() % 2; /* 0 or 1 */
-        c->p_automata[i]->state = (N_states / 2) + choice;
-        c->n_automata[i]->state = (N_states / 2) + (1 - choice);
-        automaton_update(c->p_automata[i]);
-        automaton_update(c->n_automata[i]);
+        int choice = rng_below(rng, 2); /* 0 or 1 */
+        c->p_automata[i] = (automaton_state_t)((N_states / 2) + choice);
+        c->n_automata[i] = (automaton_state_t)((N_states / 2) + (1 - choice));
     }
 
     /* initial compress (no threshold) */
     clause_compress(c, -1);
+}
+
+clause_t* clause_new(int N_feature, int N_states, rng_t* rng) {
+    clause_t* c = (clause_t*)malloc(sizeof(clause_t));
+    if (!c) return NULL;
 
+    void* block = malloc(clause_footprint(N_feature));
+    if (!block) {
+        free(c);
+        return NULL;
+    }
+
+    clause_init(c, N_feature, N_states, block, rng);
+    c->block = block;
     return c;
 }
 
 void clause_free(clause_t* c) {
     if (!c) return;
-    if (c->p_automata) {
-        for (int i = 0; i < c->N_feature; ++i) {
-            automaton_free(c->p_automata[i]);
-        }
-        free(c->p_automata);
+    free(c->block); /* states, masks and index lists */
+    free(c);
+}
+
+static inline int is_absorbed(const clause_t* c, automaton_state_t state) {
+    return state <= 1 || state >= c->N_states;
+}
+
+static inline int is_trainable(const clause_t* c, automaton_state_t state, int threshold) {
+    if (c->absorbing && is_absorbed(c, state)) return 0;
+    return threshold < 0 || abs(state - c->N_states / 2) <= threshold;
+}
+
+/* Rebuild the trainable lists: automata within threshold of the middle state (any state without
+ * threshold), less the absorbed ones in absorbing mode. */
+static void rebuild_trainable(clause_t* c, int threshold) {
+    c->p_trainable_count = 0;
+    c->n_trainable_count = 0;
+    c->trainable_threshold = (threshold < 0) ? -1 : threshold;
+    if (threshold < 0 && !c->absorbing) return;
+
+    for (int i = 0; i < c->N_feature; ++i) {
+        if (is_trainable(c, c->p_automata[i], threshold)) c->p_trainable_idxs[c->p_trainable_count++] = i;
+        if (is_trainable(c, c->n_automata[i], threshold)) c->n_trainable_idxs[c->n_trainable_count++] = i;
     }
-    if (c->n_automata) {
-        for (int i = 0; i < c->N_feature; ++i) {
-            automaton_free(c->n_automata[i]);
-        }
-        free(c->n_automata);
+}
+
+/* Drop the automata an update moved out of the band or absorbed from a trainable list, in
+ * O(list length), keeping its order. */
+static int drop_untrainable(const clause_t* c, const automaton_state_t* states, int* idxs, int count, int threshold) {
+    int kept = 0;
+    for (int ii = 0; ii < count; ++ii) {
+        if (is_trainable(c, states[idxs[ii]], threshold)) idxs[kept++] = idxs[ii];
     }
+    return kept;
+}
 
-    free(c->p_included_idxs);
-    free(c->n_included_idxs);
-    free(c->p_trainable_idxs);
-    free(c->n_trainable_idxs);
-    free(c);
+/* Before an update: lists built for another threshold (or none) are rebuilt once. */
+static void prepare_trainable(clause_t* c, int threshold) {
+    if ((threshold >= 0 || c->absorbing) && c->trainable_threshold != (threshold < 0 ? -1 : threshold)) {
+        rebuild_trainable(c, threshold);
+    }
+}
+
+#define TRAINABLE_STALE (-2) /* trainable_threshold after an update that moved unlisted automata */
+
+/* After an update: only listed automata moved, so the lists just lose the ones that left. An update
+ * without lists may have moved any automaton, so lists kept for a threshold must be rebuilt. */
+static void refresh_trainable(clause_t* c, int threshold) {
+    if (threshold < 0 && !c->absorbing) {
+        c->trainable_threshold = TRAINABLE_STALE;
+        return;
+    }
+    c->p_trainable_count = drop_untrainable(c, c->p_automata, c->p_trainable_idxs, c->p_trainable_count, threshold);
+    c->n_trainable_count = drop_untrainable(c, c->n_automata, c->n_trainable_idxs, c->n_trainable_count, threshold);
+}
+
+void clause_set_absorbing(clause_t* c, int absorbing) {
+    assert(c != NULL);
+    c->absorbing = absorbing ? 1 : 0;
+    rebuild_trainable(c, -1);
+}
+
+int clause_live_count(const clause_t* c) {
+    assert(c != NULL);
+    int live = 0;
+    for (int k = 0; k < c->N_literals; ++k) live += !is_absorbed(c, c->p_automata[k]);
+    return live;
 }
 
 void clause_compress(clause_t* c, int threshold) {
     if (!c) return;
+    int middle = c->N_states / 2;
 
-    /* Clear current lists */
-    free(c->p_included_idxs);
-    c->p_included_idxs = NULL;
+    memset(c->p_include_mask, 0, sizeof(uint64_t) * 2 * (size_t)c->N_words);
     c->p_included_count = 0;
-
-    free(c->n_included_idxs);
-    c->n_included_idxs = NULL;
     c->n_included_count = 0;
 
-    free(c->p_trainable_idxs);
-    c->p_trainable_idxs = NULL;
-    c->p_trainable_count = 0;
-
-    free(c->n_trainable_idxs);
-    c->n_trainable_idxs = NULL;
-    c->n_trainable_count = 0;
-
     for (int i = 0; i < c->N_feature; ++i) {
-        if (automaton_action(c->p_automata[i]) == 1) {
-            append_idx(&c->p_included_idxs, &c->p_included_count, i);
-        }
-        if (automaton_action(c->n_automata[i]) == 1) {
-            append_idx(&c->n_included_idxs, &c->n_included_count, i);
-        }
-
-        if (threshold > 0) {
-            if (abs(c->p_automata[i]->state - (c->N_states / 2)) <= threshold) {
-                append_idx(&c->p_trainable_idxs, &c->p_trainable_count, i);
-            }
-            if (abs(c->n_automata[i]->state - (c->N_states / 2)) <= threshold) {
-                append_idx(&c->n_trainable_idxs, &c->n_trainable_count, i);
-            }
-        }
+        c->p_included_pos[i] = -1;
+        c->n_included_pos[i] = -1;
+        if (state_action(c->p_automata[i], middle) == 1) include_p(c, i);
+        if (state_action(c->n_automata[i], middle) == 1) include_n(c, i);
     }
+
+    rebuild_trainable(c, threshold);
 }
 
 int clause_evaluate(const clause_t* c, const int* X) {
@@ -155,64 +242,96 @@ int clause_evaluate(const clause_t* c, const int* X) {
     return 1;
 }
 
-/* Helper to test membership quickly (search included idx lists). */
-static bool is_included(int* idxs, int count, int idx) {
-    for (int i = 0; i < count; ++i) if (idxs[i] == idx) return true;
-    return false;
+#ifdef TSETLIN_STATS
+/* Count an evaluation and its early-exit depth: the words up to and including the first one
+ * with a violated literal (all of them when none is). */
+static void count_evaluation(const clause_t* c, const uint64_t* X, int result) {
+    int depth = c->N_words;
+    for (int w = 0; w < c->N_words; ++w) {
+        if ((c->p_include_mask[w] & ~X[w]) | (c->n_include_mask[w] & X[w])) {
+            depth = w + 1;
+            break;
+        }
+    }
+    tsetlin_stats_t* s = tsetlin_stats_counters();
+    s->evaluations++;
+    s->evaluations_false += (result == 0);
+    s->evaluation_words += (uint64_t)depth;
+}
+#endif
+
+int clause_evaluate_packed(const clause_t* c, const uint64_t* X) {
+    if (!c || !X) return 0;
+
+    int result = kernel_evaluate(c->p_include_mask, c->n_include_mask, X, c->N_words);
+#ifdef TSETLIN_STATS
+    count_evaluation(c, X, result);
+#endif
+    return result;
+}
+
+int clause_evaluate_sparse(const clause_t* c, const sparse_sample_t* X) {
+    if (!c || !X) return 0;
+
+    int hits = 0;
+    for (int k = 0; k < X->n_active; ++k) {
+        int i = X->active[k];
+        uint64_t bit = (uint64_t)1 << (i & 63);
+        if (c->n_include_mask[i >> 6] & bit) return 0;
+        if (c->p_include_mask[i >> 6] & bit) ++hits;
+    }
+    return hits == c->p_included_count;
 }
 
-int clause_update(clause_t* c, const int* X, int match_target, int clause_output, double s, int threshold) {
+int clause_update_packed(clause_t* c, const uint64_t* X, int match_target, int clause_output, double s, int threshold, rng_t* rng) {
     assert(c != NULL);
     assert(X != NULL);
+    assert(rng != NULL);
     int feedback_count = 0;
+    int middle = c->N_states / 2;
+    int use_lists = (threshold >= 0) || c->absorbing; /* walk the trainable lists, not every feature */
+    prepare_trainable(c, threshold);
 
-    double s1 = 0.0, s2 = 0.0;
+    /* Bernoulli thresholds for p = 1/s and (s-1)/s, see rng_threshold. */
+    uint64_t s1 = 0, s2 = 0;
     if (s > 0.0) {
-        s1 = 1.0 / s;
-        s2 = (s - 1.0) / s;
+        s1 = rng_threshold(1.0 / s);
+        s2 = rng_threshold((s - 1.0) / s);
     }
 
     /* Type I feedback (match_target == 1) */
     if (match_target == 1) {
         /* Erase Pattern: reduce included literals when clause_output == 0 */
         if (clause_output == 0) {
-            if (threshold < 0) {
+            if (!use_lists) {
                 for (int i = 0; i < c->N_feature; ++i) {
                     /* Positive automaton */
-                    if (c->p_automata[i]->state > 1 && ((double)rand() / RAND_MAX) <= s1) {
+                    if (c->p_automata[i] > 1 && rng_bernoulli(rng, s1)) {
                         feedback_count++;
-                        if (automaton_penalty(c->p_automata[i]) && is_included(c->p_included_idxs, c->p_included_count, i)) {
-                            remove_idx(&c->p_included_idxs, &c->p_included_count, i);
-                        }
+                        if (state_penalty(&c->p_automata[i], middle)) exclude_p(c, i);
                     }
 
                     /* Negative automaton */
-                    if (c->n_automata[i]->state > 1 && ((double)rand() / RAND_MAX) <= s1) {
+                    if (c->n_automata[i] > 1 && rng_bernoulli(rng, s1)) {
                         feedback_count++;
-                        if (automaton_penalty(c->n_automata[i]) && is_included(c->n_included_idxs, c->n_included_count, i)) {
-                            remove_idx(&c->n_included_idxs, &c->n_included_count, i);
-                        }
+                        if (state_penalty(&c->n_automata[i], middle)) exclude_n(c, i);
                     }
                 }
             }
             else {
-                /* thresholded: only trainable lists */
+                /* thresholded or absorbing: only trainable lists */
                 for (int ii = 0; ii < c->p_trainable_count; ++ii) {
                     int i = c->p_trainable_idxs[ii];
-                    if (c->p_automata[i]->state > 1 && ((double)rand() / RAND_MAX) <= s1) {
+                    if (c->p_automata[i] > 1 && rng_bernoulli(rng, s1)) {
                         feedback_count++;
-                        if (automaton_penalty(c->p_automata[i]) && is_included(c->p_included_idxs, c->p_included_count, i)) {
-                            remove_idx(&c->p_included_idxs, &c->p_included_count, i);
-                        }
+                        if (state_penalty(&c->p_automata[i], middle)) exclude_p(c, i);
                     }
                 }
                 for (int ii = 0; ii < c->n_trainable_count; ++ii) {
                     int i = c->n_trainable_idxs[ii];
-                    if (c->n_automata[i]->state > 1 && ((double)rand() / RAND_MAX) <= s1) {
+                    if (c->n_automata[i] > 1 && rng_bernoulli(rng, s1)) {
                         feedback_count++;
-                        if (automaton_penalty(c->n_automata[i]) && is_included(c->n_included_idxs, c->n_included_count, i)) {
-                            remove_idx(&c->n_included_idxs, &c->n_included_count, i);
-                        }
+                        if (state_penalty(&c->n_automata[i], middle)) exclude_n(c, i);
                     }
                 }
             }
@@ -220,38 +339,30 @@ int clause_update(clause_t* c, const int* X, int match_target, int clause_output
 
         /* Recognize Pattern: increase included literals when clause_output == 1 */
         if (clause_output == 1) {
-            if (threshold < 0) {
+            if (!use_lists) {
                 for (int i = 0; i < c->N_feature; ++i) {
-                    if (X[i] == 1) {
+                    if (bitpack_get(X, i) == 1) {
                         /* Positive literal X */
-                        if (c->p_automata[i]->state < c->N_states && ((double)rand() / RAND_MAX) <= s2) {
+                        if (c->p_automata[i] < c->N_states && rng_bernoulli(rng, s2)) {
                             feedback_count++;
-                            if (automaton_reward(c->p_automata[i]) && !is_included(c->p_included_idxs, c->p_included_count, i)) {
-                                append_idx(&c->p_included_idxs, &c->p_included_count, i);
-                            }
+                            if (state_reward(&c->p_automata[i], middle)) include_p(c, i);
                         }
                         /* Negative automaton: penalize to remove NOT X */
-                        if (c->n_automata[i]->state > 1 && ((double)rand() / RAND_MAX) <= s1) {
+                        if (c->n_automata[i] > 1 && rng_bernoulli(rng, s1)) {
                             feedback_count++;
-                            if (automaton_penalty(c->n_automata[i]) && is_included(c->n_included_idxs, c->n_included_count, i)) {
-                                remove_idx(&c->n_included_idxs, &c->n_included_count, i);
-                            }
+                            if (state_penalty(&c->n_automata[i], middle)) exclude_n(c, i);
                         }
                     }
                     else { /* X[i] == 0 */
                         /* Negative literal NOT X */
-                        if (c->n_automata[i]->state < c->N_states && ((double)rand() / RAND_MAX) <= s2) {
+                        if (c->n_automata[i] < c->N_states && rng_bernoulli(rng, s2)) {
                             feedback_count++;
-                            if (automaton_reward(c->n_automata[i]) && !is_included(c->n_included_idxs, c->n_included_count, i)) {
-                                append_idx(&c->n_included_idxs, &c->n_included_count, i);
-                            }
+                            if (state_reward(&c->n_automata[i], middle)) include_n(c, i);
                         }
                         /* Positive automaton: penalize to remove X */
-                        if (c->p_automata[i]->state > 1 && ((double)rand() / RAND_MAX) <= s1) {
+                        if (c->p_automata[i] > 1 && rng_bernoulli(rng, s1)) {
                             feedback_count++;
-                            if (automaton_penalty(c->p_automata[i]) && is_included(c->p_included_idxs, c->p_included_count, i)) {
-                                remove_idx(&c->p_included_idxs, &c->p_included_count, i);
-                            }
+                            if (state_penalty(&c->p_automata[i], middle)) exclude_p(c, i);
                         }
                     }
                 }
@@ -260,40 +371,32 @@ int clause_update(clause_t* c, const int* X, int match_target, int clause_output
                 /* thresholded operations */
                 for (int ii = 0; ii < c->p_trainable_count; ++ii) {
                     int i = c->p_trainable_idxs[ii];
-                    if (X[i] == 1) {
-                        if (c->p_automata[i]->state < c->N_states && ((double)rand() / RAND_MAX) <= s2) {
+                    if (bitpack_get(X, i) == 1) {
+                        if (c->p_automata[i] < c->N_states && rng_bernoulli(rng, s2)) {
                             feedback_count++;
-                            if (automaton_reward(c->p_automata[i]) && !is_included(c->p_included_idxs, c->p_included_count, i)) {
-                                append_idx(&c->p_included_idxs, &c->p_included_count, i);
-                            }
+                            if (state_reward(&c->p_automata[i], middle)) include_p(c, i);
                         }
                     }
                     else {
-                        if (c->p_automata[i]->state > 1 && ((double)rand() / RAND_MAX) <= s1) {
+                        if (c->p_automata[i] > 1 && rng_bernoulli(rng, s1)) {
                             feedback_count++;
-                            if (automaton_penalty(c->p_automata[i]) && is_included(c->p_included_idxs, c->p_included_count, i)) {
-                                remove_idx(&c->p_included_idxs, &c->p_included_count, i);
-                            }
+                            if (state_penalty(&c->p_automata[i], middle)) exclude_p(c, i);
                         }
                     }
                 }
 
                 for (int ii = 0; ii < c->n_trainable_count; ++ii) {
                     int i = c->n_trainable_idxs[ii];
-                    if (X[i] == 1) {
-                        if (c->n_automata[i]->state > 1 && ((double)rand() / RAND_MAX) <= s1) {
+                    if (bitpack_get(X, i) == 1) {
+                        if (c->n_automata[i] > 1 && rng_bernoulli(rng, s1)) {
                             feedback_count++;
-                            if (automaton_penalty(c->n_automata[i]) && is_included(c->n_included_idxs, c->n_included_count, i)) {
-                                remove_idx(&c->n_included_idxs, &c->n_included_count, i);
-                            }
+                            if (state_penalty(&c->n_automata[i], middle)) exclude_n(c, i);
                         }
                     }
                     else {
-                        if (c->n_automata[i]->state < c->N_states && ((double)rand() / RAND_MAX) <= s2) {
+                        if (c->n_automata[i] < c->N_states && rng_bernoulli(rng, s2)) {
                             feedback_count++;
-                            if (automaton_reward(c->n_automata[i]) && !is_included(c->n_included_idxs, c->n_included_count, i)) {
-                                append_idx(&c->n_included_idxs, &c->n_included_count, i);
-                            }
+                            if (state_reward(&c->n_automata[i], middle)) include_n(c, i);
                         }
                     }
                 }
@@ -303,49 +406,156 @@ int clause_update(clause_t* c, const int* X, int match_target, int clause_output
     /* Type II feedback (match_target == 0) */
     else {
         if (clause_output == 1) {
-            if (threshold < 0) {
+            if (!use_lists) {
                 for (int i = 0; i < c->N_feature; ++i) {
-                    if ((X[i] == 0) && (automaton_action(c->p_automata[i]) == 0)) {
+                    if ((bitpack_get(X, i) == 0) && (state_action(c->p_automata[i], middle) == 0)) {
                         feedback_count++;
-                        if (automaton_reward(c->p_automata[i]) && !is_included(c->p_included_idxs, c->p_included_count, i)) {
-                            append_idx(&c->p_included_idxs, &c->p_included_count, i);
-                        }
+                        if (state_reward(&c->p_automata[i], middle)) include_p(c, i);
                     }
-                    else if ((X[i] == 1) && (automaton_action(c->n_automata[i]) == 0)) {
+                    else if ((bitpack_get(X, i) == 1) && (state_action(c->n_automata[i], middle) == 0)) {
                         feedback_count++;
-                        if (automaton_reward(c->n_automata[i]) && !is_included(c->n_included_idxs, c->n_included_count, i)) {
-                            append_idx(&c->n_included_idxs, &c->n_included_count, i);
-                        }
+                        if (state_reward(&c->n_automata[i], middle)) include_n(c, i);
                     }
                 }
             }
             else {
                 for (int ii = 0; ii < c->p_trainable_count; ++ii) {
                     int i = c->p_trainable_idxs[ii];
-                    if ((X[i] == 0) && (automaton_action(c->p_automata[i]) == 0)) {
+                    if ((bitpack_get(X, i) == 0) && (state_action(c->p_automata[i], middle) == 0)) {
                         feedback_count++;
-                        if (automaton_reward(c->p_automata[i]) && !is_included(c->p_included_idxs, c->p_included_count, i)) {
-                            append_idx(&c->p_included_idxs, &c->p_included_count, i);
-                        }
+                        if (state_reward(&c->p_automata[i], middle)) include_p(c, i);
                     }
                 }
                 for (int ii = 0; ii < c->n_trainable_count; ++ii) {
                     int i = c->n_trainable_idxs[ii];
-                    if ((X[i] == 1) && (automaton_action(c->n_automata[i]) == 0)) {
+                    if ((bitpack_get(X, i) == 1) && (state_action(c->n_automata[i], middle) == 0)) {
                         feedback_count++;
-                        if (automaton_reward(c->n_automata[i]) && !is_included(c->n_included_idxs, c->n_included_count, i)) {
-                            append_idx(&c->n_included_idxs, &c->n_included_count, i);
-                        }
+                        if (state_reward(&c->n_automata[i], middle)) include_n(c, i);
                     }
                 }
             }
         }
     }
 
-    /* After updates, automata action fields are maintained by automaton functions.
-     * Rebuild compress lists if threshold parameter used or to keep lists current.
-     */
-    clause_compress(c, threshold);
+    /* Masks and included lists were kept exact above; only the trainable lists need a refresh. */
+    refresh_trainable(c, threshold);
+    return feedback_count;
+}
+
+/* Penalty / reward on literal k (state-block layout: X_k for k < N_feature, NOT X_(k - N_feature) after),
+ * with the same bounds as clause_update_packed. Returns 1 when the automaton received feedback. */
+static int literal_penalty(clause_t* c, int k, int middle) {
+    automaton_state_t* state = &c->p_automata[k];
+    if (*state <= 1) return 0;
+    if (state_penalty(state, middle)) {
+        if (k < c->N_feature) exclude_p(c, k);
+        else exclude_n(c, k - c->N_feature);
+    }
+    return 1;
+}
+
+static int literal_reward(clause_t* c, int k, int middle) {
+    automaton_state_t* state = &c->p_automata[k];
+    if (*state >= c->N_states) return 0;
+    if (state_reward(state, middle)) {
+        if (k < c->N_feature) include_p(c, k);
+        else include_n(c, k - c->N_feature);
+    }
+    return 1;
+}
+
+/*
+ * Type I feedback over one trainable list (offset 0 for p_trainable_idxs, N_feature for n_trainable_idxs).
+ * Recognize: each entry gets exactly one draw, reward when the literal is true under X (probability
+ * (s-1)/s) or penalty when it is false (probability 1/s); one 1/s process with gaps log_q decides
+ * both: an event penalizes a false literal and withholds the reward of a true one.
+ */
+static int trainable_type1(clause_t* c, const int* idxs, int count, int offset, const uint64_t* X, int recognize,
+    double log_q, int middle, rng_t* rng) {
+    int feedback_count = 0;
+    int next = rng_geometric(rng, log_q, count);
+    if (!recognize) {
+        for (; next < count; next += 1 + rng_geometric(rng, log_q, count)) {
+            feedback_count += literal_penalty(c, offset + idxs[next], middle);
+        }
+        return feedback_count;
+    }
+
+    for (int ii = 0; ii < count; ++ii) {
+        int fired = (ii == next);
+        if (fired) next += 1 + rng_geometric(rng, log_q, count);
+
+        int i = idxs[ii];
+        int literal_true = (bitpack_get(X, i) == (offset == 0 ? 1 : 0));
+        if (literal_true && !fired) feedback_count += literal_reward(c, offset + i, middle);
+        else if (!literal_true && fired) feedback_count += literal_penalty(c, offset + i, middle);
+    }
+    return feedback_count;
+}
+
+int clause_update_geometric(clause_t* c, const uint64_t* X, int match_target, int clause_output, double s, int threshold, rng_t* rng) {
+    assert(c != NULL);
+    assert(X != NULL);
+    assert(rng != NULL);
+
+    /* Type II feedback draws nothing, and s <= 0 disables Type I draws altogether. */
+    if (match_target != 1 || !(s > 0.0)) {
+        return clause_update_packed(c, X, match_target, clause_output, s, threshold, rng);
+    }
+
+    int feedback_count = 0;
+    int middle = c->N_states / 2;
+    int N = c->N_feature;
+    double log_q = log1p(-1.0 / s); /* gaps between events of probability 1/s */
+    prepare_trainable(c, threshold);
+
+    if (threshold >= 0 || c->absorbing) {
+        feedback_count += trainable_type1(c, c->p_trainable_idxs, c->p_trainable_count, 0, X, clause_output, log_q, middle, rng);
+        feedback_count += trainable_type1(c, c->n_trainable_idxs, c->n_trainable_count, N, X, clause_output, log_q, middle, rng);
+    }
+    else if (clause_output == 0) {
+        /* Erase Pattern: every literal is penalized with probability 1/s. */
+        int L = c->N_literals;
+        for (int k = rng_geometric(rng, log_q, L); k < L; k += 1 + rng_geometric(rng, log_q, L)) {
+            feedback_count += literal_penalty(c, k, middle);
+        }
+    }
+    else {
+        /* Recognize Pattern: per feature, the literal that is true under X is rewarded with probability
+         * (s-1)/s and the false one is penalized with probability 1/s, independently. The rewards skip
+         * over the 1/s misses, the penalties jump from event to event. */
+        int miss = rng_geometric(rng, log_q, N);
+        for (int i = 0; i < N; ++i) {
+            if (i == miss) {
+                miss += 1 + rng_geometric(rng, log_q, N);
+                continue;
+            }
+            feedback_count += literal_reward(c, bitpack_get(X, i) ? i : N + i, middle);
+        }
+        for (int i = rng_geometric(rng, log_q, N); i < N; i += 1 + rng_geometric(rng, log_q, N)) {
+            feedback_count += literal_penalty(c, bitpack_get(X, i) ? N + i : i, middle);
+        }
+    }
+
+    refresh_trainable(c, threshold);
+    return feedback_count;
+}
+
+int clause_update(clause_t* c, const int* X, int match_target, int clause_output, double s, int threshold, rng_t* rng) {
+    assert(c != NULL);
+    assert(X != NULL);
+
+    uint64_t local_words[64]; /* small fast path; wider inputs are packed on the heap */
+    uint64_t* Xp = local_words;
+    if (c->N_words > 64) {
+        Xp = (uint64_t*)malloc(sizeof(uint64_t) * c->N_words);
+        if (!Xp) return 0;
+    }
+    bitpack_pack(X, c->N_feature, Xp);
+
+    int feedback_count = clause_update_packed(c, Xp, match_target, clause_output, s, threshold, rng);
+
+    if (Xp != local_words) free(Xp);
     return feedback_count;
 }
 
@@ -354,10 +564,8 @@ void clause_set_state(clause_t* c, const int* states, int threshold) {
     assert(states != NULL);
 
     for (int i = 0; i < c->N_feature; ++i) {
-        c->p_automata[i]->state = states[i];
-        automaton_update(c->p_automata[i]);
-        c->n_automata[i]->state = states[i + c->N_feature];
-        automaton_update(c->n_automata[i]);
+        c->p_automata[i] = (automaton_state_t)states[i];
+        c->n_automata[i] = (automaton_state_t)states[i + c->N_feature];
     }
     clause_compress(c, threshold);
 }
@@ -367,8 +575,25 @@ int* clause_get_state(const clause_t* c) {
     int* states = (int*)malloc(sizeof(int) * 2 * c->N_feature);
     if (!states) return NULL;
     for (int i = 0; i < c->N_feature; ++i) {
-        states[i] = c->p_automata[i]->state;
-        states[i + c->N_feature] = c->n_automata[i]->state;
+        states[i] = c->p_automata[i];
+        states[i + c->N_feature] = c->n_automata[i];
     }
     return states;
 }
+
+int clause_get_automaton(const clause_t* c, int literal) {
+    assert(c != NULL);
+    assert(literal >= 0 && literal < c->N_literals);
+    return c->p_automata[literal];
+}
+
+void clause_set_automaton(clause_t* c, int literal, int state) {
+    assert(c != NULL);
+    assert(literal >= 0 && literal < c->N_literals);
+    assert(state >= 0 && state <= AUTOMATON_STATE_MAX);
+    c->p_automata[literal] = (automaton_state_t)state;
+}
+
+int clause_get_action(const clause_t* c, int literal) {
+    return state_action((automaton_state_t)clause_get_automaton(c, literal), c->N_states / 2);
+}
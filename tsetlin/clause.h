@@ -3,8 +3,11 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #include "automaton.h"
+#include "rng.h"
+#include "sparse.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -15,34 +18,87 @@ extern "C" {
         int N_states;
         int N_literals;
 
-        automaton_t** p_automata; /* array length N_feature */
-        automaton_t** n_automata; /* array length N_feature */
+        /* Automaton states in one contiguous block of length N_literals:
+         * the N_feature positive literals (X_i) first, then the negated ones (NOT X_i). */
+        automaton_state_t* p_automata; /* array length N_feature */
+        automaton_state_t* n_automata; /* array length N_feature, p_automata + N_feature */
 
-        /* Included literal index lists (built by compress). */
+        /* Include masks over the packed input (see bitpack.h), N_words words each:
+         * bit i of p_include_mask / n_include_mask is set when X_i / NOT X_i is included. */
+        int N_words;
+        uint64_t* p_include_mask;
+        uint64_t* n_include_mask; /* p_include_mask + N_words */
+
+        /* Included literal index lists: dense and unordered, capacity N_feature each. Updates keep
+         * them exact in O(1) per include flip; *_included_pos[i] is the slot of feature i or -1. */
         int* p_included_idxs;
         int p_included_count;
         int* n_included_idxs;
         int n_included_count;
-
-        /* Trainable literal index lists (optional, when threshold >= 0). */
+        int* p_included_pos;
+        int* n_included_pos;
+
+        /* Trainable literal index lists (when threshold >= 0 or absorbing), capacity N_feature each.
+         * Only listed automata are updated, so an automaton can leave the lists (by crossing the
+         * middle +- threshold band, or absorbing) but never re-enter: updates drop the leavers in
+         * O(list length) and rebuild in O(N_feature) only when called with another threshold than
+         * trainable_threshold, the one the lists were built for (-1: none, -2: stale after an
+         * update without lists). */
         int* p_trainable_idxs;
         int p_trainable_count;
         int* n_trainable_idxs;
         int n_trainable_count;
+        int trainable_threshold;
+
+        /* Absorbing mode (clause_set_absorbing): automata reaching state 1 or N_states are frozen
+         * and leave the trainable lists for good. Off (0) by default. */
+        int absorbing;
+
+        /* Allocation holding all arrays above when created by clause_new; NULL for clause_init. */
+        void* block;
     } clause_t;
 
-    /* Allocate and initialize a clause. Caller must free with clause_free(). */
-    clause_t* clause_new(int N_feature, int N_states);
+    /* Allocate and initialize a clause; the initial states are drawn from rng. Caller must free with clause_free(). */
+    clause_t* clause_new(int N_feature, int N_states, rng_t* rng);
 
-    /* Free clause and owned automata and internal arrays. */
+    /* Free clause and owned state block and internal arrays. Only for clauses from clause_new. */
     void clause_free(clause_t* c);
 
-    /* Rebuild included and trainable index arrays. If threshold < 0, trainable lists are cleared. */
+    /* Bytes of memory a clause over N_feature features needs for its arrays (see clause_init). */
+    size_t clause_footprint(int N_feature);
+
+    /* Initialize c in place with its arrays in mem (clause_footprint(N_feature) bytes, 64-byte
+     * aligned for cache-line aligned arrays). Nothing is allocated; c and mem stay owned by the
+     * caller and must outlive the clause. Do not call clause_free on such a clause. */
+    void clause_init(clause_t* c, int N_feature, int N_states, void* mem, rng_t* rng);
+
+    /* Rebuild include masks, included and trainable index arrays from the states in O(N_feature).
+     * Updates keep them current, so this is only needed after writing states directly.
+     * If threshold < 0, trainable lists are cleared, or hold every live automaton when absorbing. */
     void clause_compress(clause_t* c, int threshold);
 
+    /*
+     * Turn absorbing mode on or off and rebuild the trainable lists (as clause_compress(c, -1)).
+     * When on, the bounds 1 and N_states are absorbing: an automaton that reaches one is never
+     * visited again, and updates without threshold walk the trainable lists of live automata
+     * instead of all N_feature, so their cost shrinks as the clause converges. With a threshold,
+     * the band and the bounds both filter.
+     */
+    void clause_set_absorbing(clause_t* c, int absorbing);
+
+    /* Automata strictly between the bounds 1 and N_states, i.e. not (or not yet) absorbed. */
+    int clause_live_count(const clause_t* c);
+
     /* Evaluate clause on input X (array length N_feature). Returns 1 or 0. */
     int clause_evaluate(const clause_t* c, const int* X);
 
+    /* Evaluate clause on bit-packed input X (BITPACK_WORDS(N_feature) words), 64 literals per step. */
+    int clause_evaluate_packed(const clause_t* c, const uint64_t* X);
+
+    /* Evaluate clause on sparse input X in O(X->n_active): no active feature may have its NOT X_i
+     * included, and the active features must cover all p_included_count included X_i. */
+    int clause_evaluate_sparse(const clause_t* c, const sparse_sample_t* X);
+
     /*
      * Update clause according to algorithm.
      * X: input feature array length N_feature (values 0 or 1)
@@ -50,9 +106,28 @@ extern "C" {
      * clause_output: clause evaluation result (0 or 1)
      * s: parameter s (>1) controlling probabilities
      * threshold: optional threshold for trainable automata (-1 means disabled)
+     * rng: random stream for the feedback draws; only the calling thread may use it
      * Returns number of automata feedback events applied.
      */
-    int clause_update(clause_t* c, const int* X, int match_target, int clause_output, double s, int threshold);
+    int clause_update(clause_t* c, const int* X, int match_target, int clause_output, double s, int threshold, rng_t* rng);
+
+    /* Same as clause_update, with X bit-packed (BITPACK_WORDS(N_feature) words). */
+    int clause_update_packed(clause_t* c, const uint64_t* X, int match_target, int clause_output, double s, int threshold, rng_t* rng);
+
+    /* How the probability-1/s Type I events are drawn. */
+    typedef enum {
+        CLAUSE_SAMPLING_BERNOULLI = 0, /* one draw per automaton (clause_update_packed) */
+        CLAUSE_SAMPLING_GEOMETRIC,     /* geometric gaps between events (clause_update_geometric) */
+        CLAUSE_SAMPLING_BITSLICED      /* tsetlin_fit_parallel without threshold or absorbing: bit-sliced states
+                                        * updated a word of automata at a time (bitslice.h); bernoulli otherwise */
+    } clause_sampling_t;
+
+    /*
+     * Same dynamics as clause_update_packed: every automaton receives feedback with the same
+     * probability, independently. The rare 1/s events are drawn as geometric gaps to the next
+     * firing automaton, so the draws cost O(feedback events) rather than O(N_feature).
+     */
+    int clause_update_geometric(clause_t* c, const uint64_t* X, int match_target, int clause_output, double s, int threshold, rng_t* rng);
 
     /* Set automata states from states array length 2 * N_feature.
      * states[0..N_feature-1] -> p_automata states
@@ -64,6 +139,13 @@ extern "C" {
      * Caller must free the returned pointer. */
     int* clause_get_state(const clause_t* c);
 
+    /* Accessors for a single automaton. literal uses the same layout as clause_get_state:
+     * 0..N_feature-1 are positive literals, N_feature..2*N_feature-1 negated ones.
+     * clause_set_automaton does not refresh the index lists; call clause_compress() afterwards. */
+    int clause_get_automaton(const clause_t* c, int literal);
+    void clause_set_automaton(clause_t* c, int literal, int state);
+    int clause_get_action(const clause_t* c, int literal);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,277 @@
+#include "compact.h"
+#include "bitpack.h"
+#include "byteorder.h"
+#include "mapfile.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Compact file format, version 1. All integers are little-endian.
+ *
+ *   0  char magic[8]   "TSCOMPCT"
+ *   8  u32  version    COMPACT_FILE_VERSION
+ *  12  u32  header_size 64
+ *  16  u32  n_features
+ *  20  u32  n_classes
+ *  24  u32  n_kept
+ *  28  u32  n_entries
+ *  32  reserved, zero
+ *
+ * Then the arrays of tsetlin_compact_t back to back: bias (i32), class_begin (i32), sign (i8),
+ * entry_begin (i32), entry_word (u32), entry_p (u64), entry_n (u64).
+ */
+#define COMPACT_FILE_MAGIC "TSCOMPCT"
+#define COMPACT_FILE_VERSION 1
+#define COMPACT_HEADER_SIZE 64
+
+static size_t align8(size_t n) {
+    return (n + 7) & ~(size_t)7;
+}
+
+/* Bytes of the arrays in the file, after the header. */
+static size_t compact_file_payload(int n_classes, int n_kept, int n_entries) {
+    return sizeof(int32_t) * ((size_t)n_classes + (n_classes + 1) + (n_kept + 1))
+        + (size_t)n_kept
+        + (sizeof(uint32_t) + 2 * sizeof(uint64_t)) * (size_t)n_entries;
+}
+
+/* One allocation: the struct, then the 8-byte arrays, then the 4-byte ones, then sign. */
+static size_t compact_bytes(int n_classes, int n_kept, int n_entries) {
+    return align8(sizeof(tsetlin_compact_t))
+        + 2 * sizeof(uint64_t) * (size_t)n_entries
+        + sizeof(int) * ((size_t)n_classes + (n_classes + 1) + (n_kept + 1))
+        + sizeof(uint32_t) * (size_t)n_entries
+        + (size_t)n_kept;
+}
+
+static tsetlin_compact_t* compact_alloc(int n_features, int n_classes, int n_kept, int n_entries) {
+    unsigned char* p = (unsigned char*)calloc(1, compact_bytes(n_classes, n_kept, n_entries));
+    if (!p) return NULL;
+
+    tsetlin_compact_t* cm = (tsetlin_compact_t*)p;
+    cm->n_features = n_features;
+    cm->n_classes = n_classes;
+    cm->n_words = BITPACK_WORDS(n_features);
+    cm->n_kept = n_kept;
+    cm->n_entries = n_entries;
+
+    p += align8(sizeof(tsetlin_compact_t));
+    cm->entry_p = (uint64_t*)p;
+    p += sizeof(uint64_t) * (size_t)n_entries;
+    cm->entry_n = (uint64_t*)p;
+    p += sizeof(uint64_t) * (size_t)n_entries;
+    cm->bias = (int*)p;
+    p += sizeof(int) * (size_t)n_classes;
+    cm->class_begin = (int*)p;
+    p += sizeof(int) * (size_t)(n_classes + 1);
+    cm->entry_begin = (int*)p;
+    p += sizeof(int) * (size_t)(n_kept + 1);
+    cm->entry_word = (uint32_t*)p;
+    p += sizeof(uint32_t) * (size_t)n_entries;
+    cm->sign = (int8_t*)p;
+    return cm;
+}
+
+/* Entries a clause needs: -1 if it can never fire, 0 if it always fires. */
+static int clause_entries(const clause_t* clause) {
+    int entries = 0;
+    for (int w = 0; w < clause->N_words; ++w) {
+        uint64_t p = clause->p_include_mask[w];
+        uint64_t n = clause->n_include_mask[w];
+        if (p & n) return -1; /* X_i AND NOT X_i */
+        if (p | n) ++entries;
+    }
+    return entries;
+}
+
+tsetlin_compact_t* tsetlin_compact_new(const tsetlin_t* ts) {
+    assert(ts != NULL);
+
+    int n_kept = 0, n_entries = 0;
+    for (int c = 0; c < ts->n_classes; ++c) {
+        for (int j = 0; j < ts->n_clauses; ++j) {
+            int entries = clause_entries(tsetlin_get_clause(ts, c, j));
+            if (entries > 0) {
+                ++n_kept;
+                n_entries += entries;
+            }
+        }
+    }
+
+    tsetlin_compact_t* cm = compact_alloc(ts->n_features, ts->n_classes, n_kept, n_entries);
+    if (!cm) return NULL;
+
+    int half = ts->n_clauses / 2;
+    int k = 0, e = 0;
+    for (int c = 0; c < ts->n_classes; ++c) {
+        cm->class_begin[c] = k;
+        for (int j = 0; j < ts->n_clauses; ++j) {
+            const clause_t* clause = tsetlin_get_clause(ts, c, j);
+            int sign = (j < half) ? 1 : -1;
+            int entries = clause_entries(clause);
+            if (entries == 0) cm->bias[c] += sign;
+            if (entries <= 0) continue;
+
+            cm->sign[k] = (int8_t)sign;
+            cm->entry_begin[k] = e;
+            for (int w = 0; w < clause->N_words; ++w) {
+                if ((clause->p_include_mask[w] | clause->n_include_mask[w]) == 0) continue;
+                cm->entry_word[e] = (uint32_t)w;
+                cm->entry_p[e] = clause->p_include_mask[w];
+                cm->entry_n[e] = clause->n_include_mask[w];
+                ++e;
+            }
+            ++k;
+        }
+    }
+    cm->class_begin[ts->n_classes] = k;
+    cm->entry_begin[k] = e;
+    return cm;
+}
+
+void tsetlin_compact_free(tsetlin_compact_t* cm) {
+    free(cm); /* arrays share the allocation */
+}
+
+size_t tsetlin_compact_size(const tsetlin_compact_t* cm) {
+    assert(cm != NULL);
+    return compact_bytes(cm->n_classes, cm->n_kept, cm->n_entries);
+}
+
+int tsetlin_compact_predict_packed(const tsetlin_compact_t* cm, const uint64_t* X, int* votes_out) {
+    assert(cm != NULL);
+    assert(X != NULL);
+
+    int best = 0, best_votes = 0;
+    for (int c = 0; c < cm->n_classes; ++c) {
+        int sum = cm->bias[c];
+        for (int k = cm->class_begin[c]; k < cm->class_begin[c + 1]; ++k) {
+            int fires = 1;
+            for (int e = cm->entry_begin[k]; e < cm->entry_begin[k + 1]; ++e) {
+                uint64_t x = X[cm->entry_word[e]];
+                if ((x & cm->entry_p[e]) != cm->entry_p[e] || (x & cm->entry_n[e]) != 0) {
+                    fires = 0;
+                    break;
+                }
+            }
+            if (fires) sum += cm->sign[k];
+        }
+        if (votes_out) votes_out[c] = sum;
+        if (c == 0 || sum > best_votes) { /* first maximum, as tsetlin_predict */
+            best = c;
+            best_votes = sum;
+        }
+    }
+    return best;
+}
+
+int tsetlin_compact_predict(const tsetlin_compact_t* cm, const int* X, int* votes_out) {
+    assert(cm != NULL);
+    assert(X != NULL);
+
+    uint64_t local_words[64]; /* small fast path; wider inputs are packed on the heap */
+    uint64_t* Xp = local_words;
+    if (cm->n_words > 64) {
+        Xp = (uint64_t*)malloc(sizeof(uint64_t) * cm->n_words);
+        if (!Xp) return 0;
+    }
+    bitpack_pack(X, cm->n_features, Xp);
+
+    int pred = tsetlin_compact_predict_packed(cm, Xp, votes_out);
+
+    if (Xp != local_words) free(Xp);
+    return pred;
+}
+
+int tsetlin_compact_save(const tsetlin_compact_t* cm, const char* path) {
+    assert(cm != NULL);
+    assert(path != NULL);
+
+    size_t size = COMPACT_HEADER_SIZE + compact_file_payload(cm->n_classes, cm->n_kept, cm->n_entries);
+    unsigned char* buffer = (unsigned char*)calloc(1, size);
+    if (!buffer) return -1;
+
+    unsigned char* p = buffer;
+    memcpy(p, COMPACT_FILE_MAGIC, 8);
+    put_u32(p + 8, COMPACT_FILE_VERSION);
+    put_u32(p + 12, COMPACT_HEADER_SIZE);
+    put_u32(p + 16, (uint32_t)cm->n_features);
+    put_u32(p + 20, (uint32_t)cm->n_classes);
+    put_u32(p + 24, (uint32_t)cm->n_kept);
+    put_u32(p + 28, (uint32_t)cm->n_entries);
+    p += COMPACT_HEADER_SIZE;
+
+    for (int c = 0; c < cm->n_classes; ++c, p += 4) put_u32(p, (uint32_t)cm->bias[c]);
+    for (int c = 0; c <= cm->n_classes; ++c, p += 4) put_u32(p, (uint32_t)cm->class_begin[c]);
+    for (int k = 0; k < cm->n_kept; ++k, ++p) *p = (unsigned char)cm->sign[k];
+    for (int k = 0; k <= cm->n_kept; ++k, p += 4) put_u32(p, (uint32_t)cm->entry_begin[k]);
+    for (int e = 0; e < cm->n_entries; ++e, p += 4) put_u32(p, cm->entry_word[e]);
+    for (int e = 0; e < cm->n_entries; ++e, p += 8) put_u64(p, cm->entry_p[e]);
+    for (int e = 0; e < cm->n_entries; ++e, p += 8) put_u64(p, cm->entry_n[e]);
+
+    FILE* f = fopen(path, "wb");
+    int ok = f && fwrite(buffer, 1, size, f) == size;
+    if (f && fclose(f) != 0) ok = 0;
+    free(buffer);
+    return ok ? 0 : -1;
+}
+
+/* Check the offsets of a decoded model so that prediction stays in bounds. */
+static int compact_valid(const tsetlin_compact_t* cm) {
+    if (cm->class_begin[0] != 0 || cm->class_begin[cm->n_classes] != cm->n_kept) return 0;
+    for (int c = 0; c < cm->n_classes; ++c) {
+        if (cm->class_begin[c] > cm->class_begin[c + 1]) return 0;
+    }
+    if (cm->entry_begin[0] != 0 || cm->entry_begin[cm->n_kept] != cm->n_entries) return 0;
+    for (int k = 0; k < cm->n_kept; ++k) {
+        if (cm->entry_begin[k] > cm->entry_begin[k + 1]) return 0;
+    }
+    for (int e = 0; e < cm->n_entries; ++e) {
+        if (cm->entry_word[e] >= (uint32_t)cm->n_words) return 0;
+    }
+    return 1;
+}
+
+tsetlin_compact_t* tsetlin_compact_load(const char* path) {
+    assert(path != NULL);
+
+    mapfile_t m;
+    if (mapfile_open(&m, path) != 0) return NULL;
+
+    const unsigned char* p = (const unsigned char*)m.data;
+    tsetlin_compact_t* cm = NULL;
+    if (m.size >= COMPACT_HEADER_SIZE && memcmp(p, COMPACT_FILE_MAGIC, 8) == 0
+        && get_u32(p + 8) == COMPACT_FILE_VERSION && get_u32(p + 12) == COMPACT_HEADER_SIZE) {
+        uint32_t n_features = get_u32(p + 16);
+        uint32_t n_classes = get_u32(p + 20);
+        uint32_t n_kept = get_u32(p + 24);
+        uint32_t n_entries = get_u32(p + 28);
+        int sane = n_features > 0 && n_features <= (1u << 30) && n_classes > 0 && n_classes <= (1u << 20)
+            && n_kept <= (1u << 28) && n_entries <= (1u << 28);
+        if (sane && m.size == COMPACT_HEADER_SIZE + compact_file_payload((int)n_classes, (int)n_kept, (int)n_entries)) {
+            cm = compact_alloc((int)n_features, (int)n_classes, (int)n_kept, (int)n_entries);
+        }
+    }
+
+    if (cm) {
+        p += COMPACT_HEADER_SIZE;
+        for (int c = 0; c < cm->n_classes; ++c, p += 4) cm->bias[c] = (int32_t)get_u32(p);
+        for (int c = 0; c <= cm->n_classes; ++c, p += 4) cm->class_begin[c] = (int32_t)get_u32(p);
+        for (int k = 0; k < cm->n_kept; ++k, ++p) cm->sign[k] = (int8_t)*p;
+        for (int k = 0; k <= cm->n_kept; ++k, p += 4) cm->entry_begin[k] = (int32_t)get_u32(p);
+        for (int e = 0; e < cm->n_entries; ++e, p += 4) cm->entry_word[e] = get_u32(p);
+        for (int e = 0; e < cm->n_entries; ++e, p += 8) cm->entry_p[e] = get_u64(p);
+        for (int e = 0; e < cm->n_entries; ++e, p += 8) cm->entry_n[e] = get_u64(p);
+
+        if (!compact_valid(cm)) {
+            tsetlin_compact_free(cm);
+            cm = NULL;
+        }
+    }
+
+    mapfile_close(&m);
+    return cm;
+}
@@ -0,0 +1,58 @@
+#ifndef TSETLIN_COMPACT_H
+#define TSETLIN_COMPACT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "tsetlin.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /*
+     * Read-only inference model exported from a trained tsetlin_t. It keeps only the include
+     * masks, as sparse words: for every clause, the (word index, positive bits, negated bits)
+     * triples of the input words it includes a literal from. No automaton states, no index lists.
+     * Clauses without literals always fire and become a constant per-class bias; clauses that
+     * include both X_i and NOT X_i never fire and are dropped. Votes and predictions are exactly
+     * those of the source model.
+     */
+    typedef struct {
+        int n_features;
+        int n_classes;
+        int n_words;            /* BITPACK_WORDS(n_features) */
+
+        int* bias;              /* n_classes: constant votes of the empty clauses */
+        int* class_begin;       /* n_classes + 1: kept clauses of class c are [class_begin[c], class_begin[c + 1]) */
+        int8_t* sign;           /* +1 for positive, -1 for negative clauses */
+        int* entry_begin;       /* n_kept + 1: entries of clause k are [entry_begin[k], entry_begin[k + 1]) */
+        uint32_t* entry_word;   /* input word index of each entry */
+        uint64_t* entry_p;      /* included positive literals in that word */
+        uint64_t* entry_n;      /* included negated literals in that word */
+
+        int n_kept;             /* clauses kept */
+        int n_entries;
+    } tsetlin_compact_t;
+
+    /* Export the clauses of ts. Returns NULL on allocation failure. Free with tsetlin_compact_free. */
+    tsetlin_compact_t* tsetlin_compact_new(const tsetlin_t* ts);
+    void tsetlin_compact_free(tsetlin_compact_t* cm);
+
+    /* Bytes of memory held by the compact model. */
+    size_t tsetlin_compact_size(const tsetlin_compact_t* cm);
+
+    /* Same as tsetlin_predict / tsetlin_predict_packed on the source model. */
+    int tsetlin_compact_predict(const tsetlin_compact_t* cm, const int* X, int* votes_out);
+    int tsetlin_compact_predict_packed(const tsetlin_compact_t* cm, const uint64_t* X, int* votes_out);
+
+    /* Write / read the compact model (little-endian, versioned). save returns 0 on success, -1 on
+     * failure; load returns NULL on failure. */
+    int tsetlin_compact_save(const tsetlin_compact_t* cm, const char* path);
+    tsetlin_compact_t* tsetlin_compact_load(const char* path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TSETLIN_COMPACT_H */
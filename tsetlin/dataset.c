@@ -0,0 +1,301 @@
+#include "dataset.h"
+#include "byteorder.h"
+#include "mapfile.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#if !defined(_WIN32)
+#include <unistd.h>
+#endif
+
+/*
+ * IDX files are big-endian: a u32 magic (0x0000TTDD, T the element type, 0x08 for ubyte, D the
+ * number of dimensions), D u32 dimension sizes, then the elements in row-major order.
+ */
+#define IDX_MAGIC_IMAGES 0x00000803u
+#define IDX_MAGIC_LABELS 0x00000801u
+
+#define DATASET_CHUNK (1 << 20) /* raw image bytes binarized between working-set releases */
+
+static size_t align8(size_t n) {
+    return (n + 7) & ~(size_t)7;
+}
+
+/* One allocation: the struct, then X, then y. */
+static size_t dataset_bytes(int n_samples, int n_words, int with_labels) {
+    return align8(sizeof(dataset_t))
+        + sizeof(uint64_t) * (size_t)n_samples * n_words
+        + (with_labels ? sizeof(int) * (size_t)n_samples : 0);
+}
+
+dataset_t* dataset_new(int n_samples, int n_features, int with_labels) {
+    assert(n_samples >= 0);
+    assert(n_features > 0);
+
+    int n_words = BITPACK_WORDS(n_features);
+    unsigned char* block = (unsigned char*)calloc(1, dataset_bytes(n_samples, n_words, with_labels));
+    if (!block) return NULL;
+
+    dataset_t* ds = (dataset_t*)block;
+    ds->n_samples = n_samples;
+    ds->n_features = n_features;
+    ds->n_words = n_words;
+    ds->rows = 1;
+    ds->cols = n_features;
+    ds->X = (uint64_t*)(block + align8(sizeof(dataset_t)));
+    if (with_labels) ds->y = (int*)(ds->X + (size_t)n_samples * n_words);
+    return ds;
+}
+
+/* Pack one image: bit i of the row is pixel i > threshold. */
+static void binarize_row(const unsigned char* pixels, int n_features, int threshold, uint64_t* out) {
+    for (int w = 0; w < BITPACK_WORDS(n_features); ++w) {
+        int n = n_features - w * 64;
+        if (n > 64) n = 64;
+        const unsigned char* src = pixels + (size_t)w * 64;
+        uint64_t word = 0;
+        for (int b = 0; b < n; ++b) word |= (uint64_t)(src[b] > threshold) << b;
+        out[w] = word;
+    }
+}
+
+dataset_t* dataset_load_idx(const char* images_path, const char* labels_path, int threshold) {
+    assert(images_path != NULL);
+
+    mapfile_t images, labels;
+    if (mapfile_open(&images, images_path) != 0) return NULL;
+    memset(&labels, 0, sizeof(labels));
+    if (labels_path && mapfile_open(&labels, labels_path) != 0) {
+        mapfile_close(&images);
+        return NULL;
+    }
+
+    dataset_t* ds = NULL;
+    const unsigned char* p = (const unsigned char*)images.data;
+    uint32_t count = 0, rows = 0, cols = 0;
+    int ok = images.size >= 16 && get_u32_be(p) == IDX_MAGIC_IMAGES;
+    if (ok) {
+        count = get_u32_be(p + 4);
+        rows = get_u32_be(p + 8);
+        cols = get_u32_be(p + 12);
+        ok = count <= (1u << 30) && rows > 0 && cols > 0 && (uint64_t)rows * cols <= (1u << 30)
+            && images.size - 16 >= (uint64_t)count * rows * cols;
+    }
+    if (ok && labels_path) {
+        const unsigned char* q = (const unsigned char*)labels.data;
+        ok = labels.size >= 8 && get_u32_be(q) == IDX_MAGIC_LABELS && get_u32_be(q + 4) == count
+            && labels.size - 8 >= count;
+    }
+
+    int n_features = (int)(rows * cols);
+    int n_words = BITPACK_WORDS(n_features);
+    if (ok) ds = dataset_new((int)count, n_features, labels_path != NULL);
+    if (ds) {
+        ds->rows = (int)rows;
+        ds->cols = (int)cols;
+
+        /* Stream the pixels through: the raw file never needs to be resident as a whole. */
+        size_t done = 16;
+        for (int i = 0; i < ds->n_samples; ++i) {
+            size_t offset = 16 + (size_t)i * n_features;
+            binarize_row(p + offset, n_features, threshold, ds->X + (size_t)i * n_words);
+            if (offset + n_features - done >= DATASET_CHUNK) {
+                mapfile_discard(&images, done, offset + n_features - done);
+                done = offset + n_features;
+            }
+        }
+
+        if (labels_path) {
+            const unsigned char* q = (const unsigned char*)labels.data + 8;
+            for (int i = 0; i < ds->n_samples; ++i) ds->y[i] = (int)q[i];
+        }
+    }
+
+    mapfile_close(&images);
+    mapfile_close(&labels);
+    return ds;
+}
+
+void dataset_free(dataset_t* ds) {
+    if (!ds) return;
+    if (ds->mapping) mapfile_close((mapfile_t*)ds->mapping);
+    free(ds); /* X and y share the allocation, or live in the mapping */
+}
+
+size_t dataset_size(const dataset_t* ds) {
+    assert(ds != NULL);
+    return dataset_bytes(ds->n_samples, ds->n_words, ds->y != NULL);
+}
+
+/*
+ * Cache file format, version 1. All integers are little-endian.
+ *
+ *   0  char magic[8]   "TSDATSET"
+ *   8  u32  version    DATASET_FILE_VERSION
+ *  12  u32  header_size 64
+ *  16  u32  n_samples
+ *  20  u32  n_features
+ *  24  u32  rows
+ *  28  u32  cols
+ *  32  u32  flags       bit 0: labels present
+ *  36  u32  params_size
+ *  40  u64  key         caller's identity of source and parameters
+ *  48  u64  file_size
+ *  56  u64  header_hash dataset_hash of bytes [0, 56)
+ *
+ * Then params, padded to 64 bytes; the packed rows (n_samples * BITPACK_WORDS(n_features) u64);
+ * then the labels (n_samples i32) if present.
+ */
+#define DATASET_FILE_MAGIC "TSDATSET"
+#define DATASET_HEADER_SIZE 64
+#define DATASET_FLAG_LABELS 1u
+
+static size_t align64(size_t n) {
+    return (n + 63) & ~(size_t)63;
+}
+
+uint64_t dataset_hash(const void* data, size_t size, uint64_t h) {
+    const unsigned char* p = (const unsigned char*)data;
+    for (size_t i = 0; i < size; ++i) {
+        h ^= p[i];
+        h *= 0x100000001B3ull;
+    }
+    return h;
+}
+
+uint64_t dataset_hash_file(const char* path, uint64_t h) {
+    assert(path != NULL);
+    unsigned char stamp[16] = { 0 };
+    struct stat st;
+    if (stat(path, &st) == 0) {
+        put_u64(stamp, (uint64_t)st.st_size);
+        put_u64(stamp + 8, (uint64_t)st.st_mtime);
+    }
+    return dataset_hash(stamp, sizeof(stamp), h);
+}
+
+static size_t cache_file_size(int n_samples, int n_words, int with_labels, size_t params_size) {
+    return DATASET_HEADER_SIZE + align64(params_size)
+        + sizeof(uint64_t) * (size_t)n_samples * n_words
+        + (with_labels ? sizeof(int32_t) * (size_t)n_samples : 0);
+}
+
+int dataset_cache_save(const dataset_t* ds, const char* path, uint64_t key, const void* params, size_t params_size) {
+    assert(ds != NULL);
+    assert(path != NULL);
+    assert(params != NULL || params_size == 0);
+
+    size_t size = cache_file_size(ds->n_samples, ds->n_words, ds->y != NULL, params_size);
+    unsigned char* buffer = (unsigned char*)calloc(1, size);
+    size_t tmp_size = strlen(path) + 8;
+    char* tmp_path = (char*)malloc(tmp_size);
+    if (!buffer || !tmp_path) {
+        free(buffer); free(tmp_path);
+        return -1;
+    }
+
+    unsigned char* p = buffer;
+    memcpy(p, DATASET_FILE_MAGIC, 8);
+    put_u32(p + 8, DATASET_FILE_VERSION);
+    put_u32(p + 12, DATASET_HEADER_SIZE);
+    put_u32(p + 16, (uint32_t)ds->n_samples);
+    put_u32(p + 20, (uint32_t)ds->n_features);
+    put_u32(p + 24, (uint32_t)ds->rows);
+    put_u32(p + 28, (uint32_t)ds->cols);
+    put_u32(p + 32, ds->y ? DATASET_FLAG_LABELS : 0);
+    put_u32(p + 36, (uint32_t)params_size);
+    put_u64(p + 40, key);
+    put_u64(p + 48, (uint64_t)size);
+    put_u64(p + 56, dataset_hash(p, 56, DATASET_HASH_INIT));
+    p += DATASET_HEADER_SIZE;
+
+    if (params_size) memcpy(p, params, params_size);
+    p += align64(params_size);
+    size_t n_row_words = (size_t)ds->n_samples * ds->n_words;
+    for (size_t w = 0; w < n_row_words; ++w, p += 8) put_u64(p, ds->X[w]);
+    if (ds->y) {
+        for (int i = 0; i < ds->n_samples; ++i, p += 4) put_u32(p, (uint32_t)ds->y[i]);
+    }
+
+    /* Write to a fresh file next to path, then rename over it: readers see the old cache or the
+     * whole new one, and concurrent writers never share a temporary. */
+    snprintf(tmp_path, tmp_size, "%s.XXXXXX", path);
+#if defined(_WIN32)
+    FILE* f = (_mktemp_s(tmp_path, tmp_size) == 0) ? fopen(tmp_path, "wb") : NULL;
+#else
+    FILE* f = NULL;
+    int fd = mkstemp(tmp_path);
+    if (fd >= 0) {
+        fchmod(fd, 0644); /* mkstemp creates it owner-only; the cache is shared */
+        f = fdopen(fd, "wb");
+        if (!f) close(fd);
+    }
+#endif
+    int ok = f && fwrite(buffer, 1, size, f) == size;
+    if (f && fclose(f) != 0) ok = 0;
+    if (ok) {
+#if defined(_WIN32)
+        remove(path); /* rename does not replace an existing file there */
+#endif
+        ok = rename(tmp_path, path) == 0;
+    }
+    if (!ok && f) remove(tmp_path);
+
+    free(buffer);
+    free(tmp_path);
+    return ok ? 0 : -1;
+}
+
+dataset_t* dataset_cache_open(const char* path, uint64_t key, int n_classes) {
+    assert(path != NULL);
+    assert(n_classes > 0);
+    if (!host_is_little_endian()) return NULL;
+
+    mapfile_t m;
+    if (mapfile_open(&m, path) != 0) return NULL;
+
+    const unsigned char* p = (const unsigned char*)m.data;
+    int ok = m.size >= DATASET_HEADER_SIZE && memcmp(p, DATASET_FILE_MAGIC, 8) == 0
+        && get_u32(p + 8) == DATASET_FILE_VERSION && get_u32(p + 12) == DATASET_HEADER_SIZE
+        && get_u64(p + 56) == dataset_hash(p, 56, DATASET_HASH_INIT) && get_u64(p + 40) == key;
+
+    uint32_t n_samples = 0, n_features = 0, flags = 0, params_size = 0;
+    if (ok) {
+        n_samples = get_u32(p + 16);
+        n_features = get_u32(p + 20);
+        flags = get_u32(p + 32);
+        params_size = get_u32(p + 36);
+        ok = n_samples <= (1u << 30) && n_features > 0 && n_features <= (1u << 30)
+            && get_u64(p + 48) == m.size
+            && m.size == cache_file_size((int)n_samples, BITPACK_WORDS((int)n_features), (flags & DATASET_FLAG_LABELS) != 0, params_size);
+    }
+    if (ok && (flags & DATASET_FLAG_LABELS)) {
+        const unsigned char* q = p + m.size - sizeof(int32_t) * (size_t)n_samples;
+        for (uint32_t i = 0; i < n_samples && ok; ++i) ok = get_u32(q + 4 * (size_t)i) < (uint32_t)n_classes;
+    }
+
+    /* Only the struct and the mapping are allocated; X, y and params point into the pages. */
+    unsigned char* block = ok ? (unsigned char*)calloc(1, align8(sizeof(dataset_t)) + sizeof(mapfile_t)) : NULL;
+    if (!block) {
+        mapfile_close(&m);
+        return NULL;
+    }
+
+    dataset_t* ds = (dataset_t*)block;
+    ds->mapping = block + align8(sizeof(dataset_t));
+    *(mapfile_t*)ds->mapping = m;
+    ds->n_samples = (int)n_samples;
+    ds->n_features = (int)n_features;
+    ds->n_words = BITPACK_WORDS(ds->n_features);
+    ds->rows = (int)get_u32(p + 24);
+    ds->cols = (int)get_u32(p + 28);
+    ds->params = params_size ? p + DATASET_HEADER_SIZE : NULL;
+    ds->params_size = params_size;
+    ds->X = (uint64_t*)(p + DATASET_HEADER_SIZE + align64(params_size)); /* never written */
+    if (flags & DATASET_FLAG_LABELS) ds->y = (int*)(ds->X + (size_t)n_samples * ds->n_words);
+    return ds;
+}
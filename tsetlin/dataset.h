@@ -0,0 +1,88 @@
+#ifndef TSETLIN_DATASET_H
+#define TSETLIN_DATASET_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bitpack.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /*
+     * Binarized dataset: n_samples packed rows (see bitpack.h) back to back in one contiguous
+     * matrix, as tsetlin_fit_parallel and the *_packed predictors take it, with int labels.
+     */
+    typedef struct {
+        int n_samples;
+        int n_features;
+        int n_words;        /* BITPACK_WORDS(n_features) per row */
+        int rows, cols;     /* image shape, n_features = rows * cols (1 x n_features for tables) */
+
+        uint64_t* X;        /* n_samples * n_words packed words; read-only when mapped */
+        int* y;             /* n_samples labels, NULL when loaded without labels */
+
+        /* Booleanization parameters stored with a cache file (dataset_cache_open), else NULL / 0. */
+        const void* params;
+        size_t params_size;
+
+        /* File mapping X, y and params live in (dataset_cache_open); NULL otherwise. */
+        void* mapping;
+    } dataset_t;
+
+    /* Allocate a dataset with zeroed rows (and labels if with_labels) for the caller to fill in,
+     * e.g. from a booleanizer of its own. Returns NULL on allocation failure. */
+    dataset_t* dataset_new(int n_samples, int n_features, int with_labels);
+
+    /*
+     * Load an IDX image file (ubyte, 3 dimensions, e.g. MNIST) and optionally its IDX label file
+     * (labels_path may be NULL). Pixels > threshold become 1. The files are mapped, not read, and
+     * binarized chunk by chunk straight into the packed matrix; consumed chunks are released from
+     * the working set, so peak memory is the packed matrix (1 bit per pixel) plus one chunk.
+     * Returns NULL if a file is missing or malformed, if the counts differ, or on allocation
+     * failure. Free with dataset_free.
+     */
+    dataset_t* dataset_load_idx(const char* images_path, const char* labels_path, int threshold);
+
+    void dataset_free(dataset_t* ds);
+
+    /* Bytes of memory held by the dataset. */
+    size_t dataset_size(const dataset_t* ds);
+
+    /*
+     * Pre-binarized cache files. A cache holds the packed rows, the labels and the caller's
+     * booleanization parameters (an opaque blob), tagged with a caller-chosen key that identifies
+     * the source data and parameters. dataset_cache_open maps the file without copying, so any
+     * number of processes share the same read-only pages; opening reads only the header and labels.
+     */
+#define DATASET_FILE_VERSION 1
+#define DATASET_HASH_INIT 0xCBF29CE484222325ull
+
+    /* FNV-1a of size bytes of data, continuing from h (DATASET_HASH_INIT to start); for keys. */
+    uint64_t dataset_hash(const void* data, size_t size, uint64_t h);
+
+    /* Continue h with the size and modification time of the file at path, so a key changes
+     * when the source file does. A file that cannot be stat'ed counts as size and time 0. */
+    uint64_t dataset_hash_file(const char* path, uint64_t h);
+
+    /* Write ds, key and params to path (little-endian, versioned). The file is written to a unique
+     * temporary in the same directory and renamed into place, so concurrent readers never see a
+     * partial cache and concurrent writers do not clobber each other. Returns 0 on success. */
+    int dataset_cache_save(const dataset_t* ds, const char* path, uint64_t key, const void* params, size_t params_size);
+
+    /* Map a cache written by dataset_cache_save. Returns NULL if it is missing, fails the header
+     * hash or size checks, was written for another key, holds a label outside [0, n_classes), or
+     * the host is big-endian; the caller then rebuilds it. Release with dataset_free. */
+    dataset_t* dataset_cache_open(const char* path, uint64_t key, int n_classes);
+
+    /* Packed row of sample i. */
+    static inline const uint64_t* dataset_row(const dataset_t* ds, int i) {
+        return ds->X + (size_t)i * ds->n_words;
+    }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TSETLIN_DATASET_H */
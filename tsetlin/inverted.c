@@ -0,0 +1,298 @@
+#include "inverted.h"
+#include "bitpack.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+static size_t align8(size_t n) {
+    return (n + 7) & ~(size_t)7;
+}
+
+/* One allocation: the struct, then row_bits, row_begin, row_word, feature and negated. */
+static size_t inverted_bytes(int n_literals, int n_row_words) {
+    return align8(sizeof(tsetlin_inverted_t))
+        + sizeof(uint64_t) * (size_t)n_row_words
+        + sizeof(int) * ((size_t)n_literals + 1)
+        + sizeof(uint32_t) * (size_t)n_row_words
+        + sizeof(uint32_t) * (size_t)n_literals
+        + (size_t)n_literals;
+}
+
+/* Index of the word holding the bit of clause j (tsetlin_get_clause numbering) of class c. */
+static int clause_word(int n_clauses, int half_words, int c, int j, int* bit) {
+    int half = n_clauses / 2;
+    int h = (j < half) ? 0 : 1;
+    int k = j - h * half;
+    *bit = k & 63;
+    return (2 * c + h) * half_words + (k >> 6);
+}
+
+tsetlin_inverted_t* tsetlin_inverted_new(const tsetlin_t* ts) {
+    assert(ts != NULL);
+
+    int n_features = ts->n_features;
+    int n_words = BITPACK_WORDS(n_features);
+
+    /* Literals some clause includes: literal i is X_i, literal n_features + i is NOT X_i. */
+    uint64_t* any = (uint64_t*)calloc(2 * (size_t)n_words, sizeof(uint64_t));
+    int* slot = (int*)malloc(sizeof(int) * 2 * (size_t)n_features);
+    if (!any || !slot) {
+        free(any); free(slot);
+        return NULL;
+    }
+    for (int c = 0; c < ts->n_classes; ++c) {
+        for (int j = 0; j < ts->n_clauses; ++j) {
+            const clause_t* clause = tsetlin_get_clause(ts, c, j);
+            for (int w = 0; w < n_words; ++w) {
+                any[w] |= clause->p_include_mask[w];
+                any[n_words + w] |= clause->n_include_mask[w];
+            }
+        }
+    }
+    int n_literals = 0;
+    for (int lit = 0; lit < 2 * n_features; ++lit) {
+        int negated = lit >= n_features;
+        int i = negated ? lit - n_features : lit;
+        slot[lit] = bitpack_get(any + negated * n_words, i) ? n_literals++ : -1;
+    }
+
+    /* Dense rows first, n_literals x row_words, then only their nonzero words are kept. */
+    int half_words = BITPACK_WORDS(ts->n_clauses / 2);
+    int row_words = 2 * half_words * ts->n_classes;
+    uint64_t* dense = (uint64_t*)calloc((size_t)n_literals * row_words + 1, sizeof(uint64_t));
+    if (!dense) {
+        free(any); free(slot);
+        return NULL;
+    }
+
+    for (int c = 0; c < ts->n_classes; ++c) {
+        for (int j = 0; j < ts->n_clauses; ++j) {
+            const clause_t* clause = tsetlin_get_clause(ts, c, j);
+            int bit;
+            int word = clause_word(ts->n_clauses, half_words, c, j, &bit);
+            for (int w = 0; w < n_words; ++w) {
+                if ((clause->p_include_mask[w] | clause->n_include_mask[w]) == 0) continue;
+                for (int b = 0; b < 64 && w * 64 + b < n_features; ++b) {
+                    int i = w * 64 + b;
+                    if ((clause->p_include_mask[w] >> b) & 1u) {
+                        dense[(size_t)slot[i] * row_words + word] |= (uint64_t)1 << bit;
+                    }
+                    if ((clause->n_include_mask[w] >> b) & 1u) {
+                        dense[(size_t)slot[n_features + i] * row_words + word] |= (uint64_t)1 << bit;
+                    }
+                }
+            }
+        }
+    }
+
+    int n_row_words = 0;
+    for (size_t w = 0; w < (size_t)n_literals * row_words; ++w) {
+        if (dense[w]) ++n_row_words;
+    }
+
+    unsigned char* p = (unsigned char*)calloc(1, inverted_bytes(n_literals, n_row_words));
+    if (!p) {
+        free(any); free(slot); free(dense);
+        return NULL;
+    }
+
+    tsetlin_inverted_t* ix = (tsetlin_inverted_t*)p;
+    ix->n_features = n_features;
+    ix->n_classes = ts->n_classes;
+    ix->n_clauses = ts->n_clauses;
+    ix->n_words = n_words;
+    ix->half_words = half_words;
+    ix->row_words = row_words;
+    int tail = (ts->n_clauses / 2) & 63;
+    ix->tail_mask = tail ? ((uint64_t)1 << tail) - 1 : ~(uint64_t)0;
+    ix->n_literals = n_literals;
+    ix->n_row_words = n_row_words;
+
+    p += align8(sizeof(tsetlin_inverted_t));
+    ix->row_bits = (uint64_t*)p;
+    p += sizeof(uint64_t) * (size_t)n_row_words;
+    ix->row_begin = (int*)p;
+    p += sizeof(int) * ((size_t)n_literals + 1);
+    ix->row_word = (uint32_t*)p;
+    p += sizeof(uint32_t) * (size_t)n_row_words;
+    ix->feature = (uint32_t*)p;
+    p += sizeof(uint32_t) * (size_t)n_literals;
+    ix->negated = (uint8_t*)p;
+
+    for (int lit = 0; lit < 2 * n_features; ++lit) {
+        if (slot[lit] < 0) continue;
+        int negated = lit >= n_features;
+        ix->feature[slot[lit]] = (uint32_t)(negated ? lit - n_features : lit);
+        ix->negated[slot[lit]] = (uint8_t)negated;
+    }
+
+    int e = 0;
+    for (int k = 0; k < n_literals; ++k) {
+        ix->row_begin[k] = e;
+        const uint64_t* row = dense + (size_t)k * row_words;
+        for (int w = 0; w < row_words; ++w) {
+            if (!row[w]) continue;
+            ix->row_word[e] = (uint32_t)w;
+            ix->row_bits[e] = row[w];
+            ++e;
+        }
+    }
+    ix->row_begin[n_literals] = e;
+
+    free(any);
+    free(slot);
+    free(dense);
+    return ix;
+}
+
+void tsetlin_inverted_free(tsetlin_inverted_t* ix) {
+    free(ix); /* arrays share the allocation */
+}
+
+size_t tsetlin_inverted_size(const tsetlin_inverted_t* ix) {
+    assert(ix != NULL);
+    return inverted_bytes(ix->n_literals, ix->n_row_words);
+}
+
+/*
+ * Votes of packed sample X into votes (n_classes), using killed (row_words words) as scratch.
+ * A clause fires unless one of its literals is false, so killed collects the clause bits of
+ * every false literal; padding bits past the last clause of a half start out killed.
+ */
+static int inverted_eval(const tsetlin_inverted_t* ix, const uint64_t* X, uint64_t* killed, int* votes) {
+    int hw = ix->half_words;
+    memset(killed, 0, sizeof(uint64_t) * ix->row_words);
+    for (int h = 0; h < 2 * ix->n_classes; ++h) killed[h * hw + hw - 1] = ~ix->tail_mask;
+
+    for (int k = 0; k < ix->n_literals; ++k) {
+        if (bitpack_get(X, (int)ix->feature[k]) != ix->negated[k]) continue; /* literal is true */
+        for (int e = ix->row_begin[k]; e < ix->row_begin[k + 1]; ++e) killed[ix->row_word[e]] |= ix->row_bits[e];
+    }
+
+    int best = 0;
+    for (int c = 0; c < ix->n_classes; ++c) {
+        const uint64_t* pos = killed + 2 * c * hw;
+        const uint64_t* neg = pos + hw;
+        int sum = 0;
+        for (int w = 0; w < hw; ++w) sum += bitpack_popcount(~pos[w]) - bitpack_popcount(~neg[w]);
+        votes[c] = sum;
+        if (sum > votes[best]) best = c; /* first maximum, as tsetlin_predict */
+    }
+    return best;
+}
+
+#define LOCAL_ROW_WORDS 256
+
+int tsetlin_inverted_predict_packed(const tsetlin_inverted_t* ix, const uint64_t* X, int* votes_out) {
+    assert(ix != NULL);
+    assert(X != NULL);
+
+    uint64_t local_killed[LOCAL_ROW_WORDS]; /* small fast path; wider indexes use the heap */
+    int local_votes[64];
+    uint64_t* killed = local_killed;
+    int* votes = local_votes;
+    if (ix->row_words > LOCAL_ROW_WORDS) killed = (uint64_t*)malloc(sizeof(uint64_t) * ix->row_words);
+    if (ix->n_classes > 64) votes = (int*)malloc(sizeof(int) * ix->n_classes);
+    if (!killed || !votes) {
+        if (killed != local_killed) free(killed);
+        if (votes != local_votes) free(votes);
+        return 0;
+    }
+
+    int pred = inverted_eval(ix, X, killed, votes);
+    if (votes_out) memcpy(votes_out, votes, sizeof(int) * ix->n_classes);
+
+    if (killed != local_killed) free(killed);
+    if (votes != local_votes) free(votes);
+    return pred;
+}
+
+int tsetlin_inverted_predict(const tsetlin_inverted_t* ix, const int* X, int* votes_out) {
+    assert(ix != NULL);
+    assert(X != NULL);
+
+    uint64_t local_words[64]; /* small fast path; wider inputs are packed on the heap */
+    uint64_t* Xp = local_words;
+    if (ix->n_words > 64) {
+        Xp = (uint64_t*)malloc(sizeof(uint64_t) * ix->n_words);
+        if (!Xp) return 0;
+    }
+    bitpack_pack(X, ix->n_features, Xp);
+
+    int pred = tsetlin_inverted_predict_packed(ix, Xp, votes_out);
+
+    if (Xp != local_words) free(Xp);
+    return pred;
+}
+
+#define INVERTED_GRAIN 64 /* samples claimed at a time by a worker */
+
+/* Shared state of a parallel prediction; scratch buffers are per worker. */
+typedef struct {
+    const tsetlin_inverted_t* ix;
+    const int** rows;        /* either int rows ... */
+    const uint64_t* packed;  /* ... or contiguous packed rows */
+    int* preds_out;
+    int* votes_out;
+    uint64_t* scratch_X;     /* one packed row per worker (int rows only) */
+    uint64_t* scratch_killed; /* row_words per worker */
+    int* scratch_votes;      /* n_classes per worker */
+} inverted_job_t;
+
+static void inverted_range(void* ctx, int begin, int end, int worker) {
+    const inverted_job_t* job = (const inverted_job_t*)ctx;
+    const tsetlin_inverted_t* ix = job->ix;
+    uint64_t* killed = job->scratch_killed + (size_t)worker * ix->row_words;
+
+    for (int i = begin; i < end; ++i) {
+        const uint64_t* X;
+        if (job->packed) {
+            X = job->packed + (size_t)i * ix->n_words;
+        }
+        else {
+            uint64_t* Xp = job->scratch_X + (size_t)worker * ix->n_words;
+            bitpack_pack(job->rows[i], ix->n_features, Xp);
+            X = Xp;
+        }
+        int* votes = job->votes_out ? job->votes_out + (size_t)i * ix->n_classes
+                                    : job->scratch_votes + (size_t)worker * ix->n_classes;
+        job->preds_out[i] = inverted_eval(ix, X, killed, votes);
+    }
+}
+
+static int inverted_run(const tsetlin_inverted_t* ix, threadpool_t* pool, const int** rows, const uint64_t* packed,
+    int n_samples, int* preds_out, int* votes_out) {
+    assert(ix != NULL);
+    assert(rows != NULL || packed != NULL);
+    assert(preds_out != NULL);
+
+    int n_workers = threadpool_size(pool);
+    inverted_job_t job = { ix, rows, packed, preds_out, votes_out, NULL, NULL, NULL };
+    job.scratch_killed = (uint64_t*)malloc(sizeof(uint64_t) * ix->row_words * n_workers);
+    job.scratch_votes = (int*)malloc(sizeof(int) * ix->n_classes * n_workers);
+    if (!packed) job.scratch_X = (uint64_t*)malloc(sizeof(uint64_t) * ix->n_words * n_workers);
+    if (!job.scratch_killed || !job.scratch_votes || (!packed && !job.scratch_X)) {
+        free(job.scratch_killed); free(job.scratch_votes); free(job.scratch_X);
+        return -1;
+    }
+
+    threadpool_parallel_for(pool, n_samples, INVERTED_GRAIN, inverted_range, &job);
+
+    free(job.scratch_killed);
+    free(job.scratch_votes);
+    free(job.scratch_X);
+    return 0;
+}
+
+int tsetlin_inverted_predict_parallel(const tsetlin_inverted_t* ix, threadpool_t* pool, const int** X, int n_samples,
+    int* preds_out, int* votes_out) {
+    assert(X != NULL);
+    return inverted_run(ix, pool, X, NULL, n_samples, preds_out, votes_out);
+}
+
+int tsetlin_inverted_predict_parallel_packed(const tsetlin_inverted_t* ix, threadpool_t* pool, const uint64_t* X,
+    int n_samples, int* preds_out, int* votes_out) {
+    assert(X != NULL);
+    return inverted_run(ix, pool, NULL, X, n_samples, preds_out, votes_out);
+}
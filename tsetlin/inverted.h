@@ -0,0 +1,65 @@
+#ifndef TSETLIN_INVERTED_H
+#define TSETLIN_INVERTED_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "threadpool.h"
+#include "tsetlin.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /*
+     * Literal-major inverted index of a trained tsetlin_t, an alternative evaluation engine to the
+     * per-clause one of tsetlin_predict. For every literal it stores one bit per clause of every
+     * class, set when the clause includes the literal. A sample ORs together the rows of its false
+     * literals; the clauses whose bits stay clear are exactly the ones that fire, and popcounts over
+     * the positive and negative halves give the votes of a class. Literals no clause includes are
+     * not stored. Votes and predictions are exactly those of the source model at the time of
+     * tsetlin_inverted_new; retrain means rebuild.
+     */
+    typedef struct {
+        int n_features;
+        int n_classes;
+        int n_clauses;          /* per class, as tsetlin_t */
+        int n_words;            /* BITPACK_WORDS(n_features) */
+
+        int half_words;         /* BITPACK_WORDS(n_clauses / 2): words per clause half */
+        int row_words;          /* 2 * half_words * n_classes: class c holds its positive clauses in
+                                 * words [2c * half_words, (2c + 1) * half_words), then its negative ones */
+        uint64_t tail_mask;     /* valid bits of the last word of a half */
+
+        int n_literals;         /* literals included by at least one clause */
+        uint32_t* feature;      /* n_literals: input feature of each literal */
+        uint8_t* negated;       /* n_literals: 1 for NOT X_i; the literal is false when X_i == negated */
+        int* row_begin;         /* n_literals + 1: words of literal k are [row_begin[k], row_begin[k + 1]) */
+        uint32_t* row_word;     /* clause word index of each nonzero word */
+        uint64_t* row_bits;     /* its clause bits */
+        int n_row_words;        /* nonzero words over all literals */
+    } tsetlin_inverted_t;
+
+    /* Index the clauses of ts. Returns NULL on allocation failure. Free with tsetlin_inverted_free. */
+    tsetlin_inverted_t* tsetlin_inverted_new(const tsetlin_t* ts);
+    void tsetlin_inverted_free(tsetlin_inverted_t* ix);
+
+    /* Bytes of memory held by the index. */
+    size_t tsetlin_inverted_size(const tsetlin_inverted_t* ix);
+
+    /* Same as tsetlin_predict / tsetlin_predict_packed on the source model. */
+    int tsetlin_inverted_predict(const tsetlin_inverted_t* ix, const int* X, int* votes_out);
+    int tsetlin_inverted_predict_packed(const tsetlin_inverted_t* ix, const uint64_t* X, int* votes_out);
+
+    /* Same as tsetlin_predict_parallel / tsetlin_predict_parallel_packed on the source model.
+     * Returns 0 on success, -1 on allocation failure. */
+    int tsetlin_inverted_predict_parallel(const tsetlin_inverted_t* ix, threadpool_t* pool, const int** X, int n_samples,
+        int* preds_out, int* votes_out);
+    int tsetlin_inverted_predict_parallel_packed(const tsetlin_inverted_t* ix, threadpool_t* pool, const uint64_t* X,
+        int n_samples, int* preds_out, int* votes_out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TSETLIN_INVERTED_H */
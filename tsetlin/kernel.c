@@ -0,0 +1,123 @@
+#include "kernel.h"
+
+#include <stddef.h>
+
+#if defined(TSETLIN_HAVE_X86_KERNELS) && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+/* ---------- CPU feature detection ---------- */
+#if defined(TSETLIN_HAVE_X86_KERNELS)
+#if defined(_MSC_VER)
+/* OS must save the YMM (bits 1-2) / ZMM (bits 5-7) register state as well. */
+static bool _os_supports(unsigned long long xcr0_bits) {
+    int regs[4];
+    __cpuid(regs, 1);
+    if (!((regs[2] >> 27) & 1)) return false; /* OSXSAVE */
+    return (_xgetbv(0) & xcr0_bits) == xcr0_bits;
+}
+
+static bool _cpu_has_avx2(void) {
+    int regs[4];
+    __cpuid(regs, 0);
+    if (regs[0] < 7 || !_os_supports(0x6)) return false;
+    __cpuidex(regs, 7, 0);
+    return (regs[1] >> 5) & 1;
+}
+
+static bool _cpu_has_avx512f(void) {
+    int regs[4];
+    __cpuid(regs, 0);
+    if (regs[0] < 7 || !_os_supports(0xE6)) return false;
+    __cpuidex(regs, 7, 0);
+    return (regs[1] >> 16) & 1;
+}
+#else
+static bool _cpu_has_avx2(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+static bool _cpu_has_avx512f(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx512f");
+}
+#endif
+#endif
+
+/* ---------- Scalar kernel ---------- */
+int kernel_evaluate_scalar(const uint64_t* p_mask, const uint64_t* n_mask, const uint64_t* X, int n_words) {
+    for (int w = 0; w < n_words; ++w) {
+        /* An included X_i must be 1 and an included NOT X_i must have X_i == 0. */
+        if ((p_mask[w] & ~X[w]) | (n_mask[w] & X[w])) return 0;
+    }
+    return 1;
+}
+
+/* ---------- Dispatch ---------- */
+static int _evaluate_resolve(const uint64_t* p_mask, const uint64_t* n_mask, const uint64_t* X, int n_words);
+
+static kernel_evaluate_fn _active_evaluate = _evaluate_resolve;
+static kernel_id_t _active_id = KERNEL_SCALAR;
+
+static kernel_evaluate_fn _kernel_fn(kernel_id_t id) {
+    switch (id) {
+#if defined(TSETLIN_HAVE_X86_KERNELS)
+    case KERNEL_AVX2: return kernel_evaluate_avx2;
+    case KERNEL_AVX512: return kernel_evaluate_avx512;
+#endif
+    case KERNEL_SCALAR: return kernel_evaluate_scalar;
+    default: return NULL;
+    }
+}
+
+/* Pick the widest supported kernel. Concurrent first calls all store the same value. */
+static void _resolve_default(void) {
+    kernel_id_t best = KERNEL_SCALAR;
+    if (kernel_supported(KERNEL_AVX2)) best = KERNEL_AVX2;
+    if (kernel_supported(KERNEL_AVX512)) best = KERNEL_AVX512;
+    _active_id = best;
+    _active_evaluate = _kernel_fn(best);
+}
+
+static int _evaluate_resolve(const uint64_t* p_mask, const uint64_t* n_mask, const uint64_t* X, int n_words) {
+    _resolve_default();
+    return _active_evaluate(p_mask, n_mask, X, n_words);
+}
+
+int kernel_evaluate(const uint64_t* p_mask, const uint64_t* n_mask, const uint64_t* X, int n_words) {
+    return _active_evaluate(p_mask, n_mask, X, n_words);
+}
+
+bool kernel_supported(kernel_id_t id) {
+    switch (id) {
+    case KERNEL_SCALAR: return true;
+#if defined(TSETLIN_HAVE_X86_KERNELS)
+    case KERNEL_AVX2: return _cpu_has_avx2();
+    case KERNEL_AVX512: return _cpu_has_avx512f();
+#endif
+    default: return false;
+    }
+}
+
+bool kernel_select(kernel_id_t id) {
+    if (!kernel_supported(id)) return false;
+    _active_id = id;
+    _active_evaluate = _kernel_fn(id);
+    return true;
+}
+
+kernel_id_t kernel_active(void) {
+    if (_active_evaluate == _evaluate_resolve) _resolve_default();
+    return _active_id;
+}
+
+const char* kernel_name(kernel_id_t id) {
+    switch (id) {
+    case KERNEL_SCALAR: return "scalar";
+    case KERNEL_AVX2: return "avx2";
+    case KERNEL_AVX512: return "avx512";
+    default: return "unknown";
+    }
+}
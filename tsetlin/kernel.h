@@ -0,0 +1,49 @@
+#ifndef TSETLIN_KERNEL_H
+#define TSETLIN_KERNEL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /* Clause evaluation kernels over bit-packed input. The fastest kernel supported by the
+     * CPU is picked on first use; all kernels return identical results. */
+    typedef enum {
+        KERNEL_SCALAR = 0,
+        KERNEL_AVX2,
+        KERNEL_AVX512,
+        KERNEL_COUNT
+    } kernel_id_t;
+
+    /* Returns 1 if no included literal is violated by X, else 0 (see clause_evaluate_packed). */
+    typedef int (*kernel_evaluate_fn)(const uint64_t* p_mask, const uint64_t* n_mask, const uint64_t* X, int n_words);
+
+    /* Evaluate with the active kernel. */
+    int kernel_evaluate(const uint64_t* p_mask, const uint64_t* n_mask, const uint64_t* X, int n_words);
+
+    /* True if the kernel is compiled in and supported by the running CPU. */
+    bool kernel_supported(kernel_id_t id);
+
+    /* Force a kernel (e.g. for testing). Returns false and keeps the current one if unsupported. */
+    bool kernel_select(kernel_id_t id);
+
+    /* Currently active kernel (resolves the default on first call). */
+    kernel_id_t kernel_active(void);
+
+    /* Human-readable kernel name ("scalar", "avx2", "avx512"). */
+    const char* kernel_name(kernel_id_t id);
+
+    /* Individual kernels; the SIMD ones only exist in x86-64 builds. */
+    int kernel_evaluate_scalar(const uint64_t* p_mask, const uint64_t* n_mask, const uint64_t* X, int n_words);
+#if defined(TSETLIN_HAVE_X86_KERNELS)
+    int kernel_evaluate_avx2(const uint64_t* p_mask, const uint64_t* n_mask, const uint64_t* X, int n_words);
+    int kernel_evaluate_avx512(const uint64_t* p_mask, const uint64_t* n_mask, const uint64_t* X, int n_words);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TSETLIN_KERNEL_H */
@@ -0,0 +1,19 @@
+/* Built with AVX2 enabled (see CMakeLists.txt); only called after a CPUID check. */
+#include "kernel.h"
+
+#include <immintrin.h>
+
+int kernel_evaluate_avx2(const uint64_t* p_mask, const uint64_t* n_mask, const uint64_t* X, int n_words) {
+    int w = 0;
+    for (; w + 4 <= n_words; w += 4) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(X + w));
+        __m256i p = _mm256_loadu_si256((const __m256i*)(p_mask + w));
+        __m256i n = _mm256_loadu_si256((const __m256i*)(n_mask + w));
+        __m256i miss = _mm256_or_si256(_mm256_andnot_si256(x, p), _mm256_and_si256(n, x));
+        if (!_mm256_testz_si256(miss, miss)) return 0;
+    }
+    for (; w < n_words; ++w) {
+        if ((p_mask[w] & ~X[w]) | (n_mask[w] & X[w])) return 0;
+    }
+    return 1;
+}
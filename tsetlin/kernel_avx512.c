@@ -0,0 +1,19 @@
+/* Built with AVX-512F enabled (see CMakeLists.txt); only called after a CPUID check. */
+#include "kernel.h"
+
+#include <immintrin.h>
+
+int kernel_evaluate_avx512(const uint64_t* p_mask, const uint64_t* n_mask, const uint64_t* X, int n_words) {
+    for (int w = 0; w < n_words; w += 8) {
+        /* Masked loads handle the tail without a scalar loop. */
+        int left = n_words - w;
+        __mmask8 m = (left >= 8) ? (__mmask8)0xFF : (__mmask8)((1u << left) - 1u);
+        __m512i x = _mm512_maskz_loadu_epi64(m, X + w);
+        __m512i p = _mm512_maskz_loadu_epi64(m, p_mask + w);
+        __m512i n = _mm512_maskz_loadu_epi64(m, n_mask + w);
+        /* 0xCA selects n where x is set and p elsewhere: (p & ~x) | (n & x). */
+        __m512i miss = _mm512_ternarylogic_epi64(x, n, p, 0xCA);
+        if (_mm512_test_epi64_mask(miss, miss)) return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,100 @@
+#include "mapfile.h"
+
+#include <string.h>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(_WIN32)
+
+int mapfile_open(mapfile_t* m, const char* path) {
+    memset(m, 0, sizeof(mapfile_t));
+
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return -1;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return -1;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+        CloseHandle(file);
+        return -1;
+    }
+
+    const void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!data) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return -1;
+    }
+
+    m->data = data;
+    m->size = (size_t)size.QuadPart;
+    m->file = file;
+    m->mapping = mapping;
+    return 0;
+}
+
+void mapfile_close(mapfile_t* m) {
+    if (!m || !m->data) return;
+    UnmapViewOfFile(m->data);
+    CloseHandle((HANDLE)m->mapping);
+    CloseHandle((HANDLE)m->file);
+    memset(m, 0, sizeof(mapfile_t));
+}
+
+void mapfile_discard(const mapfile_t* m, size_t offset, size_t length) {
+    (void)m; (void)offset; (void)length;
+}
+
+#else
+
+int mapfile_open(mapfile_t* m, const char* path) {
+    memset(m, 0, sizeof(mapfile_t));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return -1;
+    }
+
+    void* data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); /* the mapping keeps the file referenced */
+    if (data == MAP_FAILED) return -1;
+
+    m->data = data;
+    m->size = (size_t)st.st_size;
+    return 0;
+}
+
+void mapfile_close(mapfile_t* m) {
+    if (!m || !m->data) return;
+    munmap((void*)m->data, m->size);
+    memset(m, 0, sizeof(mapfile_t));
+}
+
+/* Whole pages below offset + length only: the page holding the end is likely read next. */
+void mapfile_discard(const mapfile_t* m, size_t offset, size_t length) {
+    if (!m || !m->data || offset >= m->size) return;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t end = offset + length;
+    if (end > m->size) end = m->size;
+    size_t first = offset - offset % page;
+    size_t last = end - end % page;
+    if (last > first) madvise((void*)((const char*)m->data + first), last - first, MADV_DONTNEED);
+}
+
+#endif
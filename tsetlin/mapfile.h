@@ -0,0 +1,35 @@
+#ifndef TSETLIN_MAPFILE_H
+#define TSETLIN_MAPFILE_H
+
+/* Minimal portable read-only file mapping (mmap or Win32 file mappings). */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    typedef struct {
+        const void* data;
+        size_t size;
+#if defined(_WIN32)
+        void* file;    /* HANDLE */
+        void* mapping; /* HANDLE */
+#endif
+    } mapfile_t;
+
+    /* Map the whole file at path read-only (pages are shared between processes).
+     * Returns 0 on success, -1 on failure or for an empty file. */
+    int mapfile_open(mapfile_t* m, const char* path);
+    void mapfile_close(mapfile_t* m);
+
+    /* Hint that [offset, offset + length) will not be read again soon: its pages leave this
+     * process's working set. They stay valid and are read back from the file on access.
+     * A no-op where the platform has no such hint. */
+    void mapfile_discard(const mapfile_t* m, size_t offset, size_t length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TSETLIN_MAPFILE_H */
@@ -0,0 +1,239 @@
+#include "pipeline.h"
+#include "mapfile.h"
+#include "rng.h"
+#include "thread.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PIPELINE_SLOTS 2
+
+typedef struct {
+    uint64_t* X;   /* chunk_size packed rows */
+    int* y;        /* chunk_size labels */
+    int count;     /* samples in the chunk, -1 if the source failed */
+    int last;      /* last chunk of its epoch */
+} slot_t;
+
+struct pipeline {
+    int n_samples, n_features, n_words;
+    int chunk_size, n_chunks;
+    pipeline_read_fn read;
+    void* ctx;
+
+    /* Background thread state: only it touches rng and order. */
+    rng_t rng;
+    int* order;     /* chunk visiting order of the current epoch */
+    thread_t thread;
+    int started;
+
+    slot_t slots[PIPELINE_SLOTS];
+
+    /* Chunks are numbered in stream order; chunk k lives in slot k % PIPELINE_SLOTS. The thread
+     * fills chunk `produced` once fewer than PIPELINE_SLOTS chunks are unreleased. */
+    mutex_t lock;
+    cond_t ready;   /* produced moved */
+    cond_t space;   /* released moved, or shutdown */
+    int produced;   /* chunks filled */
+    int consumed;   /* chunks handed out by pipeline_next */
+    int released;   /* chunks the caller is done with */
+    int shutdown;
+
+    /* Caller side */
+    int end_pending; /* the chunk handed out last closed an epoch */
+    int failed;
+    double stall;
+};
+
+static size_t align8(size_t n) {
+    return (n + 7) & ~(size_t)7;
+}
+
+/* Read the chunk of stream position seq into s, shuffled. */
+static void fill_slot(pipeline_t* p, int seq, slot_t* s) {
+    int pos = seq % p->n_chunks;
+    if (pos == 0) {
+        for (int i = p->n_chunks - 1; i > 0; --i) {
+            int j = rng_below(&p->rng, i + 1);
+            int t = p->order[i]; p->order[i] = p->order[j]; p->order[j] = t;
+        }
+    }
+
+    int first = p->order[pos] * p->chunk_size;
+    int count = (p->n_samples - first < p->chunk_size) ? p->n_samples - first : p->chunk_size;
+    s->last = pos == p->n_chunks - 1;
+    if (p->read(p->ctx, first, count, s->X, s->y) != 0) {
+        s->count = -1;
+        return;
+    }
+
+    /* Fisher-Yates over the rows of the chunk */
+    for (int i = count - 1; i > 0; --i) {
+        int j = rng_below(&p->rng, i + 1);
+        uint64_t* a = s->X + (size_t)i * p->n_words;
+        uint64_t* b = s->X + (size_t)j * p->n_words;
+        for (int w = 0; w < p->n_words; ++w) {
+            uint64_t t = a[w]; a[w] = b[w]; b[w] = t;
+        }
+        int t = s->y[i]; s->y[i] = s->y[j]; s->y[j] = t;
+    }
+    s->count = count;
+}
+
+static void _producer_main(void* arg) {
+    pipeline_t* p = (pipeline_t*)arg;
+
+    mutex_lock(&p->lock);
+    for (;;) {
+        while (p->produced - p->released >= PIPELINE_SLOTS && !p->shutdown) cond_wait(&p->space, &p->lock);
+        if (p->shutdown) break;
+        int seq = p->produced;
+        mutex_unlock(&p->lock);
+
+        slot_t* s = &p->slots[seq % PIPELINE_SLOTS];
+        fill_slot(p, seq, s);
+
+        mutex_lock(&p->lock);
+        p->produced++;
+        cond_broadcast(&p->ready);
+        if (s->count < 0) break; /* the caller sees the failure; nothing more to read */
+    }
+    mutex_unlock(&p->lock);
+}
+
+pipeline_t* pipeline_new(int n_samples, int n_features, int chunk_size, pipeline_read_fn read, void* ctx, uint64_t seed) {
+    assert(n_samples >= 0);
+    assert(n_features > 0);
+    assert(chunk_size > 0);
+    assert(read != NULL);
+
+    int n_words = BITPACK_WORDS(n_features);
+    int n_chunks = (int)(((int64_t)n_samples + chunk_size - 1) / chunk_size);
+    if (chunk_size > n_samples && n_samples > 0) chunk_size = n_samples;
+
+    /* One allocation: the struct, the chunk order, then per slot its rows and labels. */
+    size_t rows_bytes = sizeof(uint64_t) * (size_t)chunk_size * n_words;
+    size_t labels_bytes = align8(sizeof(int) * (size_t)chunk_size);
+    size_t size = align8(sizeof(pipeline_t)) + align8(sizeof(int) * (size_t)n_chunks)
+        + PIPELINE_SLOTS * (rows_bytes + labels_bytes);
+    unsigned char* block = (unsigned char*)calloc(1, size);
+    if (!block) return NULL;
+
+    pipeline_t* p = (pipeline_t*)block;
+    block += align8(sizeof(pipeline_t));
+    p->n_samples = n_samples;
+    p->n_features = n_features;
+    p->n_words = n_words;
+    p->chunk_size = chunk_size;
+    p->n_chunks = n_chunks;
+    p->read = read;
+    p->ctx = ctx;
+    rng_seed(&p->rng, seed);
+
+    p->order = (int*)block;
+    block += align8(sizeof(int) * (size_t)n_chunks);
+    for (int i = 0; i < n_chunks; ++i) p->order[i] = i;
+    for (int i = 0; i < PIPELINE_SLOTS; ++i) {
+        p->slots[i].X = (uint64_t*)block;
+        p->slots[i].y = (int*)(block + rows_bytes);
+        block += rows_bytes + labels_bytes;
+    }
+
+    mutex_init(&p->lock);
+    cond_init(&p->ready);
+    cond_init(&p->space);
+
+    /* An empty source has nothing to prefetch: every pipeline_next returns 0. */
+    if (n_chunks > 0) {
+        if (thread_start(&p->thread, _producer_main, p) != 0) {
+            pipeline_free(p);
+            return NULL;
+        }
+        p->started = 1;
+    }
+    return p;
+}
+
+/* Dataset source: copy the rows out, then drop the pages a mapped cache read them from. */
+static int read_dataset(void* ctx, int first, int count, uint64_t* X, int* y) {
+    const dataset_t* ds = (const dataset_t*)ctx;
+    const uint64_t* rows = dataset_row(ds, first);
+    size_t rows_bytes = sizeof(uint64_t) * (size_t)count * ds->n_words;
+    memcpy(X, rows, rows_bytes);
+    memcpy(y, ds->y + first, sizeof(int) * (size_t)count);
+
+    if (ds->mapping) {
+        const mapfile_t* m = (const mapfile_t*)ds->mapping;
+        const unsigned char* base = (const unsigned char*)m->data;
+        mapfile_discard(m, (size_t)((const unsigned char*)rows - base), rows_bytes);
+        mapfile_discard(m, (size_t)((const unsigned char*)(ds->y + first) - base), sizeof(int) * (size_t)count);
+    }
+    return 0;
+}
+
+pipeline_t* pipeline_new_dataset(const dataset_t* ds, int chunk_size, uint64_t seed) {
+    assert(ds != NULL);
+    assert(ds->y != NULL);
+    return pipeline_new(ds->n_samples, ds->n_features, chunk_size, read_dataset, (void*)ds, seed);
+}
+
+void pipeline_free(pipeline_t* p) {
+    if (!p) return;
+
+    if (p->started) {
+        mutex_lock(&p->lock);
+        p->shutdown = 1;
+        cond_broadcast(&p->space);
+        mutex_unlock(&p->lock);
+        thread_join(p->thread);
+    }
+
+    cond_destroy(&p->space);
+    cond_destroy(&p->ready);
+    mutex_destroy(&p->lock);
+    free(p); /* buffers share the allocation */
+}
+
+int pipeline_next(pipeline_t* p, const uint64_t** X, const int** y) {
+    assert(p != NULL);
+    assert(X != NULL);
+    assert(y != NULL);
+    *X = NULL;
+    *y = NULL;
+    if (p->failed) return -1;
+    if (p->n_chunks == 0) return 0;
+
+    mutex_lock(&p->lock);
+    if (p->released < p->consumed) {
+        p->released++; /* the previous chunk is done with; its slot may be refilled */
+        cond_broadcast(&p->space);
+    }
+    if (p->end_pending) {
+        p->end_pending = 0;
+        mutex_unlock(&p->lock);
+        return 0;
+    }
+    if (p->produced == p->consumed) {
+        double t0 = thread_clock_seconds();
+        while (p->produced == p->consumed) cond_wait(&p->ready, &p->lock);
+        p->stall += thread_clock_seconds() - t0;
+    }
+    const slot_t* s = &p->slots[p->consumed % PIPELINE_SLOTS];
+    p->consumed++;
+    mutex_unlock(&p->lock);
+
+    if (s->count < 0) {
+        p->failed = 1;
+        return -1;
+    }
+    p->end_pending = s->last;
+    *X = s->X;
+    *y = s->y;
+    return s->count;
+}
+
+double pipeline_stall_seconds(const pipeline_t* p) {
+    assert(p != NULL);
+    return p->stall;
+}
@@ -0,0 +1,54 @@
+#ifndef TSETLIN_PIPELINE_H
+#define TSETLIN_PIPELINE_H
+
+#include <stdint.h>
+
+#include "dataset.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /*
+     * Double-buffered training data feed. Samples are read from a source in chunks of chunk_size
+     * consecutive samples; a background thread fills the next chunk while the caller trains on the
+     * current one, so at most two chunks are ever in memory and the source may be larger than RAM.
+     *
+     * Every epoch visits the chunks in a fresh random order and shuffles the samples within each
+     * chunk: the shuffle window is bounded by chunk_size. The order is a function of the seed only,
+     * so runs are reproducible whatever the I/O timing. The feed runs across epochs without a
+     * pause: the first chunk of the next epoch is prefetched while the last one trains.
+     */
+    typedef struct pipeline pipeline_t;
+
+    /* Source callback: write samples [first, first + count) of the source into X (count packed
+     * rows of BITPACK_WORDS(n_features) words) and y (count labels). Runs on the pipeline thread.
+     * Returns 0 on success, -1 on failure. */
+    typedef int (*pipeline_read_fn)(void* ctx, int first, int count, uint64_t* X, int* y);
+
+    /* Feed n_samples samples from read(ctx, ...). Returns NULL on allocation or thread failure.
+     * Free with pipeline_free. */
+    pipeline_t* pipeline_new(int n_samples, int n_features, int chunk_size, pipeline_read_fn read, void* ctx, uint64_t seed);
+
+    /* Feed a dataset, which must have labels and outlive the pipeline. For a mapped cache
+     * (dataset_cache_open), the pages of a chunk leave the working set once it is copied. */
+    pipeline_t* pipeline_new_dataset(const dataset_t* ds, int chunk_size, uint64_t seed);
+
+    /* Stop the background thread and free the buffers. */
+    void pipeline_free(pipeline_t* p);
+
+    /*
+     * Next chunk of the current epoch: *X and *y receive its packed rows and labels, valid until
+     * the next call. Returns the number of samples, 0 once at the end of every epoch (the next
+     * call starts the following epoch), or -1 if the source failed.
+     */
+    int pipeline_next(pipeline_t* p, const uint64_t** X, const int** y);
+
+    /* Seconds pipeline_next has spent waiting for the background thread so far. */
+    double pipeline_stall_seconds(const pipeline_t* p);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TSETLIN_PIPELINE_H */
@@ -0,0 +1,62 @@
+#include "rng.h"
+
+#include <assert.h>
+#include <math.h>
+#include <stddef.h>
+
+void rng_seed(rng_t* rng, uint64_t seed) {
+    assert(rng != NULL);
+
+    /* splitmix64: spreads any seed (including 0) over a non-zero state */
+    for (int i = 0; i < 4; ++i) {
+        uint64_t z = (seed += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        rng->s[i] = z ^ (z >> 31);
+    }
+}
+
+void rng_jump(rng_t* rng) {
+    static const uint64_t JUMP[] = { 0x180ec6d33cfd0abaull, 0xd5a61266f0c9392cull, 0xa9582618e03fc9aaull, 0x39abdc4529b1661cull };
+    assert(rng != NULL);
+
+    uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    for (int i = 0; i < 4; ++i) {
+        for (int b = 0; b < 64; ++b) {
+            if (JUMP[i] & ((uint64_t)1 << b)) {
+                s0 ^= rng->s[0];
+                s1 ^= rng->s[1];
+                s2 ^= rng->s[2];
+                s3 ^= rng->s[3];
+            }
+            rng_next(rng);
+        }
+    }
+    rng->s[0] = s0;
+    rng->s[1] = s1;
+    rng->s[2] = s2;
+    rng->s[3] = s3;
+}
+
+void rng_split(rng_t* rng, rng_t* child) {
+    assert(rng != NULL);
+    assert(child != NULL);
+    *child = *rng;
+    rng_jump(rng);
+}
+
+uint64_t rng_threshold(double p) {
+    if (!(p > 0.0)) return 0; /* also catches NaN */
+    if (p >= 1.0) return RNG_ONE;
+    return (uint64_t)(p * (double)RNG_ONE);
+}
+
+int rng_geometric(rng_t* rng, double log_q, int limit) {
+    assert(rng != NULL);
+    if (!(log_q < 0.0)) return limit; /* p <= 0: never fires */
+
+    /* u uniform in (0, 1]; p == 1 gives log_q == -inf and a gap of 0 */
+    double u = (double)((rng_next(rng) >> 11) + 1) * (1.0 / 9007199254740992.0);
+    double gap = floor(log(u) / log_q);
+    return (gap < (double)limit) ? (int)gap : limit;
+}
@@ -0,0 +1,106 @@
+#ifndef TSETLIN_RNG_H
+#define TSETLIN_RNG_H
+
+#include <stdint.h>
+
+#include "stats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /*
+     * xoshiro256** generator. Every model and every training worker owns its own rng_t, so draws
+     * need no locking and a given seed reproduces the same run.
+     */
+    typedef struct {
+        uint64_t s[4];
+    } rng_t;
+
+    /* Bernoulli thresholds are probabilities scaled to 2^32: a draw succeeds when the top 32 bits
+     * of the next output are below the threshold, so RNG_ONE always succeeds and 0 never does. */
+#define RNG_ONE ((uint64_t)1 << 32)
+
+    /* Seed the state from a single 64-bit value (expanded with splitmix64). */
+    void rng_seed(rng_t* rng, uint64_t seed);
+
+    /* Advance rng by 2^128 draws. */
+    void rng_jump(rng_t* rng);
+
+    /* Hand the current stream to child and move rng past it, giving non-overlapping streams. */
+    void rng_split(rng_t* rng, rng_t* child);
+
+    /* Threshold for probability p, clamped to [0, 1]. */
+    uint64_t rng_threshold(double p);
+
+    /* Number of failures before the first success of Bernoulli(p) trials, log_q = log(1 - p),
+     * capped at limit. Used to jump straight to the next firing event of a rare draw. */
+    int rng_geometric(rng_t* rng, double log_q, int limit);
+
+    static inline uint64_t rng_rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    static inline uint64_t rng_next(rng_t* rng) {
+        uint64_t* s = rng->s;
+        uint64_t result = rng_rotl(s[1] * 5, 7) * 9;
+        TSETLIN_STAT_ADD(rng_draws, 1);
+        uint64_t t = s[1] << 17;
+
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = rng_rotl(s[3], 45);
+
+        return result;
+    }
+
+    /* True with probability threshold / 2^32 (see rng_threshold). */
+    static inline int rng_bernoulli(rng_t* rng, uint64_t threshold) {
+        return (rng_next(rng) >> 32) < threshold;
+    }
+
+    /* Default precision of rng_mask: the full resolution of thresholds. */
+#define RNG_MASK_PRECISION 32
+
+    /*
+     * 64 independent Bernoulli draws at once: bit i of the result is set with probability
+     * threshold / 2^32 truncated to its top precision bits (1 .. 32).
+     *
+     * Each bit compares a uniform number U, built one random word per binary digit, against the
+     * expansion 0.b1 b2 ... of the probability, most significant digit first: a digit where U has
+     * 0 and p has 1 decides the bit as set, the opposite decides it as clear, and equal digits
+     * leave it open. Half of the open bits are decided per word, so a mask costs about 8 rng_next
+     * calls instead of 64 however high the precision; precision caps that cost (and the number of
+     * words) for a coarser probability, a multiple of 2^-precision rounded down.
+     */
+    static inline uint64_t rng_mask(rng_t* rng, uint64_t threshold, int precision) {
+        if (threshold >= RNG_ONE) return ~(uint64_t)0;
+        uint64_t mask = 0;
+        uint64_t open = ~(uint64_t)0;
+        for (int i = 31; i >= 32 - precision && open; --i) {
+            if ((threshold & (((uint64_t)2 << i) - 1)) == 0) break; /* remaining digits of p are 0 */
+            uint64_t r = rng_next(rng);
+            if ((threshold >> i) & 1) {
+                mask |= open & ~r;
+                open &= r;
+            }
+            else {
+                open &= ~r;
+            }
+        }
+        return mask;
+    }
+
+    /* Uniform integer in [0, n), n > 0 (multiply-shift, no division). */
+    static inline int rng_below(rng_t* rng, int n) {
+        return (int)(((rng_next(rng) >> 32) * (uint64_t)n) >> 32);
+    }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TSETLIN_RNG_H */
@@ -0,0 +1,58 @@
+#include "sparse.h"
+#include "bitpack.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+int sparse_from_dense(const int* X, int n_features, int* active) {
+    assert(X != NULL);
+    assert(active != NULL);
+
+    int n_active = 0;
+    for (int i = 0; i < n_features; ++i) {
+        if (X[i]) active[n_active++] = i;
+    }
+    return n_active;
+}
+
+/* splitmix64 finalizer: every key bit affects every output bit. */
+static uint64_t mix64(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static int compare_int(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+int sparse_hash(const uint64_t* keys, int n_keys, int width, int* active) {
+    assert(keys != NULL || n_keys == 0);
+    assert(active != NULL);
+    assert(width > 0);
+
+    /* Multiply-shift reduction of the mixed key to [0, width), as rng_below. */
+    for (int k = 0; k < n_keys; ++k) {
+        active[k] = (int)(((mix64(keys[k]) >> 32) * (uint64_t)width) >> 32);
+    }
+    qsort(active, (size_t)n_keys, sizeof(int), compare_int);
+
+    int n_active = 0;
+    for (int k = 0; k < n_keys; ++k) {
+        if (n_active == 0 || active[k] != active[n_active - 1]) active[n_active++] = active[k];
+    }
+    return n_active;
+}
+
+void sparse_scatter(const sparse_sample_t* x, uint64_t* words) {
+    assert(x != NULL);
+    assert(words != NULL);
+    for (int k = 0; k < x->n_active; ++k) bitpack_set(words, x->active[k]);
+}
+
+void sparse_clear(const sparse_sample_t* x, uint64_t* words) {
+    assert(x != NULL);
+    assert(words != NULL);
+    for (int k = 0; k < x->n_active; ++k) words[x->active[k] >> 6] = 0;
+}
@@ -0,0 +1,41 @@
+#ifndef TSETLIN_SPARSE_H
+#define TSETLIN_SPARSE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /*
+     * Sparse binary sample: the indices of the features that are 1, sorted ascending and distinct.
+     * Every other feature is 0. For high-dimensional inputs with few bits set this replaces the
+     * dense int row (4 bytes per feature) with 4 bytes per active feature.
+     */
+    typedef struct {
+        const int* active;
+        int n_active;
+    } sparse_sample_t;
+
+    /* Collect the active features of dense X (length n_features, values 0 or 1) into active
+     * (capacity n_features). Returns the number written. */
+    int sparse_from_dense(const int* X, int n_features, int* active);
+
+    /*
+     * Feature hashing: map n_keys arbitrary 64-bit feature ids (e.g. token or event ids from an
+     * unbounded vocabulary) into [0, width), then sort and drop duplicates, as a sparse_sample_t
+     * over width features expects. active needs n_keys slots. Returns the number of active
+     * features. The mapping is a fixed function of key and width, the same across runs and hosts.
+     */
+    int sparse_hash(const uint64_t* keys, int n_keys, int width, int* active);
+
+    /* Set the active bits of x in packed words (see bitpack.h), and zero the words holding them
+     * again. A zeroed buffer is thus reused across samples at O(n_active) per sample. */
+    void sparse_scatter(const sparse_sample_t* x, uint64_t* words);
+    void sparse_clear(const sparse_sample_t* x, uint64_t* words);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TSETLIN_SPARSE_H */
@@ -0,0 +1,130 @@
+#include "stats.h"
+#include "thread.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Dump settings are only touched by the thread driving training. */
+static FILE* dump_file;
+static double dump_interval;
+static double dump_last;
+static double dump_start;
+
+#ifdef TSETLIN_STATS
+
+/* Per-thread blocks, never freed: counts of finished threads stay in the sums. */
+typedef struct stats_block {
+    tsetlin_stats_t stats;
+    struct stats_block* next;
+} stats_block_t;
+
+TSETLIN_THREAD_LOCAL tsetlin_stats_t* tsetlin_stats_local;
+
+static stats_block_t* blocks;
+static volatile int blocks_lock; /* spin lock: taken to register a thread or to sum or reset */
+static tsetlin_stats_t overflow;  /* shared fallback if a block cannot be allocated */
+
+static void lock_blocks(void) {
+    while (thread_atomic_exchange(&blocks_lock, 1) != 0) {
+    }
+}
+
+static void unlock_blocks(void) {
+    thread_atomic_exchange(&blocks_lock, 0);
+}
+
+tsetlin_stats_t* tsetlin_stats_attach(void) {
+    stats_block_t* b = (stats_block_t*)calloc(1, sizeof(stats_block_t));
+    if (!b) return tsetlin_stats_local = &overflow;
+
+    lock_blocks();
+    b->next = blocks;
+    blocks = b;
+    unlock_blocks();
+    return tsetlin_stats_local = &b->stats;
+}
+
+int tsetlin_stats_enabled(void) {
+    return 1;
+}
+
+static void add_stats(tsetlin_stats_t* out, const tsetlin_stats_t* s) {
+    out->evaluations += s->evaluations;
+    out->evaluations_false += s->evaluations_false;
+    out->evaluation_words += s->evaluation_words;
+    out->include_flips += s->include_flips;
+    out->exclude_flips += s->exclude_flips;
+    out->rng_draws += s->rng_draws;
+    out->type1_clauses += s->type1_clauses;
+    out->type2_clauses += s->type2_clauses;
+    out->type1_events += s->type1_events;
+    out->type2_events += s->type2_events;
+    for (int c = 0; c < TSETLIN_STATS_MAX_CLASSES; ++c) {
+        out->class_type1[c] += s->class_type1[c];
+        out->class_type2[c] += s->class_type2[c];
+    }
+    for (int p = 0; p < TSETLIN_PHASE_COUNT; ++p) out->phase_seconds[p] += s->phase_seconds[p];
+}
+
+void tsetlin_stats_snapshot(tsetlin_stats_t* out) {
+    memset(out, 0, sizeof(tsetlin_stats_t));
+    lock_blocks();
+    for (const stats_block_t* b = blocks; b; b = b->next) add_stats(out, &b->stats);
+    unlock_blocks();
+    add_stats(out, &overflow);
+}
+
+void tsetlin_stats_reset(void) {
+    lock_blocks();
+    for (stats_block_t* b = blocks; b; b = b->next) memset(&b->stats, 0, sizeof(tsetlin_stats_t));
+    unlock_blocks();
+    memset(&overflow, 0, sizeof(overflow));
+    dump_start = dump_last = thread_clock_seconds();
+}
+
+#else
+
+int tsetlin_stats_enabled(void) {
+    return 0;
+}
+
+void tsetlin_stats_snapshot(tsetlin_stats_t* out) {
+    memset(out, 0, sizeof(tsetlin_stats_t));
+}
+
+void tsetlin_stats_reset(void) {
+    dump_start = dump_last = thread_clock_seconds();
+}
+
+#endif
+
+void tsetlin_stats_print(FILE* f, const tsetlin_stats_t* s, double elapsed) {
+    double n = s->evaluations ? (double)s->evaluations : 1.0;
+    fprintf(f, "tsetlin stats %.1fs: evaluations %llu (%.1f%% false, %.2f words deep), "
+        "flips +%llu/-%llu, rng draws %llu, Type I %llu on %llu clauses, Type II %llu on %llu clauses, "
+        "evaluate %.3fs, feedback %.3fs, predict %.3fs\n",
+        elapsed, (unsigned long long)s->evaluations, 100.0 * (double)s->evaluations_false / n,
+        (double)s->evaluation_words / n,
+        (unsigned long long)s->include_flips, (unsigned long long)s->exclude_flips, (unsigned long long)s->rng_draws,
+        (unsigned long long)s->type1_events, (unsigned long long)s->type1_clauses,
+        (unsigned long long)s->type2_events, (unsigned long long)s->type2_clauses,
+        s->phase_seconds[TSETLIN_PHASE_EVALUATE], s->phase_seconds[TSETLIN_PHASE_FEEDBACK], s->phase_seconds[TSETLIN_PHASE_PREDICT]);
+    fflush(f);
+}
+
+void tsetlin_stats_dump_every(FILE* f, double interval) {
+    dump_file = (interval > 0.0) ? f : NULL;
+    dump_interval = interval;
+    dump_start = dump_last = thread_clock_seconds();
+}
+
+void tsetlin_stats_poll(void) {
+    if (!dump_file) return;
+    double now = thread_clock_seconds();
+    if (now - dump_last < dump_interval) return;
+    dump_last = now;
+
+    tsetlin_stats_t s;
+    tsetlin_stats_snapshot(&s);
+    tsetlin_stats_print(dump_file, &s, now - dump_start);
+}
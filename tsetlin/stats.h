@@ -0,0 +1,111 @@
+#ifndef TSETLIN_STATS_H
+#define TSETLIN_STATS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef TSETLIN_STATS
+#include "thread.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    /*
+     * Training instrumentation, compiled in with TSETLIN_STATS (CMake option of the same name) and
+     * compiled out otherwise: the counters below then cost nothing, the functions still link and
+     * report zeros, and tsetlin_stats_enabled() returns 0.
+     *
+     * Every thread counts into a block of its own, without atomics or locks; a snapshot sums the
+     * blocks of all threads that ever counted. Take snapshots while no thread is training, e.g.
+     * between epochs: a snapshot taken during training may see counts mid-update.
+     */
+
+#define TSETLIN_STATS_MAX_CLASSES 64 /* per-class breakdown; later classes only count in type1/type2_events */
+
+    typedef enum {
+        TSETLIN_PHASE_EVALUATE = 0, /* clause evaluation of training steps */
+        TSETLIN_PHASE_FEEDBACK,     /* clause updates of training steps */
+        TSETLIN_PHASE_PREDICT,      /* tsetlin_predict* */
+        TSETLIN_PHASE_COUNT
+    } tsetlin_phase_t;
+
+    typedef struct {
+        /* clause_evaluate_packed and bitslice_evaluate calls: every training step and the tsetlin_predict*
+         * paths except tsetlin_predict_sparse. clause_evaluate, clause_evaluate_sparse and the compact
+         * and inverted predictors do not count. */
+        uint64_t evaluations;
+        uint64_t evaluations_false;     /* of which returned 0 */
+        uint64_t evaluation_words;      /* words up to and including the first violated one: early-exit depth */
+        uint64_t include_flips;         /* automata crossing into include */
+        uint64_t exclude_flips;         /* automata crossing into exclude */
+        uint64_t rng_draws;             /* rng_next calls */
+        uint64_t type1_clauses;         /* clause updates with Type I feedback */
+        uint64_t type2_clauses;         /* clause updates with Type II feedback */
+        uint64_t type1_events;          /* automaton Type I events, all classes */
+        uint64_t type2_events;          /* automaton Type II events, all classes */
+        uint64_t class_type1[TSETLIN_STATS_MAX_CLASSES]; /* type1_events of the first classes, per class */
+        uint64_t class_type2[TSETLIN_STATS_MAX_CLASSES]; /* type2_events of the first classes, per class */
+        double phase_seconds[TSETLIN_PHASE_COUNT]; /* summed over threads */
+    } tsetlin_stats_t;
+
+    /* 1 if the library was built with TSETLIN_STATS. */
+    int tsetlin_stats_enabled(void);
+
+    /* Sum the counts of all threads into out. */
+    void tsetlin_stats_snapshot(tsetlin_stats_t* out);
+
+    /* Zero the counts of all threads, e.g. at the start of an epoch. */
+    void tsetlin_stats_reset(void);
+
+    /* One line summary of s, elapsed seconds of wall time, to f. */
+    void tsetlin_stats_print(FILE* f, const tsetlin_stats_t* s, double elapsed);
+
+    /*
+     * Periodic dump: print a snapshot to f every interval seconds of training (interval <= 0 or
+     * f NULL turns it off). Training checks the clock between samples, so dumps come from the
+     * training thread at sample granularity; nothing runs in the background.
+     */
+    void tsetlin_stats_dump_every(FILE* f, double interval);
+
+    /* Dump if the interval has passed; called by tsetlin_fit_parallel. */
+    void tsetlin_stats_poll(void);
+
+#ifdef TSETLIN_STATS
+
+#if defined(_MSC_VER)
+#define TSETLIN_THREAD_LOCAL __declspec(thread)
+#else
+#define TSETLIN_THREAD_LOCAL __thread
+#endif
+
+    /* Block of the calling thread; tsetlin_stats_attach registers one on first use. */
+    extern TSETLIN_THREAD_LOCAL tsetlin_stats_t* tsetlin_stats_local;
+    tsetlin_stats_t* tsetlin_stats_attach(void);
+
+    static inline tsetlin_stats_t* tsetlin_stats_counters(void) {
+        tsetlin_stats_t* s = tsetlin_stats_local;
+        return s ? s : tsetlin_stats_attach();
+    }
+
+#define TSETLIN_STAT_ADD(field, n) (tsetlin_stats_counters()->field += (uint64_t)(n))
+#define TSETLIN_STAT_CLASS_ADD(field, class_id, n) \
+    ((class_id) < TSETLIN_STATS_MAX_CLASSES ? (void)(tsetlin_stats_counters()->field[class_id] += (uint64_t)(n)) : (void)0)
+#define TSETLIN_STAT_TIMER(name) double name = thread_clock_seconds()
+#define TSETLIN_STAT_PHASE(phase, since) (tsetlin_stats_counters()->phase_seconds[phase] += thread_clock_seconds() - (since))
+
+#else
+
+#define TSETLIN_STAT_ADD(field, n) ((void)0)
+#define TSETLIN_STAT_CLASS_ADD(field, class_id, n) ((void)0)
+#define TSETLIN_STAT_TIMER(name) ((void)0)
+#define TSETLIN_STAT_PHASE(phase, since) ((void)0)
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TSETLIN_STATS_H */
@@ -0,0 +1,101 @@
+#include "thread.h"
+
+#include <stdlib.h>
+
+#if !defined(_WIN32)
+#include <time.h>
+#include <unistd.h>
+#endif
+
+typedef struct {
+    thread_fn fn;
+    void* arg;
+} thread_start_t;
+
+#if defined(_WIN32)
+static DWORD WINAPI _thread_main(LPVOID p) {
+#else
+static void* _thread_main(void* p) {
+#endif
+    thread_start_t start = *(thread_start_t*)p;
+    free(p);
+    start.fn(start.arg);
+    return 0;
+}
+
+int thread_start(thread_t* t, thread_fn fn, void* arg) {
+    thread_start_t* start = (thread_start_t*)malloc(sizeof(thread_start_t));
+    if (!start) return -1;
+    start->fn = fn;
+    start->arg = arg;
+#if defined(_WIN32)
+    *t = CreateThread(NULL, 0, _thread_main, start, 0, NULL);
+    if (*t == NULL) { free(start); return -1; }
+#else
+    if (pthread_create(t, NULL, _thread_main, start) != 0) { free(start); return -1; }
+#endif
+    return 0;
+}
+
+void thread_join(thread_t t) {
+#if defined(_WIN32)
+    WaitForSingleObject(t, INFINITE);
+    CloseHandle(t);
+#else
+    pthread_join(t, NULL);
+#endif
+}
+
+int thread_cpu_count(void) {
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (info.dwNumberOfProcessors > 0) ? (int)info.dwNumberOfProcessors : 1;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return (n > 0) ? (int)n : 1;
+#endif
+}
+
+double thread_clock_seconds(void) {
+#if defined(_WIN32)
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (double)now.QuadPart / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+#if defined(_WIN32)
+void mutex_init(mutex_t* m) { InitializeCriticalSection(m); }
+void mutex_destroy(mutex_t* m) { DeleteCriticalSection(m); }
+void mutex_lock(mutex_t* m) { EnterCriticalSection(m); }
+void mutex_unlock(mutex_t* m) { LeaveCriticalSection(m); }
+
+void cond_init(cond_t* c) { InitializeConditionVariable(c); }
+void cond_destroy(cond_t* c) { (void)c; }
+void cond_wait(cond_t* c, mutex_t* m) { SleepConditionVariableCS(c, m, INFINITE); }
+void cond_broadcast(cond_t* c) { WakeAllConditionVariable(c); }
+
+int thread_atomic_add(volatile int* p, int v) { return (int)InterlockedExchangeAdd((volatile LONG*)p, (LONG)v); }
+int thread_atomic_load(volatile int* p) { return (int)InterlockedCompareExchange((volatile LONG*)p, 0, 0); }
+int thread_atomic_exchange(volatile int* p, int v) { return (int)InterlockedExchange((volatile LONG*)p, (LONG)v); }
+#else
+void mutex_init(mutex_t* m) { pthread_mutex_init(m, NULL); }
+void mutex_destroy(mutex_t* m) { pthread_mutex_destroy(m); }
+void mutex_lock(mutex_t* m) { pthread_mutex_lock(m); }
+void mutex_unlock(mutex_t* m) { pthread_mutex_unlock(m); }
+
+void cond_init(cond_t* c) { pthread_cond_init(c, NULL); }
+void cond_destroy(cond_t* c) { pthread_cond_destroy(c); }
+void cond_wait(cond_t* c, mutex_t* m) { pthread_cond_wait(c, m); }
+void cond_broadcast(cond_t* c) { pthread_cond_broadcast(c); }
+
+int thread_atomic_add(volatile int* p, int v) { return __atomic_fetch_add(p, v, __ATOMIC_SEQ_CST); }
+int thread_atomic_load(volatile int* p) { return __atomic_load_n(p, __ATOMIC_SEQ_CST); }
+int thread_atomic_exchange(volatile int* p, int v) { return __atomic_exchange_n(p, v, __ATOMIC_SEQ_CST); }
+#endif
@@ -0,0 +1,57 @@
+#ifndef TSETLIN_THREAD_H
+#define TSETLIN_THREAD_H
+
+/* Minimal portable threading layer (pthreads or Win32) used by the thread pool. */
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_WIN32)
+    typedef HANDLE thread_t;
+    typedef CRITICAL_SECTION mutex_t;
+    typedef CONDITION_VARIABLE cond_t;
+#else
+    typedef pthread_t thread_t;
+    typedef pthread_mutex_t mutex_t;
+    typedef pthread_cond_t cond_t;
+#endif
+
+    typedef void (*thread_fn)(void* arg);
+
+    /* Start fn(arg) on a new thread. Returns 0 on success. */
+    int thread_start(thread_t* t, thread_fn fn, void* arg);
+    void thread_join(thread_t t);
+
+    /* Number of online CPUs (at least 1). */
+    int thread_cpu_count(void);
+
+    /* Monotonic wall-clock time in seconds. */
+    double thread_clock_seconds(void);
+
+    void mutex_init(mutex_t* m);
+    void mutex_destroy(mutex_t* m);
+    void mutex_lock(mutex_t* m);
+    void mutex_unlock(mutex_t* m);
+
+    void cond_init(cond_t* c);
+    void cond_destroy(cond_t* c);
+    void cond_wait(cond_t* c, mutex_t* m);
+    void cond_broadcast(cond_t* c);
+
+    /* Sequentially consistent atomics on plain ints. */
+    int thread_atomic_add(volatile int* p, int v); /* returns the previous value */
+    int thread_atomic_load(volatile int* p);
+    int thread_atomic_exchange(volatile int* p, int v); /* returns the previous value */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TSETLIN_THREAD_H */
@@ -0,0 +1,168 @@
+#include "threadpool.h"
+#include "thread.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+/* Per-worker share of the current job, padded to its own cache line. */
+typedef struct {
+    volatile int next;
+    int end;
+    char pad[64 - 2 * sizeof(int)];
+} range_t;
+
+struct threadpool {
+    int n_threads;
+    thread_t* threads; /* n_threads - 1 background workers */
+
+    mutex_t lock;
+    cond_t wake;
+    cond_t done;
+    int generation; /* bumped for every submitted job */
+    int pending;    /* background workers still running the current job */
+    int shutdown;
+
+    /* Current job */
+    threadpool_task_fn fn;
+    void* ctx;
+    int grain;
+    range_t* ranges; /* length n_threads */
+};
+
+/* Claim grain-sized chunks from range r until it is exhausted. */
+static void _drain(threadpool_t* pool, range_t* r, int worker) {
+    for (;;) {
+        int begin = thread_atomic_add(&r->next, pool->grain);
+        if (begin >= r->end) return;
+        int end = (r->end - begin < pool->grain) ? r->end : begin + pool->grain;
+        pool->fn(pool->ctx, begin, end, worker);
+    }
+}
+
+static void _run_worker(threadpool_t* pool, int worker) {
+    _drain(pool, &pool->ranges[worker], worker);
+    /* Own share done: steal from the others, starting with the next worker. */
+    for (int k = 1; k < pool->n_threads; ++k) {
+        _drain(pool, &pool->ranges[(worker + k) % pool->n_threads], worker);
+    }
+}
+
+typedef struct {
+    threadpool_t* pool;
+    int worker;
+} worker_arg_t;
+
+static void _worker_main(void* arg) {
+    threadpool_t* pool = ((worker_arg_t*)arg)->pool;
+    int worker = ((worker_arg_t*)arg)->worker;
+    free(arg);
+
+    /* Workers are started before any job exists, so generation 0 means "nothing to do yet"
+     * even if the first job was submitted before this thread got scheduled. */
+    int seen = 0;
+    mutex_lock(&pool->lock);
+    for (;;) {
+        while (pool->generation == seen && !pool->shutdown) cond_wait(&pool->wake, &pool->lock);
+        if (pool->shutdown) break;
+        seen = pool->generation;
+        mutex_unlock(&pool->lock);
+
+        _run_worker(pool, worker);
+
+        mutex_lock(&pool->lock);
+        if (--pool->pending == 0) cond_broadcast(&pool->done);
+    }
+    mutex_unlock(&pool->lock);
+}
+
+threadpool_t* threadpool_new(int n_threads) {
+    if (n_threads <= 0) n_threads = thread_cpu_count();
+
+    threadpool_t* pool = (threadpool_t*)calloc(1, sizeof(threadpool_t));
+    if (!pool) return NULL;
+
+    pool->n_threads = n_threads;
+    pool->ranges = (range_t*)calloc(n_threads, sizeof(range_t));
+    pool->threads = (thread_t*)calloc(n_threads, sizeof(thread_t));
+    if (!pool->ranges || !pool->threads) {
+        free(pool->ranges);
+        free(pool->threads);
+        free(pool);
+        return NULL;
+    }
+
+    mutex_init(&pool->lock);
+    cond_init(&pool->wake);
+    cond_init(&pool->done);
+
+    /* Worker 0 is the submitting thread. */
+    for (int i = 1; i < n_threads; ++i) {
+        worker_arg_t* arg = (worker_arg_t*)malloc(sizeof(worker_arg_t));
+        if (arg) {
+            arg->pool = pool;
+            arg->worker = i;
+        }
+        if (!arg || thread_start(&pool->threads[i - 1], _worker_main, arg) != 0) {
+            free(arg);
+            pool->n_threads = i; /* keep the workers that did start */
+            break;
+        }
+    }
+
+    return pool;
+}
+
+void threadpool_free(threadpool_t* pool) {
+    if (!pool) return;
+
+    mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    cond_broadcast(&pool->wake);
+    mutex_unlock(&pool->lock);
+
+    for (int i = 1; i < pool->n_threads; ++i) {
+        thread_join(pool->threads[i - 1]);
+    }
+
+    cond_destroy(&pool->done);
+    cond_destroy(&pool->wake);
+    mutex_destroy(&pool->lock);
+    free(pool->threads);
+    free(pool->ranges);
+    free(pool);
+}
+
+int threadpool_size(const threadpool_t* pool) {
+    return pool ? pool->n_threads : 1;
+}
+
+void threadpool_parallel_for(threadpool_t* pool, int n_items, int grain, threadpool_task_fn fn, void* ctx) {
+    assert(fn != NULL);
+    if (n_items <= 0) return;
+    if (!pool || pool->n_threads == 1) {
+        fn(ctx, 0, n_items, 0);
+        return;
+    }
+    if (grain < 1) grain = 1;
+
+    mutex_lock(&pool->lock);
+    pool->fn = fn;
+    pool->ctx = ctx;
+    pool->grain = grain;
+    int share = (n_items + pool->n_threads - 1) / pool->n_threads;
+    for (int i = 0; i < pool->n_threads; ++i) {
+        int begin = i * share;
+        pool->ranges[i].next = (begin < n_items) ? begin : n_items;
+        pool->ranges[i].end = (begin + share < n_items) ? begin + share : n_items;
+    }
+    pool->pending = pool->n_threads - 1;
+    pool->generation++;
+    cond_broadcast(&pool->wake);
+    mutex_unlock(&pool->lock);
+
+    _run_worker(pool, 0);
+
+    mutex_lock(&pool->lock);
+    while (pool->pending > 0) cond_wait(&pool->done, &pool->lock);
+    mutex_unlock(&pool->lock);
+}
@@ -0,0 +1,37 @@
+#ifndef TSETLIN_THREADPOOL_H
+#define TSETLIN_THREADPOOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+    typedef struct threadpool threadpool_t;
+
+    /* Process items [begin, end). worker is in [0, threadpool_size(pool)) and is stable for the
+     * duration of the call, so it can index per-worker scratch buffers. */
+    typedef void (*threadpool_task_fn)(void* ctx, int begin, int end, int worker);
+
+    /* Create a pool running n_threads workers in total (the calling thread counts as one).
+     * n_threads <= 0 uses the number of online CPUs. Caller must free with threadpool_free(). */
+    threadpool_t* threadpool_new(int n_threads);
+
+    /* Stop and join the workers and free the pool. */
+    void threadpool_free(threadpool_t* pool);
+
+    /* Total number of workers, including the calling thread. A NULL pool has size 1. */
+    int threadpool_size(const threadpool_t* pool);
+
+    /*
+     * Run fn over [0, n_items) and return when every item is done.
+     * Each worker starts on its own contiguous share and claims grain items at a time; once its
+     * share is exhausted it steals chunks from the other workers' shares.
+     * A NULL pool runs fn(ctx, 0, n_items, 0) on the calling thread.
+     * Not reentrant: only one thread may submit work to a pool at a time.
+     */
+    void threadpool_parallel_for(threadpool_t* pool, int n_items, int grain, threadpool_task_fn fn, void* ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TSETLIN_THREADPOOL_H */
@@ -1,9 +1,13 @@
 #include "tsetlin.h"
+#include "bitpack.h"
+#include "bitslice.h"
+#include "mapfile.h"
+#include "stats.h"
+#include "thread.h"
 
 #include <assert.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
 
 /* Helpers */
 static int argmax_int(const int* arr, int len) {
@@ -20,77 +24,153 @@ static int clip_int(int v, int lo, int hi) {
     return v;
 }
 
-/* Create a new tsetlin instance */
-tsetlin_t* tsetlin_new(int N_feature, int N_class, int N_clause, int N_state) {
+#define LOCAL_PACKED_WORDS 64 /* inputs up to 4096 features are packed on the stack */
+
+/* Pack X into local (LOCAL_PACKED_WORDS words) or a heap buffer for wider inputs. */
+static uint64_t* pack_input(const tsetlin_t* ts, const int* X, uint64_t* local) {
+    uint64_t* Xp = local;
+    if (BITPACK_WORDS(ts->n_features) > LOCAL_PACKED_WORDS) {
+        Xp = (uint64_t*)malloc(sizeof(uint64_t) * BITPACK_WORDS(ts->n_features));
+        if (!Xp) return NULL;
+    }
+    bitpack_pack(X, ts->n_features, Xp);
+    return Xp;
+}
+
+#define ARENA_ALIGN 64
+
+static size_t arena_align(size_t n) {
+    return (n + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+/*
+ * Arena layout, every section 64-byte aligned: the tsetlin_t itself, the pos/neg class tables,
+ * the per-class clause pointer arrays, the clause headers, then the clause blocks (see
+ * clause_init), class by class with the positive clauses of a class before its negative ones.
+ */
+size_t tsetlin_arena_size(int N_feature, int N_class, int N_clause) {
+    size_t n_clauses = (size_t)N_class * N_clause;
+    return arena_align(sizeof(tsetlin_t))
+        + arena_align(2 * sizeof(clause_t**) * N_class)
+        + arena_align(sizeof(clause_t*) * n_clauses)
+        + arena_align(sizeof(clause_t) * n_clauses)
+        + clause_footprint(N_feature) * n_clauses;
+}
+
+tsetlin_t* tsetlin_new_in(void* mem, size_t size, int N_feature, int N_class, int N_clause, int N_state) {
     assert((N_state % 2) == 0);
     assert((N_clause % 2) == 0);
 
-    tsetlin_t* ts = (tsetlin_t*)calloc(1, sizeof(tsetlin_t));
-    if (!ts) return NULL;
+    if (!mem || ((uintptr_t)mem % ARENA_ALIGN) != 0) return NULL;
+    if (size < tsetlin_arena_size(N_feature, N_class, N_clause)) return NULL;
+
+    unsigned char* p = (unsigned char*)mem;
+    size_t n_clauses = (size_t)N_class * N_clause;
+    int half = N_clause / 2;
+
+    tsetlin_t* ts = (tsetlin_t*)p;
+    memset(ts, 0, sizeof(tsetlin_t));
+    p += arena_align(sizeof(tsetlin_t));
 
     ts->n_features = N_feature;
     ts->n_classes = N_class;
     ts->n_clauses = N_clause;
     ts->n_states = N_state;
+    ts->mask_precision = RNG_MASK_PRECISION;
+    rng_seed(&ts->rng, TSETLIN_DEFAULT_SEED);
 
-    ts->pos_clauses = (clause_t***)calloc(N_class, sizeof(clause_t**));
-    ts->neg_clauses = (clause_t***)calloc(N_class, sizeof(clause_t**));
-    if (!ts->pos_clauses || !ts->neg_clauses) {
-        tsetlin_free(ts);
-        return NULL;
-    }
+    ts->pos_clauses = (clause_t***)p;
+    ts->neg_clauses = ts->pos_clauses + N_class;
+    p += arena_align(2 * sizeof(clause_t**) * N_class);
 
-    int half = N_clause / 2;
+    clause_t** slots = (clause_t**)p;
+    p += arena_align(sizeof(clause_t*) * n_clauses);
+
+    clause_t* headers = (clause_t*)p;
+    p += arena_align(sizeof(clause_t) * n_clauses);
+
+    size_t footprint = clause_footprint(N_feature);
     for (int c = 0; c < N_class; ++c) {
-        ts->pos_clauses[c] = (clause_t**)calloc(half, sizeof(clause_t*));
-        ts->neg_clauses[c] = (clause_t**)calloc(half, sizeof(clause_t*));
-        if (!ts->pos_clauses[c] || !ts->neg_clauses[c]) {
-            tsetlin_free(ts);
-            return NULL;
-        }
-        for (int j = 0; j < half; ++j) {
-            ts->pos_clauses[c][j] = clause_new(N_feature, N_state);
-            ts->neg_clauses[c][j] = clause_new(N_feature, N_state);
-            if (!ts->pos_clauses[c][j] || !ts->neg_clauses[c][j]) {
-                tsetlin_free(ts);
-                return NULL;
-            }
+        ts->pos_clauses[c] = slots + (size_t)c * N_clause;
+        ts->neg_clauses[c] = ts->pos_clauses[c] + half;
+        for (int j = 0; j < N_clause; ++j) {
+            clause_t* clause = headers + (size_t)c * N_clause + j;
+            clause_init(clause, N_feature, N_state, p, &ts->rng);
+            p += footprint;
+            if (j < half) ts->pos_clauses[c][j] = clause;
+            else ts->neg_clauses[c][j - half] = clause;
         }
     }
 
-    /* Seed RNG once for library usage (caller may override with srand). */
-    srand((unsigned)time(NULL));
+    return ts;
+}
+
+/* Create a new tsetlin instance in one arena allocation */
+tsetlin_t* tsetlin_new(int N_feature, int N_class, int N_clause, int N_state) {
+    size_t size = tsetlin_arena_size(N_feature, N_class, N_clause);
+    void* raw = malloc(size + ARENA_ALIGN - 1);
+    if (!raw) return NULL;
 
+    void* mem = (void*)(((uintptr_t)raw + ARENA_ALIGN - 1) & ~(uintptr_t)(ARENA_ALIGN - 1));
+    tsetlin_t* ts = tsetlin_new_in(mem, size, N_feature, N_class, N_clause, N_state);
+    ts->arena = raw;
     return ts;
 }
 
 void tsetlin_free(tsetlin_t* ts) {
     if (!ts) return;
-    if (ts->pos_clauses) {
-        int half = ts->n_clauses / 2;
-        for (int c = 0; c < ts->n_classes; ++c) {
-            if (ts->pos_clauses[c]) {
-                for (int j = 0; j < half; ++j) {
-                    clause_free(ts->pos_clauses[c][j]);
-                }
-                free(ts->pos_clauses[c]);
-            }
-        }
-        free(ts->pos_clauses);
+    if (ts->mapping) mapfile_close((mapfile_t*)ts->mapping);
+    free(ts->arena); /* the model lives inside it; NULL for caller-provided memory */
+}
+
+void tsetlin_seed(tsetlin_t* ts, uint64_t seed) {
+    assert(ts != NULL);
+    rng_seed(&ts->rng, seed);
+}
+
+void tsetlin_set_sampling(tsetlin_t* ts, clause_sampling_t sampling) {
+    assert(ts != NULL);
+    ts->sampling = sampling;
+}
+
+void tsetlin_set_mask_precision(tsetlin_t* ts, int bits) {
+    assert(ts != NULL);
+    assert(bits >= 1 && bits <= 32);
+    ts->mask_precision = bits;
+}
+
+int tsetlin_set_absorbing(tsetlin_t* ts, int absorbing) {
+    assert(ts != NULL);
+    if (ts->mapping) return -1; /* mapped models are read-only and have no trainable lists */
+
+    ts->absorbing = absorbing ? 1 : 0;
+    for (int c = 0; c < ts->n_classes; ++c) {
+        for (int j = 0; j < ts->n_clauses; ++j) clause_set_absorbing(tsetlin_get_clause(ts, c, j), ts->absorbing);
     }
-    if (ts->neg_clauses) {
-        int half = ts->n_clauses / 2;
-        for (int c = 0; c < ts->n_classes; ++c) {
-            if (ts->neg_clauses[c]) {
-                for (int j = 0; j < half; ++j) {
-                    clause_free(ts->neg_clauses[c][j]);
-                }
-                free(ts->neg_clauses[c]);
-            }
-        }
-        free(ts->neg_clauses);
+    return 0;
+}
+
+double tsetlin_live_fraction(const tsetlin_t* ts) {
+    assert(ts != NULL);
+    int64_t live = 0;
+    for (int c = 0; c < ts->n_classes; ++c) {
+        for (int j = 0; j < ts->n_clauses; ++j) live += clause_live_count(tsetlin_get_clause(ts, c, j));
     }
-    free(ts);
+    double total = (double)ts->n_classes * ts->n_clauses * 2.0 * ts->n_features;
+    return (total > 0.0) ? (double)live / total : 0.0;
+}
+
+clause_t* tsetlin_get_clause(const tsetlin_t* ts, int class_id, int j) {
+    assert(ts != NULL);
+    assert(class_id >= 0 && class_id < ts->n_classes);
+    assert(j >= 0 && j < ts->n_clauses);
+
+    int half = ts->n_clauses / 2;
+    return (j < half) ? ts->pos_clauses[class_id][j] : ts->neg_clauses[class_id][j - half];
+}
+
+int tsetlin_get_automaton(const tsetlin_t* ts, int class_id, int j, int literal) {
+    return clause_get_automaton(tsetlin_get_clause(ts, class_id, j), literal);
 }
 
 /* Predict single sample */
@@ -98,6 +178,21 @@ int tsetlin_predict(const tsetlin_t* ts, const int* X, int* votes_out) {
     assert(ts != NULL);
     assert(X != NULL);
 
+    uint64_t local_words[LOCAL_PACKED_WORDS];
+    uint64_t* Xp = pack_input(ts, X, local_words);
+    if (!Xp) return 0;
+
+    int pred = tsetlin_predict_packed(ts, Xp, votes_out);
+
+    if (Xp != local_words) free(Xp);
+    return pred;
+}
+
+int tsetlin_predict_packed(const tsetlin_t* ts, const uint64_t* X, int* votes_out) {
+    assert(ts != NULL);
+    assert(X != NULL);
+    TSETLIN_STAT_TIMER(start);
+
     int* votes = NULL;
     int local_votes[64]; /* small fast path; if classes > 64 we allocate */
     if (ts->n_classes <= 64) {
@@ -113,8 +208,8 @@ int tsetlin_predict(const tsetlin_t* ts, const int* X, int* votes_out) {
     for (int c = 0; c < ts->n_classes; ++c) {
         int sum = 0;
         for (int j = 0; j < half; ++j) {
-            sum += clause_evaluate(ts->pos_clauses[c][j], X);
-            sum -= clause_evaluate(ts->neg_clauses[c][j], X);
+            sum += clause_evaluate_packed(ts->pos_clauses[c][j], X);
+            sum -= clause_evaluate_packed(ts->neg_clauses[c][j], X);
         }
         votes[c] = sum;
     }
@@ -126,87 +221,383 @@ int tsetlin_predict(const tsetlin_t* ts, const int* X, int* votes_out) {
     }
 
     if (votes != local_votes) free(votes);
+    TSETLIN_STAT_PHASE(TSETLIN_PHASE_PREDICT, start);
     return pred;
 }
 
-/* Single training step following the Python logic (pair-wise learning). */
-tsetlin_feedback_t* tsetlin_step(tsetlin_t* ts, const int* X, int y_target, int T, double s, tsetlin_feedback_t* out_feedback, int threshold) {
+#define PRUNE_BLOCK 4 /* clause pairs a live class evaluates per turn */
+
+int tsetlin_predict_pruned(const tsetlin_t* ts, const uint64_t* X, int* evaluated_out) {
     assert(ts != NULL);
     assert(X != NULL);
-    assert(y_target >= 0 && y_target < ts->n_classes);
-    if (out_feedback) {
-        out_feedback->target_type1 = 0;
-        out_feedback->target_type2 = 0;
-        out_feedback->non_target_type1 = 0;
-        out_feedback->non_target_type2 = 0;
+    TSETLIN_STAT_TIMER(start);
+
+    /* Per class: partial sum and next pair; alive lists the live classes in increasing order. */
+    int n = ts->n_classes;
+    int local[3 * 64]; /* small fast path; if classes > 64 we allocate */
+    int* sums = local;
+    if (n > 64) {
+        sums = (int*)malloc(sizeof(int) * 3 * n);
+        if (!sums) return 0;
+    }
+    int* next = sums + n;
+    int* alive = next + n;
+    for (int c = 0; c < n; ++c) {
+        sums[c] = 0;
+        next[c] = 0;
+        alive[c] = c;
     }
 
     int half = ts->n_clauses / 2;
+    int n_alive = n;
+    int evaluated = 0;
+    while (n_alive > 1) {
+        for (int a = 0; a < n_alive; ++a) {
+            int c = alive[a];
+            int end = (next[c] + PRUNE_BLOCK < half) ? next[c] + PRUNE_BLOCK : half;
+            for (int j = next[c]; j < end; ++j) {
+                sums[c] += clause_evaluate_packed(ts->pos_clauses[c][j], X);
+                sums[c] -= clause_evaluate_packed(ts->neg_clauses[c][j], X);
+            }
+            evaluated += 2 * (end - next[c]);
+            next[c] = end;
+        }
 
-    /* Pair 1: Target class */
-    int class_sum = 0;
-    int* pos_vals = (int*)malloc(sizeof(int) * half);
-    int* neg_vals = (int*)malloc(sizeof(int) * half);
-    if (!pos_vals || !neg_vals) {
-        free(pos_vals); free(neg_vals);
-        return;
+        /* Leader: highest worst case, lowest class on ties. A class stays live while its best
+         * case beats the leader's worst case, or ties it from a lower class. Once every live class
+         * is complete, the leader is the argmax and the others drop. */
+        int leader = alive[0];
+        for (int a = 1; a < n_alive; ++a) {
+            int c = alive[a];
+            if (sums[c] - (half - next[c]) > sums[leader] - (half - next[leader])) leader = c;
+        }
+        int lead_worst = sums[leader] - (half - next[leader]);
+        int kept = 0;
+        for (int a = 0; a < n_alive; ++a) {
+            int c = alive[a];
+            int best = sums[c] + (half - next[c]);
+            if (c == leader || best > lead_worst || (best == lead_worst && c < leader)) alive[kept++] = c;
+        }
+        n_alive = kept;
     }
 
-    for (int i = 0; i < half; ++i) {
-        pos_vals[i] = clause_evaluate(ts->pos_clauses[y_target][i], X);
-        neg_vals[i] = clause_evaluate(ts->neg_clauses[y_target][i], X);
-        class_sum += pos_vals[i];
-        class_sum -= neg_vals[i];
+    int pred = alive[0];
+    if (evaluated_out) *evaluated_out = evaluated;
+    if (sums != local) free(sums);
+    TSETLIN_STAT_PHASE(TSETLIN_PHASE_PREDICT, start);
+    return pred;
+}
+
+int tsetlin_predict_batch_pruned(const tsetlin_t* ts, const uint64_t* X, int n_samples, int* preds_out, double* fraction_out) {
+    assert(ts != NULL);
+    assert(X != NULL);
+    assert(preds_out != NULL);
+
+    int n_words = BITPACK_WORDS(ts->n_features);
+    int64_t evaluated = 0;
+    for (int i = 0; i < n_samples; ++i) {
+        int count = 0;
+        preds_out[i] = tsetlin_predict_pruned(ts, X + (size_t)i * n_words, &count);
+        evaluated += count;
     }
 
-    class_sum = clip_int(class_sum, -T, T);
-    double c1 = (double)(T - class_sum) / (2.0 * (double)T);
+    if (fraction_out) {
+        double total = (double)n_samples * ts->n_classes * ts->n_clauses;
+        *fraction_out = (total > 0.0) ? (double)evaluated / total : 0.0;
+    }
+    return 0;
+}
 
-    for (int i = 0; i < half; ++i) {
-        if (((double)rand() / RAND_MAX) <= c1) {
-            int feedback_count = clause_update(ts->pos_clauses[y_target][i], X, 1, pos_vals[i], s, threshold);
-            if (out_feedback) out_feedback->target_type1 += feedback_count;
+int tsetlin_predict_sparse(const tsetlin_t* ts, const sparse_sample_t* X, int* votes_out) {
+    assert(ts != NULL);
+    assert(X != NULL);
+
+    int* votes = NULL;
+    int local_votes[64]; /* small fast path; if classes > 64 we allocate */
+    if (ts->n_classes <= 64) votes = local_votes;
+    else {
+        votes = (int*)malloc(sizeof(int) * ts->n_classes);
+        if (!votes) return 0;
+    }
+
+    int half = ts->n_clauses / 2;
+    for (int c = 0; c < ts->n_classes; ++c) {
+        int sum = 0;
+        for (int j = 0; j < half; ++j) {
+            sum += clause_evaluate_sparse(ts->pos_clauses[c][j], X);
+            sum -= clause_evaluate_sparse(ts->neg_clauses[c][j], X);
         }
-        if (((double)rand() / RAND_MAX) <= c1) {
-            int feedback_count = clause_update(ts->neg_clauses[y_target][i], X, 0, neg_vals[i], s, threshold);
-            if (out_feedback) out_feedback->target_type2 += feedback_count;
+        votes[c] = sum;
+    }
+
+    int pred = argmax_int(votes, ts->n_classes);
+
+    if (votes_out) {
+        memcpy(votes_out, votes, sizeof(int) * ts->n_classes);
+    }
+
+    if (votes != local_votes) free(votes);
+    return pred;
+}
+
+#define PREDICT_BLOCK 64 /* samples scored per pass over the model */
+
+/* Accumulate votes (count x n_classes, zeroed by caller) for count packed rows.
+ * Clause-major order: each clause's masks are reused across the whole block. */
+static void predict_block(const tsetlin_t* ts, const uint64_t* X, int count, int* votes) {
+    int n_words = BITPACK_WORDS(ts->n_features);
+    int half = ts->n_clauses / 2;
+    for (int c = 0; c < ts->n_classes; ++c) {
+        for (int j = 0; j < half; ++j) {
+            const clause_t* pos = ts->pos_clauses[c][j];
+            const clause_t* neg = ts->neg_clauses[c][j];
+            for (int i = 0; i < count; ++i) {
+                const uint64_t* row = X + (size_t)i * n_words;
+                votes[i * ts->n_classes + c] += clause_evaluate_packed(pos, row) - clause_evaluate_packed(neg, row);
+            }
         }
     }
+}
 
-    /* Pair 2: Non-target class (random) */
-    int other_class = 0;
-    if (ts->n_classes == 1) other_class = 0;
-    else {
-        int r = rand() % (ts->n_classes - 1);
-        /* map r in [0..n_classes-2] to class != y_target */
-        if (r >= y_target) other_class = r + 1;
-        else other_class = r;
+/* Shared state of a batch prediction; scratch buffers are per worker. */
+typedef struct {
+    const tsetlin_t* ts;
+    const int** rows;        /* either int rows ... */
+    const uint64_t* packed;  /* ... or contiguous packed rows */
+    int* preds_out;
+    int* votes_out;
+    uint64_t* scratch_X;     /* PREDICT_BLOCK packed rows per worker (int rows only) */
+    int* scratch_votes;      /* PREDICT_BLOCK * n_classes votes per worker */
+} predict_job_t;
+
+/* Predict samples [begin, end) of a job, one block at a time. */
+static void predict_range(void* ctx, int begin, int end, int worker) {
+    const predict_job_t* job = (const predict_job_t*)ctx;
+    const tsetlin_t* ts = job->ts;
+    int n_words = BITPACK_WORDS(ts->n_features);
+    int* votes = job->scratch_votes + (size_t)worker * PREDICT_BLOCK * ts->n_classes;
+
+    for (int first = begin; first < end; first += PREDICT_BLOCK) {
+        int count = (end - first < PREDICT_BLOCK) ? end - first : PREDICT_BLOCK;
+
+        const uint64_t* X;
+        if (job->packed) {
+            X = job->packed + (size_t)first * n_words;
+        }
+        else {
+            uint64_t* Xp = job->scratch_X + (size_t)worker * PREDICT_BLOCK * n_words;
+            for (int i = 0; i < count; ++i) {
+                bitpack_pack(job->rows[first + i], ts->n_features, Xp + (size_t)i * n_words);
+            }
+            X = Xp;
+        }
+
+        TSETLIN_STAT_TIMER(start);
+        memset(votes, 0, sizeof(int) * ts->n_classes * count);
+        predict_block(ts, X, count, votes);
+        TSETLIN_STAT_PHASE(TSETLIN_PHASE_PREDICT, start);
+
+        for (int i = 0; i < count; ++i) {
+            job->preds_out[first + i] = argmax_int(votes + i * ts->n_classes, ts->n_classes);
+        }
+        if (job->votes_out) {
+            memcpy(job->votes_out + (size_t)first * ts->n_classes, votes, sizeof(int) * count * ts->n_classes);
+        }
+    }
+}
+
+/* Run a batch prediction on pool (NULL runs on the calling thread). */
+static int predict_run(const tsetlin_t* ts, threadpool_t* pool, const int** rows, const uint64_t* packed,
+    int n_samples, int* preds_out, int* votes_out) {
+    assert(ts != NULL);
+    assert(rows != NULL || packed != NULL);
+    assert(preds_out != NULL);
+
+    int n_workers = threadpool_size(pool);
+    predict_job_t job = { ts, rows, packed, preds_out, votes_out, NULL, NULL };
+    job.scratch_votes = (int*)malloc(sizeof(int) * ts->n_classes * PREDICT_BLOCK * n_workers);
+    if (!packed) {
+        job.scratch_X = (uint64_t*)malloc(sizeof(uint64_t) * BITPACK_WORDS(ts->n_features) * PREDICT_BLOCK * n_workers);
     }
+    if (!job.scratch_votes || (!packed && !job.scratch_X)) {
+        free(job.scratch_votes); free(job.scratch_X);
+        return -1;
+    }
+
+    threadpool_parallel_for(pool, n_samples, PREDICT_BLOCK, predict_range, &job);
+
+    free(job.scratch_votes);
+    free(job.scratch_X);
+    return 0;
+}
+
+int tsetlin_predict_batch(const tsetlin_t* ts, const int** X, int n_samples, int* preds_out, int* votes_out) {
+    assert(X != NULL);
+    return predict_run(ts, NULL, X, NULL, n_samples, preds_out, votes_out);
+}
+
+int tsetlin_predict_batch_packed(const tsetlin_t* ts, const uint64_t* X, int n_samples, int* preds_out, int* votes_out) {
+    assert(X != NULL);
+    return predict_run(ts, NULL, NULL, X, n_samples, preds_out, votes_out);
+}
+
+int tsetlin_predict_parallel(const tsetlin_t* ts, threadpool_t* pool, const int** X, int n_samples, int* preds_out, int* votes_out) {
+    assert(X != NULL);
+    return predict_run(ts, pool, X, NULL, n_samples, preds_out, votes_out);
+}
+
+int tsetlin_predict_parallel_packed(const tsetlin_t* ts, threadpool_t* pool, const uint64_t* X, int n_samples, int* preds_out, int* votes_out) {
+    assert(X != NULL);
+    return predict_run(ts, pool, NULL, X, n_samples, preds_out, votes_out);
+}
+
+/* Single training step following the Python logic (pair-wise learning). */
+int tsetlin_step(tsetlin_t* ts, const int* X, int y_target, int T, double s, tsetlin_feedback_t* out_feedback, int threshold) {
+    assert(ts != NULL);
+    assert(X != NULL);
+
+    uint64_t local_words[LOCAL_PACKED_WORDS];
+    uint64_t* Xp = pack_input(ts, X, local_words);
+    if (!Xp) return -1;
+
+    int status = tsetlin_step_packed(ts, Xp, y_target, T, s, out_feedback, threshold);
+
+    if (Xp != local_words) free(Xp);
+    return status;
+}
+
+/* Pick the non-target class of a step uniformly among the classes != y_target. */
+static int pick_other_class(const tsetlin_t* ts, int y_target, rng_t* rng) {
+    if (ts->n_classes == 1) return 0;
+    int r = rng_below(rng, ts->n_classes - 1);
+    /* map r in [0..n_classes-2] to class != y_target */
+    return (r >= y_target) ? r + 1 : r;
+}
+
+/* Update one clause with the model's sampling mode, or its bit-sliced states when slice is non-NULL.
+ * busy (Hogwild only) is the clause's ownership flag: if another worker is updating the clause,
+ * this update is dropped instead of waited for. */
+static int update_clause(const tsetlin_t* ts, clause_t* c, bitslice_t* slice, const uint64_t* X, int match_target,
+    int clause_output, double s, int threshold, rng_t* rng, volatile int* busy) {
+    if (busy && thread_atomic_exchange(busy, 1) != 0) return 0;
+    int feedback_count;
+    if (slice) feedback_count = bitslice_update(slice, X, match_target, clause_output, s, rng);
+    else if (ts->sampling == CLAUSE_SAMPLING_GEOMETRIC) feedback_count = clause_update_geometric(c, X, match_target, clause_output, s, threshold, rng);
+    else feedback_count = clause_update_packed(c, X, match_target, clause_output, s, threshold, rng);
+    if (busy) thread_atomic_exchange(busy, 0);
+    if (match_target) TSETLIN_STAT_ADD(type1_clauses, 1);
+    else TSETLIN_STAT_ADD(type2_clauses, 1);
+    return feedback_count;
+}
+
+/*
+ * Train one class on X (pair-wise learning). The target class gives its positive clauses Type I
+ * and its negative clauses Type II feedback with probability (T - sum) / 2T; a non-target class
+ * swaps the roles and uses (T + sum) / 2T. Draws come from rng. vals is scratch of length n_clauses; busy is NULL or
+ * holds one flag per clause of this class, slices NULL or the bit-sliced states of its clauses (positive
+ * clauses first, as busy). Feedback counts are added to type1_out / type2_out.
+ */
+static void train_class(tsetlin_t* ts, int class_id, const uint64_t* X, bool is_target, int T, double s, int threshold,
+    rng_t* rng, int* vals, volatile int* busy, bitslice_t* slices, int* type1_out, int* type2_out) {
+    int half = ts->n_clauses / 2;
+    clause_t** pos = ts->pos_clauses[class_id];
+    clause_t** neg = ts->neg_clauses[class_id];
+    int* pos_vals = vals;
+    int* neg_vals = vals + half;
+#ifdef TSETLIN_STATS
+    int type1_before = *type1_out, type2_before = *type2_out;
+#endif
 
-    class_sum = 0;
+    TSETLIN_STAT_TIMER(evaluate_start);
+    int class_sum = 0;
     for (int i = 0; i < half; ++i) {
-        pos_vals[i] = clause_evaluate(ts->pos_clauses[other_class][i], X);
-        neg_vals[i] = clause_evaluate(ts->neg_clauses[other_class][i], X);
+        pos_vals[i] = slices ? bitslice_evaluate(&slices[i], X) : clause_evaluate_packed(pos[i], X);
+        neg_vals[i] = slices ? bitslice_evaluate(&slices[half + i], X) : clause_evaluate_packed(neg[i], X);
         class_sum += pos_vals[i];
         class_sum -= neg_vals[i];
     }
+    TSETLIN_STAT_PHASE(TSETLIN_PHASE_EVALUATE, evaluate_start);
 
     class_sum = clip_int(class_sum, -T, T);
-    double c2 = (double)(T + class_sum) / (2.0 * (double)T);
+    /* Feedback probability as an rng_bernoulli threshold, computed exactly in integers. */
+    uint64_t numerator = (uint64_t)(is_target ? T - class_sum : T + class_sum);
+    uint64_t p = (numerator << 32) / (2 * (uint64_t)T);
+    int pos_target = is_target ? 1 : 0;
 
+    TSETLIN_STAT_TIMER(feedback_start);
     for (int i = 0; i < half; ++i) {
-        if (((double)rand() / RAND_MAX) <= c2) {
-            int feedback_count = clause_update(ts->pos_clauses[other_class][i], X, 0, pos_vals[i], s, threshold);
-            if (out_feedback) out_feedback->non_target_type2 += feedback_count;
+        if (rng_bernoulli(rng, p)) {
+            int feedback_count = update_clause(ts, pos[i], slices ? &slices[i] : NULL, X, pos_target, pos_vals[i], s, threshold,
+                rng, busy ? &busy[i] : NULL);
+            *(pos_target ? type1_out : type2_out) += feedback_count;
         }
-        if (((double)rand() / RAND_MAX) <= c2) {
-            int feedback_count = clause_update(ts->neg_clauses[other_class][i], X, 1, neg_vals[i], s, threshold);
-            if (out_feedback) out_feedback->non_target_type1 += feedback_count;
+        if (rng_bernoulli(rng, p)) {
+            int feedback_count = update_clause(ts, neg[i], slices ? &slices[half + i] : NULL, X, 1 - pos_target, neg_vals[i], s,
+                threshold, rng, busy ? &busy[half + i] : NULL);
+            *(pos_target ? type2_out : type1_out) += feedback_count;
         }
     }
+    TSETLIN_STAT_PHASE(TSETLIN_PHASE_FEEDBACK, feedback_start);
+    TSETLIN_STAT_ADD(type1_events, *type1_out - type1_before);
+    TSETLIN_STAT_ADD(type2_events, *type2_out - type2_before);
+    TSETLIN_STAT_CLASS_ADD(class_type1, class_id, *type1_out - type1_before);
+    TSETLIN_STAT_CLASS_ADD(class_type2, class_id, *type2_out - type2_before);
+}
+
+/* tsetlin_step_packed drawing from rng, with optional per-clause busy flags (n_classes * n_clauses, Hogwild only),
+ * bit-sliced states (n_classes * n_clauses, same order) and n_clauses ints of scratch (allocated here if NULL). */
+static int step_packed(tsetlin_t* ts, const uint64_t* X, int y_target, int T, double s,
+    tsetlin_feedback_t* out_feedback, int threshold, rng_t* rng, volatile int* busy, bitslice_t* slices, int* scratch) {
+    assert(ts != NULL);
+    assert(X != NULL);
+    assert(y_target >= 0 && y_target < ts->n_classes);
+    if (ts->mapping) return -1; /* mapped models are read-only */
+
+    int* vals = scratch ? scratch : (int*)malloc(sizeof(int) * ts->n_clauses);
+    if (!vals) return -1;
+
+    tsetlin_feedback_t feedback = { 0, 0, 0, 0 };
+
+    /* Pair 1: Target class */
+    train_class(ts, y_target, X, true, T, s, threshold, rng, vals,
+        busy ? busy + (size_t)y_target * ts->n_clauses : NULL, slices ? slices + (size_t)y_target * ts->n_clauses : NULL,
+        &feedback.target_type1, &feedback.target_type2);
+
+    /* Pair 2: Non-target class (random) */
+    int other_class = pick_other_class(ts, y_target, rng);
+    train_class(ts, other_class, X, false, T, s, threshold, rng, vals,
+        busy ? busy + (size_t)other_class * ts->n_clauses : NULL, slices ? slices + (size_t)other_class * ts->n_clauses : NULL,
+        &feedback.non_target_type1, &feedback.non_target_type2);
+
+    if (vals != scratch) free(vals);
+    if (out_feedback) *out_feedback = feedback;
+    return 0;
+}
+
+int tsetlin_step_packed(tsetlin_t* ts, const uint64_t* X, int y_target, int T, double s, tsetlin_feedback_t* out_feedback, int threshold) {
+    return step_packed(ts, X, y_target, T, s, out_feedback, threshold, &ts->rng, NULL, NULL, NULL);
+}
+
+int tsetlin_step_sparse(tsetlin_t* ts, const sparse_sample_t* X, int y_target, int T, double s, tsetlin_feedback_t* out_feedback, int threshold) {
+    assert(ts != NULL);
+    assert(X != NULL);
+
+    int n_words = BITPACK_WORDS(ts->n_features);
+    uint64_t local_words[LOCAL_PACKED_WORDS];
+    uint64_t* Xp = local_words;
+    if (n_words > LOCAL_PACKED_WORDS) {
+        Xp = (uint64_t*)calloc((size_t)n_words, sizeof(uint64_t));
+        if (!Xp) return -1;
+    }
+    else {
+        memset(Xp, 0, sizeof(uint64_t) * n_words);
+    }
+    sparse_scatter(X, Xp);
 
-    free(pos_vals);
-    free(neg_vals);
+    int status = tsetlin_step_packed(ts, Xp, y_target, T, s, out_feedback, threshold);
+
+    if (Xp != local_words) free(Xp);
+    return status;
 }
 
 /* Fit across dataset. X is array of sample pointers (each sample is int array length n_features). */
@@ -215,9 +606,221 @@ void tsetlin_fit(tsetlin_t* ts, const int** X, const int* y, int n_samples, int
     assert(X != NULL);
     assert(y != NULL);
 
+    /* Pack every sample once; epochs then run on the packed rows. */
+    int n_words = BITPACK_WORDS(ts->n_features);
+    uint64_t* Xp = (uint64_t*)malloc(sizeof(uint64_t) * (size_t)n_words * n_samples);
+    if (!Xp) return;
+    for (int i = 0; i < n_samples; ++i) {
+        bitpack_pack(X[i], ts->n_features, Xp + (size_t)i * n_words);
+    }
+
+    tsetlin_fit_parallel(ts, NULL, Xp, y, n_samples, T, s, epochs, -1, TSETLIN_TRAIN_SERIAL, NULL);
+
+    free(Xp);
+}
+
+#define HOGWILD_GRAIN 16 /* samples claimed at a time by a Hogwild worker */
+
+/* Feedback totals of a step added to sums[4]: target Type I, Type II, non-target Type I, Type II. */
+static void add_feedback(int64_t* sums, const tsetlin_feedback_t* fb) {
+    sums[0] += fb->target_type1;
+    sums[1] += fb->target_type2;
+    sums[2] += fb->non_target_type1;
+    sums[3] += fb->non_target_type2;
+}
+
+/* Shared state of one parallel training epoch. */
+typedef struct {
+    tsetlin_t* ts;
+    const uint64_t* X;
+    const int* y;
+    const int* other;   /* class-parallel: pre-drawn non-target class per sample */
+    rng_t* rngs;        /* class-parallel: one stream per class; Hogwild: one per worker */
+    volatile int* busy; /* Hogwild: per-clause ownership flags */
+    bitslice_t* slices; /* CLAUSE_SAMPLING_BITSLICED: per-clause states, trained in place of the clauses */
+    int64_t* feedback;  /* 4 feedback sums per class (class-parallel) or per worker (Hogwild) */
+    int* vals;          /* n_clauses ints of clause-output scratch per worker */
+    int n_samples;
+    int T;
+    double s;
+    int threshold;
+} train_job_t;
+
+/* Class-parallel: classes [begin, end) replay the whole epoch; every class is owned by one worker. */
+static void train_classes_range(void* ctx, int begin, int end, int worker) {
+    const train_job_t* job = (const train_job_t*)ctx;
+    tsetlin_t* ts = job->ts;
+    int n_words = BITPACK_WORDS(ts->n_features);
+    int* vals = job->vals + (size_t)worker * ts->n_clauses;
+
+    for (int c = begin; c < end; ++c) {
+        bitslice_t* slices = job->slices ? job->slices + (size_t)c * ts->n_clauses : NULL;
+        for (int i = 0; i < job->n_samples; ++i) {
+            const uint64_t* X = job->X + (size_t)i * n_words;
+            tsetlin_feedback_t fb = { 0, 0, 0, 0 };
+            if (job->y[i] == c) {
+                train_class(ts, c, X, true, job->T, job->s, job->threshold, &job->rngs[c], vals, NULL, slices,
+                    &fb.target_type1, &fb.target_type2);
+            }
+            if (job->other[i] == c) {
+                train_class(ts, c, X, false, job->T, job->s, job->threshold, &job->rngs[c], vals, NULL, slices,
+                    &fb.non_target_type1, &fb.non_target_type2);
+            }
+            add_feedback(job->feedback + (size_t)c * 4, &fb);
+            if (worker == 0) tsetlin_stats_poll();
+        }
+    }
+}
+
+/*
+ * Bit-sliced copies of every clause of ts, class by class in tsetlin_get_clause order, in one allocation
+ * with their planes; NULL if out of memory. Training updates the copies, store_slices writes them back.
+ */
+static bitslice_t* load_slices(const tsetlin_t* ts) {
+    size_t n = (size_t)ts->n_classes * ts->n_clauses;
+    size_t footprint = bitslice_footprint(ts->n_features, ts->n_states);
+    size_t header = (sizeof(bitslice_t) * n + 7) & ~(size_t)7;
+    bitslice_t* slices = (bitslice_t*)malloc(header + footprint * n);
+    if (!slices) return NULL;
+
+    uint64_t* planes = (uint64_t*)((char*)slices + header);
+    for (size_t k = 0; k < n; ++k) {
+        bitslice_init(&slices[k], ts->n_features, ts->n_states, planes + k * (footprint / sizeof(uint64_t)));
+        bitslice_load(&slices[k], tsetlin_get_clause(ts, (int)(k / ts->n_clauses), (int)(k % ts->n_clauses)));
+        slices[k].mask_precision = ts->mask_precision;
+    }
+    return slices;
+}
+
+static void store_slices(tsetlin_t* ts, bitslice_t* slices) {
+    size_t n = (size_t)ts->n_classes * ts->n_clauses;
+    for (size_t k = 0; k < n; ++k) {
+        bitslice_store(&slices[k], tsetlin_get_clause(ts, (int)(k / ts->n_clauses), (int)(k % ts->n_clauses)));
+    }
+    free(slices);
+}
+
+/* Hogwild: samples [begin, end) are trained against the shared model without locks. */
+static void train_samples_range(void* ctx, int begin, int end, int worker) {
+    const train_job_t* job = (const train_job_t*)ctx;
+    int n_words = BITPACK_WORDS(job->ts->n_features);
+
+    for (int i = begin; i < end; ++i) {
+        tsetlin_feedback_t fb;
+        if (step_packed(job->ts, job->X + (size_t)i * n_words, job->y[i], job->T, job->s, &fb, job->threshold,
+            &job->rngs[worker], job->busy, job->slices, job->vals + (size_t)worker * job->ts->n_clauses) == 0) {
+            add_feedback(job->feedback + (size_t)worker * 4, &fb);
+        }
+        if (worker == 0) tsetlin_stats_poll();
+    }
+}
+
+int tsetlin_fit_parallel(tsetlin_t* ts, threadpool_t* pool, const uint64_t* X, const int* y, int n_samples,
+    int T, double s, int epochs, int threshold, tsetlin_train_mode_t mode, tsetlin_train_stats_t* stats_out) {
+    assert(ts != NULL);
+    assert(X != NULL);
+    assert(y != NULL);
+
+    if (ts->mapping) return -1; /* mapped models are read-only */
+
+    double start = thread_clock_seconds();
+    int n_words = BITPACK_WORDS(ts->n_features);
+
+    train_job_t job = { ts, X, y, NULL, NULL, NULL, NULL, NULL, NULL, n_samples, T, s, threshold };
+    int n_workers = (mode == TSETLIN_TRAIN_SERIAL) ? 1 : threadpool_size(pool);
+    int n_sums = (mode == TSETLIN_TRAIN_CLASS_PARALLEL) ? ts->n_classes : n_workers;
+    job.feedback = (int64_t*)calloc((size_t)n_sums * 4, sizeof(int64_t));
+    job.vals = (int*)malloc(sizeof(int) * (size_t)n_workers * ts->n_clauses);
+    if (!job.feedback || !job.vals) {
+        free(job.feedback);
+        free(job.vals);
+        return -1;
+    }
+
+    int* other = NULL;
+    if (mode == TSETLIN_TRAIN_CLASS_PARALLEL) {
+        other = (int*)malloc(sizeof(int) * (n_samples > 0 ? n_samples : 1));
+        job.rngs = (rng_t*)malloc(sizeof(rng_t) * ts->n_classes);
+        if (!other || !job.rngs) {
+            free(other);
+            free(job.rngs);
+            free(job.feedback);
+            free(job.vals);
+            return -1;
+        }
+        for (int c = 0; c < ts->n_classes; ++c) rng_split(&ts->rng, &job.rngs[c]);
+        job.other = other;
+    }
+    else if (mode == TSETLIN_TRAIN_HOGWILD) {
+        job.busy = (volatile int*)calloc((size_t)ts->n_classes * ts->n_clauses, sizeof(int));
+        job.rngs = (rng_t*)malloc(sizeof(rng_t) * n_workers);
+        if (!job.busy || !job.rngs) {
+            free((void*)job.busy);
+            free(job.rngs);
+            free(job.feedback);
+            free(job.vals);
+            return -1;
+        }
+        for (int w = 0; w < n_workers; ++w) rng_split(&ts->rng, &job.rngs[w]);
+    }
+
+    /* The bit-sliced update has no trainable lists: with a threshold or absorbing automata, train the
+     * clauses as bernoulli. */
+    if (ts->sampling == CLAUSE_SAMPLING_BITSLICED && threshold < 0 && !ts->absorbing) {
+        job.slices = load_slices(ts);
+        if (!job.slices) {
+            free(other);
+            free(job.rngs);
+            free((void*)job.busy);
+            free(job.feedback);
+            free(job.vals);
+            return -1;
+        }
+    }
+
     for (int epoch = 0; epoch < epochs; ++epoch) {
-        for (int i = 0; i < n_samples; ++i) {
-            tsetlin_step(ts, X[i], y[i], T, s, NULL, -1);
+        switch (mode) {
+        case TSETLIN_TRAIN_CLASS_PARALLEL:
+            /* Draw every step's non-target class up front so all workers agree on it. */
+            for (int i = 0; i < n_samples; ++i) other[i] = pick_other_class(ts, y[i], &ts->rng);
+            threadpool_parallel_for(pool, ts->n_classes, 1, train_classes_range, &job);
+            break;
+        case TSETLIN_TRAIN_HOGWILD:
+            threadpool_parallel_for(pool, n_samples, HOGWILD_GRAIN, train_samples_range, &job);
+            break;
+        default:
+            for (int i = 0; i < n_samples; ++i) {
+                tsetlin_feedback_t fb;
+                if (step_packed(ts, X + (size_t)i * n_words, y[i], T, s, &fb, threshold, &ts->rng, NULL, job.slices, job.vals) == 0) {
+                    add_feedback(job.feedback, &fb);
+                }
+                tsetlin_stats_poll();
+            }
+            break;
         }
     }
+
+    int64_t sums[4] = { 0, 0, 0, 0 };
+    for (int k = 0; k < n_sums; ++k) {
+        for (int j = 0; j < 4; ++j) sums[j] += job.feedback[(size_t)k * 4 + j];
+    }
+
+    if (job.slices) store_slices(ts, job.slices);
+    free(other);
+    free(job.rngs);
+    free((void*)job.busy);
+    free(job.feedback);
+    free(job.vals);
+
+    if (stats_out) {
+        stats_out->target_type1 = sums[0];
+        stats_out->target_type2 = sums[1];
+        stats_out->non_target_type1 = sums[2];
+        stats_out->non_target_type2 = sums[3];
+        stats_out->n_threads = n_workers;
+        stats_out->samples = (long)n_samples * epochs;
+        stats_out->seconds = thread_clock_seconds() - start;
+        stats_out->samples_per_sec = (stats_out->seconds > 0.0) ? (double)stats_out->samples / stats_out->seconds : 0.0;
+    }
+    return 0;
 }
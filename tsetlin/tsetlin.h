@@ -2,8 +2,14 @@
 #define TSETLIN_TSETLIN_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
+#include "bitpack.h"
 #include "clause.h"
+#include "rng.h"
+#include "sparse.h"
+#include "stats.h"
+#include "threadpool.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -16,6 +22,23 @@ extern "C" {
         int non_target_type2;
     } tsetlin_feedback_t;
 
+    /* Training schedules for tsetlin_fit_parallel. */
+    typedef enum {
+        TSETLIN_TRAIN_SERIAL = 0,       /* tsetlin_step over the samples in order */
+        TSETLIN_TRAIN_CLASS_PARALLEL,   /* each worker owns whole classes; same dynamics as serial, no locks */
+        TSETLIN_TRAIN_HOGWILD           /* workers train sample shards against the shared model, lock-free */
+    } tsetlin_train_mode_t;
+
+    typedef struct {
+        int n_threads;
+        long samples;           /* training steps run (epochs * n_samples) */
+        double seconds;
+        double samples_per_sec;
+        /* Automaton feedback events summed over all steps, as tsetlin_feedback_t counts them. */
+        int64_t target_type1, target_type2;
+        int64_t non_target_type1, non_target_type2;
+    } tsetlin_train_stats_t;
+
     typedef struct {
         int n_features;
         int n_classes;
@@ -25,24 +48,165 @@ extern "C" {
         /* Arrays: pos_clauses[c] is clause_t** of length n_clauses/2 */
         clause_t*** pos_clauses;
         clause_t*** neg_clauses;
+
+        /* Model random stream: initial states, serial training and the streams of parallel workers. */
+        rng_t rng;
+
+        /* How clause updates draw their Type I events (CLAUSE_SAMPLING_BERNOULLI by default). */
+        clause_sampling_t sampling;
+
+        /* Bits of the 1/s probability used by the bit-sliced Type I masks (rng_mask precision). */
+        int mask_precision;
+
+        /* Absorbing mode of every clause, see tsetlin_set_absorbing. */
+        int absorbing;
+
+        /* Allocation from tsetlin_new holding the whole model; NULL for tsetlin_new_in. */
+        void* arena;
+
+        /* File mapping the states and masks live in (tsetlin_map); NULL otherwise. */
+        void* mapping;
     } tsetlin_t;
 
-    /* Allocate and initialize a Tsetlin object. Caller must free with tsetlin_free. */
+    /* Seed used by tsetlin_new; runs are reproducible unless the caller reseeds. */
+#define TSETLIN_DEFAULT_SEED 0x5EED5EEDull
+
+    /* Allocate and initialize a Tsetlin object. Caller must free with tsetlin_free.
+     * The whole model (tables, clause headers, states, masks, index lists) is one allocation. */
     tsetlin_t* tsetlin_new(int N_feature, int N_class, int N_clause, int N_state);
 
+    /* Bytes a model needs in one arena (see tsetlin_new_in). */
+    size_t tsetlin_arena_size(int N_feature, int N_class, int N_clause);
+
+    /*
+     * Same as tsetlin_new, with the model placed in caller memory, e.g. huge pages or shared memory.
+     * mem must be 64-byte aligned and hold size >= tsetlin_arena_size(...) bytes; returns NULL
+     * otherwise. The model holds absolute pointers into mem, so other processes must map it at
+     * the same address. mem stays owned by the caller; tsetlin_free on such a model is a no-op.
+     */
+    tsetlin_t* tsetlin_new_in(void* mem, size_t size, int N_feature, int N_class, int N_clause, int N_state);
+
     /* Free a tsetlin instance and all allocated clauses. */
     void tsetlin_free(tsetlin_t* ts);
 
+    /* Version of the binary model format written by tsetlin_save (see tsetlin_io.c). */
+#define TSETLIN_FILE_VERSION 1
+
+    /* Write the model to path in the versioned little-endian format. Returns 0 on success, -1 on failure. */
+    int tsetlin_save(const tsetlin_t* ts, const char* path);
+
+    /* Read a model written by tsetlin_save into a new, trainable model. Returns NULL on failure,
+     * including a file with an automaton state outside [1, n_states]. */
+    tsetlin_t* tsetlin_load(const char* path);
+
+    /*
+     * Map a model written by tsetlin_save without copying: the clause states and include masks are
+     * used in place from the read-only mapped pages, which processes mapping the same file share.
+     * The result is predict-only (tsetlin_predict*, accessors): tsetlin_step* and
+     * tsetlin_fit_parallel return -1 without touching it. The states are range-checked as by
+     * tsetlin_load and the include masks checked against them, which reads the file once. Needs
+     * a little-endian host, returns NULL otherwise or on failure. Release with tsetlin_free.
+     */
+    tsetlin_t* tsetlin_map(const char* path);
+
+    /* Reseed the stream used by subsequent training. The initial clause states are always
+     * drawn from TSETLIN_DEFAULT_SEED, so a given seed reproduces the whole run. */
+    void tsetlin_seed(tsetlin_t* ts, uint64_t seed);
+
+    /* Select how training draws the probability-1/s feedback events, see clause_sampling_t. */
+    void tsetlin_set_sampling(tsetlin_t* ts, clause_sampling_t sampling);
+
+    /* Precision of the CLAUSE_SAMPLING_BITSLICED Type I masks, 1 .. 32 (RNG_MASK_PRECISION by
+     * default): fewer bits cap the random words per mask at the cost of a coarser 1/s. */
+    void tsetlin_set_mask_precision(tsetlin_t* ts, int bits);
+
+    /* Turn absorbing mode on or off for every clause (clause_set_absorbing): automata reaching
+     * state 1 or n_states freeze and drop out of training. Not saved with the model; bit-sliced
+     * sampling falls back to bernoulli while it is on. Returns 0, or -1 (model unchanged) for a
+     * mapped model. */
+    int tsetlin_set_absorbing(tsetlin_t* ts, int absorbing);
+
+    /* Fraction of automata not at state 1 or n_states, i.e. still live in absorbing mode. O(model). */
+    double tsetlin_live_fraction(const tsetlin_t* ts);
+
+    /* Clause j of class class_id: j in [0, n_clauses/2) are positive clauses, [n_clauses/2, n_clauses) negative. */
+    clause_t* tsetlin_get_clause(const tsetlin_t* ts, int class_id, int j);
+
+    /* State of automaton `literal` (clause_get_state layout) of clause j of class class_id. */
+    int tsetlin_get_automaton(const tsetlin_t* ts, int class_id, int j, int literal);
+
     /* Predict class for single sample X (array length n_features).
      * If votes_out is non-NULL it must point to an int array of length n_classes and it will be filled. */
     int tsetlin_predict(const tsetlin_t* ts, const int* X, int* votes_out);
 
-    /* Single training step. If out_feedback is non-NULL it will be filled. threshold <= -1 disables thresholding. */
-    tsetlin_feedback_t* tsetlin_step(tsetlin_t* ts, const int* X, int y_target, int T, double s, tsetlin_feedback_t* out_feedback, int threshold);
+    /* Same as tsetlin_predict, with X bit-packed (BITPACK_WORDS(n_features) words, see bitpack.h). */
+    int tsetlin_predict_packed(const tsetlin_t* ts, const uint64_t* X, int* votes_out);
+
+    /*
+     * Same class as tsetlin_predict_packed (ties to the lowest class), without evaluating every
+     * clause. Classes take turns evaluating a few clause pairs each; every pending pair moves a
+     * sum by at most 1 either way, so a class drops out once its best case falls below the worst
+     * case of the leading class, and prediction stops when one class is left. evaluated_out, if
+     * non-NULL, receives the number of clauses evaluated (of n_classes * n_clauses).
+     */
+    int tsetlin_predict_pruned(const tsetlin_t* ts, const uint64_t* X, int* evaluated_out);
+
+    /* tsetlin_predict_pruned over n_samples contiguous packed rows; fraction_out, if non-NULL,
+     * receives the mean fraction of clauses evaluated per sample. Returns 0. */
+    int tsetlin_predict_batch_pruned(const tsetlin_t* ts, const uint64_t* X, int n_samples, int* preds_out, double* fraction_out);
+
+    /* Same as tsetlin_predict, with X sparse (active features below n_features, see sparse.h).
+     * Each clause costs O(X->n_active) instead of O(n_features). */
+    int tsetlin_predict_sparse(const tsetlin_t* ts, const sparse_sample_t* X, int* votes_out);
+
+    /* Predict n_samples samples at once. X is an array of n_samples pointers to int arrays (length n_features).
+     * preds_out (length n_samples) receives the predicted classes. If votes_out is non-NULL it must hold
+     * n_samples * n_classes ints and receives the votes, one row per sample.
+     * The model is traversed clause-major over blocks of samples so it stays cache-resident.
+     * Returns 0 on success, -1 on allocation failure. */
+    int tsetlin_predict_batch(const tsetlin_t* ts, const int** X, int n_samples, int* preds_out, int* votes_out);
+
+    /* Same as tsetlin_predict_batch, with X holding n_samples contiguous packed rows of BITPACK_WORDS(n_features) words. */
+    int tsetlin_predict_batch_packed(const tsetlin_t* ts, const uint64_t* X, int n_samples, int* preds_out, int* votes_out);
+
+    /* Same as tsetlin_predict_batch / tsetlin_predict_batch_packed, with the samples split across the
+     * workers of pool (NULL runs on the calling thread). Prediction never mutates the model, so any
+     * number of threads may predict concurrently as long as no thread is training it. */
+    int tsetlin_predict_parallel(const tsetlin_t* ts, threadpool_t* pool, const int** X, int n_samples, int* preds_out, int* votes_out);
+    int tsetlin_predict_parallel_packed(const tsetlin_t* ts, threadpool_t* pool, const uint64_t* X, int n_samples, int* preds_out, int* votes_out);
+
+    /* Single training step. If out_feedback is non-NULL it receives the automaton feedback events of
+     * the step. Returns 0, or -1 on allocation failure or for a mapped model (tsetlin_map), in which
+     * case the model is unchanged. threshold <= -1 disables thresholding. */
+    int tsetlin_step(tsetlin_t* ts, const int* X, int y_target, int T, double s, tsetlin_feedback_t* out_feedback, int threshold);
+
+    /* Same as tsetlin_step, with X bit-packed (BITPACK_WORDS(n_features) words). */
+    int tsetlin_step_packed(tsetlin_t* ts, const uint64_t* X, int y_target, int T, double s, tsetlin_feedback_t* out_feedback, int threshold);
+
+    /* Same as tsetlin_step, with X sparse. Training still visits every automaton; X is scattered
+     * into a packed row (n_features / 8 bytes) for the update. */
+    int tsetlin_step_sparse(tsetlin_t* ts, const sparse_sample_t* X, int y_target, int T, double s, tsetlin_feedback_t* out_feedback, int threshold);
 
     /* Fit over dataset X (array of n_samples pointers to int arrays) and labels y (length n_samples). */
     void tsetlin_fit(tsetlin_t* ts, const int** X, const int* y, int n_samples, int T, double s, int epochs);
 
+    /*
+     * Train for epochs over n_samples packed rows X (BITPACK_WORDS(n_features) words each) with labels y.
+     * TSETLIN_TRAIN_CLASS_PARALLEL: non-target classes are drawn up front, then the classes are split
+     *   across the workers; a class only depends on its own clauses, so no state is shared. Scales up
+     *   to n_classes workers.
+     * TSETLIN_TRAIN_HOGWILD: the samples are split across the workers, which step the shared model
+     *   concurrently. Clause reads are racy by design; a clause already being updated by another
+     *   worker skips the update rather than waiting.
+     * Class-parallel gives every class its own random stream, so its result does not depend on the
+     * number of workers; Hogwild gives every worker its own stream.
+     * A NULL pool runs on the calling thread. If stats_out is non-NULL it receives the throughput
+     * and the feedback totals. With TSETLIN_STATS, the periodic dump (stats.h) is polled between samples.
+     * Returns 0 on success, -1 on allocation failure or for a mapped model (tsetlin_map).
+     */
+    int tsetlin_fit_parallel(tsetlin_t* ts, threadpool_t* pool, const uint64_t* X, const int* y, int n_samples,
+        int T, double s, int epochs, int threshold, tsetlin_train_mode_t mode, tsetlin_train_stats_t* stats_out);
+
 #ifdef __cplusplus
 }
 #endif
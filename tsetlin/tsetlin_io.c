@@ -0,0 +1,294 @@
+#include "tsetlin.h"
+#include "byteorder.h"
+#include "mapfile.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Model file format, version 1. All integers are little-endian.
+ *
+ *   0  char magic[8]      "TSETLIN\0"
+ *   8  u32  version       TSETLIN_FILE_VERSION
+ *  12  u32  header_size   64
+ *  16  u32  n_features
+ *  20  u32  n_classes
+ *  24  u32  n_clauses
+ *  28  u32  n_states
+ *  32  u32  state_bytes   2 (u16 automaton states)
+ *  36  u32  reserved      0
+ *  40  u64  states_offset
+ *  48  u64  masks_offset
+ *  56  u64  file_size
+ *
+ * Then one state block per clause in tsetlin_get_clause order (class by class): the 2 * n_features
+ * u16 states in clause_get_state layout, zero-padded to a multiple of 64 bytes. Then one mask block
+ * per clause in the same order: the positive then negated include masks, BITPACK_WORDS(n_features)
+ * u64 words each, zero-padded to a multiple of 64 bytes. Every block starts 64-byte aligned.
+ */
+#define FILE_MAGIC "TSETLIN"
+#define FILE_HEADER_SIZE 64
+#define FILE_ALIGN 64
+
+static size_t file_align(size_t n) {
+    return (n + FILE_ALIGN - 1) & ~(size_t)(FILE_ALIGN - 1);
+}
+
+/* Decoded and validated header. */
+typedef struct {
+    int n_features;
+    int n_classes;
+    int n_clauses;
+    int n_states;
+    size_t state_stride; /* bytes per clause state block */
+    size_t mask_stride;  /* bytes per clause mask block */
+    uint64_t states_offset;
+    uint64_t masks_offset;
+    uint64_t file_size;
+} file_layout_t;
+
+static void layout_strides(file_layout_t* l) {
+    l->state_stride = file_align(sizeof(uint16_t) * (2 * (size_t)l->n_features));
+    l->mask_stride = file_align(sizeof(uint64_t) * 2 * (size_t)BITPACK_WORDS(l->n_features));
+}
+
+/* Parse the header of an in-memory file of size bytes. Returns 0 if it is a consistent version 1 file. */
+static int parse_header(const unsigned char* data, size_t size, file_layout_t* l) {
+    if (size < FILE_HEADER_SIZE || memcmp(data, FILE_MAGIC, 8) != 0) return -1;
+    if (get_u32(data + 8) != TSETLIN_FILE_VERSION || get_u32(data + 12) != FILE_HEADER_SIZE) return -1;
+    if (get_u32(data + 32) != sizeof(uint16_t)) return -1;
+
+    uint32_t n_features = get_u32(data + 16);
+    uint32_t n_classes = get_u32(data + 20);
+    uint32_t n_clauses = get_u32(data + 24);
+    uint32_t n_states = get_u32(data + 28);
+    if (n_features == 0 || n_features > (1u << 30) || n_classes == 0 || n_classes > (1u << 20)) return -1;
+    if (n_clauses == 0 || n_clauses > (1u << 20) || (n_clauses % 2) != 0) return -1;
+    if (n_states == 0 || n_states > AUTOMATON_STATE_MAX || (n_states % 2) != 0) return -1;
+
+    l->n_features = (int)n_features;
+    l->n_classes = (int)n_classes;
+    l->n_clauses = (int)n_clauses;
+    l->n_states = (int)n_states;
+    layout_strides(l);
+    l->states_offset = get_u64(data + 40);
+    l->masks_offset = get_u64(data + 48);
+    l->file_size = get_u64(data + 56);
+
+    /* Bound the block count by the file size first, so the offset products below cannot wrap. */
+    uint64_t n_blocks = (uint64_t)n_classes * n_clauses;
+    if (n_blocks > (size - FILE_HEADER_SIZE) / (l->state_stride + l->mask_stride)) return -1;
+    if (l->states_offset != FILE_HEADER_SIZE) return -1;
+    if (l->masks_offset != l->states_offset + n_blocks * l->state_stride) return -1;
+    if (l->file_size != l->masks_offset + n_blocks * l->mask_stride || l->file_size != (uint64_t)size) return -1;
+    return 0;
+}
+
+int tsetlin_save(const tsetlin_t* ts, const char* path) {
+    assert(ts != NULL);
+    assert(path != NULL);
+
+    file_layout_t l;
+    l.n_features = ts->n_features;
+    layout_strides(&l);
+    uint64_t n_blocks = (uint64_t)ts->n_classes * ts->n_clauses;
+    l.states_offset = FILE_HEADER_SIZE;
+    l.masks_offset = l.states_offset + n_blocks * l.state_stride;
+    l.file_size = l.masks_offset + n_blocks * l.mask_stride;
+
+    unsigned char header[FILE_HEADER_SIZE];
+    memset(header, 0, sizeof(header));
+    memcpy(header, FILE_MAGIC, 8);
+    put_u32(header + 8, TSETLIN_FILE_VERSION);
+    put_u32(header + 12, FILE_HEADER_SIZE);
+    put_u32(header + 16, (uint32_t)ts->n_features);
+    put_u32(header + 20, (uint32_t)ts->n_classes);
+    put_u32(header + 24, (uint32_t)ts->n_clauses);
+    put_u32(header + 28, (uint32_t)ts->n_states);
+    put_u32(header + 32, sizeof(uint16_t));
+    put_u64(header + 40, l.states_offset);
+    put_u64(header + 48, l.masks_offset);
+    put_u64(header + 56, l.file_size);
+
+    size_t buffer_size = (l.state_stride > l.mask_stride) ? l.state_stride : l.mask_stride;
+    unsigned char* buffer = (unsigned char*)malloc(buffer_size);
+    if (!buffer) return -1;
+
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        free(buffer);
+        return -1;
+    }
+
+    int ok = fwrite(header, 1, sizeof(header), f) == sizeof(header);
+
+    /* State blocks, then mask blocks, each encoded little-endian into the padded buffer. */
+    for (int pass = 0; pass < 2 && ok; ++pass) {
+        size_t stride = (pass == 0) ? l.state_stride : l.mask_stride;
+        for (int c = 0; c < ts->n_classes && ok; ++c) {
+            for (int j = 0; j < ts->n_clauses && ok; ++j) {
+                const clause_t* clause = tsetlin_get_clause(ts, c, j);
+                memset(buffer, 0, stride);
+                if (pass == 0) {
+                    for (int k = 0; k < clause->N_literals; ++k) put_u16(buffer + 2 * k, clause->p_automata[k]);
+                }
+                else {
+                    for (int w = 0; w < 2 * clause->N_words; ++w) put_u64(buffer + 8 * w, clause->p_include_mask[w]);
+                }
+                ok = fwrite(buffer, 1, stride, f) == stride;
+            }
+        }
+    }
+
+    free(buffer);
+    if (fclose(f) != 0) ok = 0;
+    return ok ? 0 : -1;
+}
+
+/*
+ * 1 if every automaton state of the file lies in [1, n_states] and, with_masks, every include mask
+ * word holds exactly the actions of its states (bits past n_features clear), so a mapped model
+ * predicts as the loaded one. Block padding is not looked at.
+ */
+static int blocks_valid(const unsigned char* data, const file_layout_t* l, int with_masks) {
+    size_t n_blocks = (size_t)l->n_classes * l->n_clauses;
+    size_t n_features = (size_t)l->n_features;
+    size_t n_words = (size_t)BITPACK_WORDS(l->n_features);
+    int middle = l->n_states / 2;
+
+    for (size_t b = 0; b < n_blocks; ++b) {
+        const unsigned char* states = data + l->states_offset + b * l->state_stride;
+        const unsigned char* masks = data + l->masks_offset + b * l->mask_stride;
+        for (size_t k = 0; k < 2 * n_features; ++k) {
+            uint16_t state = get_u16(states + 2 * k);
+            if (state < 1 || state > l->n_states) return 0;
+        }
+        if (!with_masks) continue;
+
+        /* Positive then negated literals, each n_words words. */
+        for (size_t half = 0; half < 2; ++half) {
+            for (size_t w = 0; w < n_words; ++w) {
+                uint64_t expected = 0;
+                for (size_t bit = 0; bit < 64 && w * 64 + bit < n_features; ++bit) {
+                    size_t k = half * n_features + w * 64 + bit;
+                    if (get_u16(states + 2 * k) > middle) expected |= (uint64_t)1 << bit;
+                }
+                if (get_u64(masks + 8 * (half * n_words + w)) != expected) return 0;
+            }
+        }
+    }
+    return 1;
+}
+
+tsetlin_t* tsetlin_load(const char* path) {
+    assert(path != NULL);
+
+    mapfile_t m;
+    if (mapfile_open(&m, path) != 0) return NULL;
+
+    const unsigned char* data = (const unsigned char*)m.data;
+    file_layout_t l;
+    tsetlin_t* ts = NULL;
+    if (parse_header(data, m.size, &l) == 0 && blocks_valid(data, &l, 0)) {
+        ts = tsetlin_new(l.n_features, l.n_classes, l.n_clauses, l.n_states);
+    }
+
+    if (ts) {
+        const unsigned char* block = data + l.states_offset;
+        for (int c = 0; c < l.n_classes; ++c) {
+            for (int j = 0; j < l.n_clauses; ++j, block += l.state_stride) {
+                clause_t* clause = tsetlin_get_clause(ts, c, j);
+                for (int k = 0; k < clause->N_literals; ++k) clause->p_automata[k] = get_u16(block + 2 * k);
+                clause_compress(clause, -1); /* masks and lists follow from the states */
+            }
+        }
+    }
+
+    mapfile_close(&m);
+    return ts;
+}
+
+tsetlin_t* tsetlin_map(const char* path) {
+    assert(path != NULL);
+
+    /* The blocks are used in place, so they must already be in host byte order. */
+    if (!host_is_little_endian()) return NULL;
+
+    mapfile_t m;
+    if (mapfile_open(&m, path) != 0) return NULL;
+
+    const unsigned char* data = (const unsigned char*)m.data;
+    file_layout_t l;
+    if (parse_header(data, m.size, &l) != 0 || !blocks_valid(data, &l, 1)) {
+        mapfile_close(&m);
+        return NULL;
+    }
+
+    /* Only the model headers are allocated: tsetlin_t, the mapping, class tables and clause headers. */
+    size_t n_clauses = (size_t)l.n_classes * l.n_clauses;
+    size_t size = file_align(sizeof(tsetlin_t)) + file_align(sizeof(mapfile_t))
+        + file_align(2 * sizeof(clause_t**) * l.n_classes)
+        + file_align(sizeof(clause_t*) * n_clauses)
+        + sizeof(clause_t) * n_clauses;
+    unsigned char* p = (unsigned char*)calloc(1, size);
+    if (!p) {
+        mapfile_close(&m);
+        return NULL;
+    }
+
+    tsetlin_t* ts = (tsetlin_t*)p;
+    ts->arena = p;
+    p += file_align(sizeof(tsetlin_t));
+
+    ts->mapping = (mapfile_t*)p;
+    *(mapfile_t*)ts->mapping = m;
+    p += file_align(sizeof(mapfile_t));
+
+    ts->n_features = l.n_features;
+    ts->n_classes = l.n_classes;
+    ts->n_clauses = l.n_clauses;
+    ts->n_states = l.n_states;
+    ts->mask_precision = RNG_MASK_PRECISION;
+    rng_seed(&ts->rng, TSETLIN_DEFAULT_SEED);
+
+    ts->pos_clauses = (clause_t***)p;
+    ts->neg_clauses = ts->pos_clauses + l.n_classes;
+    p += file_align(2 * sizeof(clause_t**) * l.n_classes);
+
+    clause_t** slots = (clause_t**)p;
+    p += file_align(sizeof(clause_t*) * n_clauses);
+    clause_t* headers = (clause_t*)p;
+
+    int half = l.n_clauses / 2;
+    for (int c = 0; c < l.n_classes; ++c) {
+        ts->pos_clauses[c] = slots + (size_t)c * l.n_clauses;
+        ts->neg_clauses[c] = ts->pos_clauses[c] + half;
+        for (int j = 0; j < l.n_clauses; ++j) {
+            size_t index = (size_t)c * l.n_clauses + j;
+            clause_t* clause = headers + index;
+            clause->N_feature = l.n_features;
+            clause->N_states = l.n_states;
+            clause->N_literals = 2 * l.n_features;
+            clause->N_words = BITPACK_WORDS(l.n_features);
+
+            /* Point straight into the mapped pages; they are never written. */
+            clause->p_automata = (automaton_state_t*)(data + l.states_offset + index * l.state_stride);
+            clause->n_automata = clause->p_automata + l.n_features;
+            clause->p_include_mask = (uint64_t*)(data + l.masks_offset + index * l.mask_stride);
+            clause->n_include_mask = clause->p_include_mask + clause->N_words;
+
+            /* No index lists, but sparse evaluation needs the included counts. */
+            for (int w = 0; w < clause->N_words; ++w) {
+                clause->p_included_count += bitpack_popcount(clause->p_include_mask[w]);
+                clause->n_included_count += bitpack_popcount(clause->n_include_mask[w]);
+            }
+
+            if (j < half) ts->pos_clauses[c][j] = clause;
+            else ts->neg_clauses[c][j - half] = clause;
+        }
+    }
+
+    return ts;
+}